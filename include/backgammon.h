@@ -20,14 +20,69 @@
 #define S_END_TURN		3
 #define S_END_ROUND		4
 
-#define DELAYED_FUNC_TIMEOUT		1000
 #define DDICE_SIZE					58
 
+/**
+ * @brief Shortest time between the steps of an AI player (ms), so that
+ * its movements can be followed
+ */
+#define DELAYED_FUNC_TIMEOUT		1000
+
+/**
+ * @brief Default thinking time of an AI player for each decision (seconds)
+ */
+#define IA_THINK_TIME				1.0
+
+/**
+ * @brief Memory of the evaluation cache shared by the AI players
+ */
+#define IA_CACHE_SIZE				(16 * 1024 * 1024)
+
+/**
+ * @brief Memory of the search tree of each MCTS AI player
+ */
+#define IA_MCTS_MEMORY				(128 * 1024 * 1024)
+
+/**
+ * @brief Weights of the network evaluator. Without this file the AI uses
+ * the heuristic evaluator.
+ */
+#define NNET_WEIGHTS_FILE			"data/bgnn.weights"
+
+/**
+ * @brief One-sided and two-sided bearoff databases, built with
+ * bin/bgbearoff. Optional.
+ */
+#define BEAROFF_FILE				"data/bearoff.db"
+#define BEAROFF2_FILE				"data/bearoff2.db"
+
+/**
+ * @brief Match equity table, computed on the first run and kept here.
+ */
+#define MET_FILE					"data/met.bin"
+
+/**
+ * @brief Opening book, built with bin/bgbook. Optional.
+ */
+#define BOOK_FILE					"data/book.db"
+
 #include <gtk/gtk.h>
 #include <board.h>
 #include <player.h>
 #include <undo.h>
 
+#include <core/bearoff.h>
+#include <core/bearoff2.h>
+#include <core/book.h>
+#include <core/cache.h>
+#include <core/cube.h>
+#include <core/mcts.h>
+#include <core/met.h>
+#include <core/movegen.h>
+#include <core/nnet.h>
+#include <core/ponder.h>
+#include <core/rng.h>
+
 /**
  * @brief Main structure of the game
  * 
@@ -45,6 +100,32 @@ typedef struct backgammon_t {
 	Undo undo;
 	gint player_turn, status, max_score;
 	Player player[2];
+
+	// Dice: game number game of the session rolls stream game of seed,
+	// so the seed and the number of a game replay its dice
+	guint64 seed;
+	guint game;
+	Rng dice;
+
+	// AI: evaluator, evaluation cache, the search trees of the MCTS
+	// players, the search running on the worker thread, the cube decision
+	// and play it chose, and the ponder that fills the cache during the
+	// turn of a human opponent
+	NNet *net;
+	Bearoff *bearoff;
+	Bearoff2 *bearoff2;
+	Book *book;
+	Met *met;
+	Evaluator evaluate;
+	Cache *cache;
+	Mcts *mcts[2];
+	IaJob *ia_job;
+	guint ia_timer;
+	gboolean ia_ready;
+	CubeDecision ia_cube;
+	Play ia_play;
+	guint ia_move;
+	Ponder *ponder;
 } Backgammon;
 
 /**
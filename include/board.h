@@ -38,34 +38,36 @@
 #define COLOR_MARK(cr)                      cairo_set_source_rgb(cr, 0.0, 1.0, 0.0)
 
 #include <gtk/gtk.h>
+#include <core/game.h>
+
+typedef struct render_t Render;
 
 /**
- * @brief Represents a place where pieces are stacked. If the value of data is
- * 1, it represents the pieces counterclockwise, and with -1 clockwise. When
- * data is 0, there are no pieces.
+ * @brief Represents the render information of a place where pieces are stacked.
+ * The pieces themselves live in the rules state (Board.game), at the same id.
  * 
  */
 typedef struct place_t {
 	guint id;
 	gdouble x, y;
-	gint data;
 	gboolean mark;
 } Place;
 
 /**
- * @brief Contains information about the board
+ * @brief Contains information about the board: the rules state
+ * and the render and selection state of the GUI.
+ * The board is painted by render on its worker thread.
  * 
  */
 typedef struct board_t {
 	GtkDrawingArea *drawing_area;
+	Render *render;
+	Game game;
 	Place places[24], goal[2];
-	gint prison[2];
 	gint selected, prison_sel;
-	guint dice[2];
-	gboolean consumed_dice[4];
 	gboolean enable_dice, enable_places;
 
-	GList *movements;
+	MoveList movements;
 } Board;
 
 /**
@@ -0,0 +1,146 @@
+/**
+ * @file bearoff.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief One-sided bearoff database: exact rolls-to-finish distributions
+ * of every position with up to 15 pieces in the territory
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_BEAROFF_H
+#define CORE_BEAROFF_H
+
+#include <core/eval.h>
+#include <core/position.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Number of positions: ways to place up to 15 pieces on 6 points,
+ * C(21, 6).
+ */
+#define BEAROFF_POSITIONS		54264
+
+/**
+ * @brief Length of the distributions: rolls to bear off every piece
+ * (never more than 30), and rolls to bear off the first one.
+ */
+#define BEAROFF_ROLLS			32
+#define BEAROFF_GAMMON_ROLLS	8
+
+/**
+ * @brief Probabilities are stored as multiples of 1/BEAROFF_ONE.
+ */
+#define BEAROFF_ONE				65535
+
+#define BEAROFF_MAGIC			"BGBO"
+#define BEAROFF_VERSION			1
+
+/**
+ * @brief Entry of a position: expected rolls to bear off every piece with
+ * the best play, the distribution of those rolls, and the distribution
+ * of the rolls to bear off the first piece (for gammons).
+ *
+ */
+typedef struct bearoff_entry_t {
+	float mean;
+	uint16_t prob[BEAROFF_ROLLS];
+	uint16_t gammon[BEAROFF_GAMMON_ROLLS];
+} BearoffEntry;
+
+/**
+ * @brief An open database. The entries are the mapped file, so opening
+ * costs no parsing and the pages are shared between processes.
+ *
+ */
+typedef struct bearoff_t {
+	void *map;
+	size_t size;
+	const BearoffEntry *entries;
+} Bearoff;
+
+/**
+ * @brief Index of a distribution of pieces in the database.
+ *
+ * @param points pieces on each point, by distance to the goal
+ * (points[0] is 1 step away)
+ * @return unsigned index, below BEAROFF_POSITIONS
+ */
+unsigned bearoff_index(const unsigned points[6]);
+
+/**
+ * @brief Index of the pieces of a player, if they are all in their
+ * territory.
+ *
+ * @param pos the position
+ * @param dir direction of the player
+ * @return int the bearoff_index, -1 if some piece is outside the
+ * territory or in prison
+ */
+int bearoff_side_index(const Position *pos, int dir);
+
+/**
+ * @brief Computes the database and writes it to a file.
+ *
+ * @param path file name
+ * @param threads number of workers (0: one per core)
+ * @return bool false on error
+ */
+bool bearoff_build(const char *path, unsigned threads);
+
+/**
+ * @brief Maps a database file into memory.
+ *
+ * @param path file name
+ * @return Bearoff* the database, NULL if the file is missing or invalid
+ */
+Bearoff *bearoff_open(const char *path);
+
+/**
+ * @brief Unmaps a database.
+ *
+ * @param db the database
+ */
+void bearoff_close(Bearoff *db);
+
+/**
+ * @brief Entry of the pieces of a player, if they are all in their
+ * territory.
+ *
+ * @param db the database
+ * @param pos the position
+ * @param dir direction of the player
+ * @return const BearoffEntry* the entry, NULL if some piece is outside
+ * the territory or in prison
+ */
+const BearoffEntry *bearoff_entry(const Bearoff *db, const Position *pos, int dir);
+
+/**
+ * @brief Exact evaluation of a position where both players are bearing off.
+ *
+ * @param db the database, may be NULL
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ * @return bool false if the position is not in the database
+ */
+bool bearoff_evaluate(const Bearoff *db, const Position *pos, Eval *ev);
+
+/**
+ * @brief Sets the database used by the evaluators. It must not be closed
+ * while searches use it.
+ *
+ * @param db the database, NULL for none
+ */
+void bearoff_set_current(const Bearoff *db);
+
+/**
+ * @brief Database used by the evaluators.
+ *
+ * @return const Bearoff* the database, NULL for none
+ */
+const Bearoff *bearoff_current(void);
+
+#endif
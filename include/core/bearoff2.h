@@ -0,0 +1,128 @@
+/**
+ * @file bearoff2.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Two-sided bearoff database: exact cubeless win chances of every
+ * bearoff with up to BEAROFF2_PIECES pieces on each side, compressed
+ * in blocks
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_BEAROFF2_H
+#define CORE_BEAROFF2_H
+
+#include <core/eval.h>
+#include <core/position.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Most pieces left on the board of each side.
+ */
+#define BEAROFF2_PIECES		6
+
+/**
+ * @brief Positions of one side: up to 6 pieces on 6 points, C(12, 6).
+ * They are the first ones of the bearoff_index order.
+ */
+#define BEAROFF2_SIDE		924
+
+#define BEAROFF2_POSITIONS	(BEAROFF2_SIDE * BEAROFF2_SIDE)
+
+/**
+ * @brief Positions per compressed block. A lookup decodes at most
+ * one block.
+ */
+#define BEAROFF2_BLOCK		64
+
+#define BEAROFF2_BLOCKS		((BEAROFF2_POSITIONS + BEAROFF2_BLOCK - 1) / BEAROFF2_BLOCK)
+
+/**
+ * @brief Win chances are stored as multiples of 1/BEAROFF2_ONE.
+ */
+#define BEAROFF2_ONE		65535
+
+#define BEAROFF2_MAGIC		"BGB2"
+#define BEAROFF2_VERSION	1
+
+/**
+ * @brief An open database: the mapped file, the rank of each side, the
+ * block index (offsets of each block in data, plus the end) and the
+ * compressed data. Position (me, opp) is stored at
+ * rank[me] * BEAROFF2_SIDE + rank[opp]; sides are ranked by their expected
+ * rolls to bear off so that neighbouring values are close. A block holds
+ * its first value, then the differences as Rice codes.
+ *
+ */
+typedef struct bearoff2_t {
+	void *map;
+	size_t size;
+	const uint16_t *rank;
+	const uint32_t *blocks;
+	const uint8_t *data;
+} Bearoff2;
+
+/**
+ * @brief Computes the database by retrograde analysis and writes it
+ * to a file.
+ *
+ * @param path file name
+ * @param threads number of workers (0: one per core)
+ * @return bool false on error
+ */
+bool bearoff2_build(const char *path, unsigned threads);
+
+/**
+ * @brief Maps a database file into memory.
+ *
+ * @param path file name
+ * @return Bearoff2* the database, NULL if the file is missing or invalid
+ */
+Bearoff2 *bearoff2_open(const char *path);
+
+/**
+ * @brief Unmaps a database.
+ *
+ * @param db the database
+ */
+void bearoff2_close(Bearoff2 *db);
+
+/**
+ * @brief Win chance of the player to move.
+ *
+ * @param db the database
+ * @param me bearoff_index of the pieces of the player to move
+ * @param opp bearoff_index of the pieces of the opponent
+ * @return float the win chance
+ */
+float bearoff2_lookup(const Bearoff2 *db, unsigned me, unsigned opp);
+
+/**
+ * @brief Exact evaluation of a bearoff with few pieces on both sides.
+ *
+ * @param db the database, may be NULL
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ * @return bool false if the position is not in the database
+ */
+bool bearoff2_evaluate(const Bearoff2 *db, const Position *pos, Eval *ev);
+
+/**
+ * @brief Sets the database used by the evaluators. It must not be closed
+ * while searches use it.
+ *
+ * @param db the database, NULL for none
+ */
+void bearoff2_set_current(const Bearoff2 *db);
+
+/**
+ * @brief Database used by the evaluators.
+ *
+ * @return const Bearoff2* the database, NULL for none
+ */
+const Bearoff2 *bearoff2_current(void);
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * @file book.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Opening book: rolled out plays of the first two rolls of the
+ * game, and evaluations of the positions before the rolls, for the
+ * cube decisions
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_BOOK_H
+#define CORE_BOOK_H
+
+#include <core/eval.h>
+#include <core/movegen.h>
+#include <core/rollout.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Most plays kept for each roll.
+ */
+#define BOOK_MAX_CANDIDATES	8
+
+/**
+ * @brief Value of BookEntry.count for the evaluation of a position
+ * before the roll.
+ */
+#define BOOK_POSITION		0xFFFF
+
+/**
+ * @brief Outputs are stored as multiples of 1/BOOK_ONE.
+ */
+#define BOOK_ONE			65535
+
+#define BOOK_MAGIC			"BGBK"
+#define BOOK_VERSION		1
+
+/**
+ * @brief An entry of the book. A play of a roll is keyed by the position
+ * and the dice, and holds the rolled out evaluation after it, from the
+ * point of view of the player who made it. A position before the roll
+ * is keyed by its Zobrist key alone, with count BOOK_POSITION, and holds
+ * its rolled out evaluation.
+ *
+ */
+typedef struct book_entry_t {
+	uint64_t key;
+	uint16_t out[EVAL_OUTPUTS];
+	Movement moves[4];
+	uint16_t count;
+} BookEntry;
+
+/**
+ * @brief An open book: its entries sorted by key. The plays of a roll
+ * are consecutive.
+ *
+ */
+typedef struct book_t {
+	BookEntry *entries;
+	unsigned count;
+} Book;
+
+/**
+ * @brief Settings of the builder. The plays of each roll are ranked with
+ * a search of depth plies; the best candidates of them are rolled out
+ * with the rollout settings.
+ *
+ */
+typedef struct book_options_t {
+	RolloutOptions rollout;
+	unsigned candidates;
+	unsigned depth;
+	void (*progress)(unsigned done, unsigned total);
+} BookOptions;
+
+/**
+ * @brief Default settings: the rollout defaults, 4 candidates ranked
+ * with a 2-ply search, no progress report.
+ *
+ * @param opts output settings
+ */
+void book_options_init(BookOptions *opts);
+
+/**
+ * @brief Builds the book and writes it to a file. It holds every roll
+ * of the starting position, with either player to move, and every
+ * roll of the replies to the candidates of the first roll.
+ *
+ * @param path file name
+ * @param opts settings
+ * @return bool false on error
+ */
+bool book_build(const char *path, const BookOptions *opts);
+
+/**
+ * @brief Loads a book file.
+ *
+ * @param path file name
+ * @return Book* the book, NULL if the file is missing or invalid
+ */
+Book *book_open(const char *path);
+
+/**
+ * @brief Frees a book.
+ *
+ * @param book the book, may be NULL
+ */
+void book_close(Book *book);
+
+/**
+ * @brief Plays of a roll found in the book.
+ *
+ * @param book the book, may be NULL
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param plays output plays
+ * @param evals output evaluations after the plays, from the point of
+ * view of the player to move
+ * @param max capacity of plays and evals
+ * @return unsigned number of plays, 0 if the roll is not in the book
+ */
+unsigned book_plays(const Book *book, const Position *pos, unsigned d0, unsigned d1,
+		Play plays[], Eval evals[], unsigned max);
+
+/**
+ * @brief Evaluation of a position before the roll found in the book.
+ *
+ * @param book the book, may be NULL
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ * @return bool false if the position is not in the book
+ */
+bool book_evaluate(const Book *book, const Position *pos, Eval *ev);
+
+/**
+ * @brief Sets the book used by the searches of the AI. It must not be
+ * closed while searches use it.
+ *
+ * @param book the book, NULL for none
+ */
+void book_set_current(const Book *book);
+
+/**
+ * @brief Book used by the searches of the AI.
+ *
+ * @return const Book* the book, NULL for none
+ */
+const Book *book_current(void);
+
+#endif
@@ -0,0 +1,123 @@
+/**
+ * @file cache.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Fixed-size evaluation cache keyed by Zobrist key, shared by threads
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_CACHE_H
+#define CORE_CACHE_H
+
+#include <core/eval.h>
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief One slot of the cache. seq is a sequence lock: odd while a writer
+ * fills the slot, so readers never return a torn entry.
+ *
+ */
+typedef struct cache_entry_t {
+	_Atomic uint32_t seq;
+	_Atomic uint32_t depth;
+	_Atomic uint64_t key;
+	_Atomic uint32_t out[EVAL_OUTPUTS];
+} CacheEntry;
+
+/**
+ * @brief Counters of a cache since it was created or cleared.
+ *
+ */
+typedef struct cache_stats_t {
+	uint64_t lookups;
+	uint64_t hits;
+	uint64_t stores;
+	size_t entries;
+} CacheStats;
+
+/**
+ * @brief Evaluation cache. Lookups and stores are lock-free and can run
+ * from any number of threads at the same time. They do not count
+ * themselves: every thread keeps its own counters and adds them with
+ * cache_add_stats, and the totals sit on a cache line of their own, away
+ * from the line every lookup reads.
+ *
+ */
+typedef struct cache_t {
+	CacheEntry *entries;
+	size_t mask;
+
+	_Alignas(64) _Atomic uint64_t lookups;
+	_Atomic uint64_t hits;
+	_Atomic uint64_t stores;
+} Cache;
+
+/**
+ * @brief Creates a cache that uses at most the given memory.
+ * The number of entries is the largest power of two that fits.
+ *
+ * @param bytes memory budget
+ * @return Cache* the cache, NULL if the budget is too small or out of memory
+ */
+Cache *cache_new(size_t bytes);
+
+/**
+ * @brief Destroys a cache.
+ *
+ * @param cache the cache
+ */
+void cache_free(Cache *cache);
+
+/**
+ * @brief Forgets every entry and resets the counters. Must not run at the
+ * same time as lookups or stores.
+ *
+ * @param cache the cache
+ */
+void cache_clear(Cache *cache);
+
+/**
+ * @brief Searches for an evaluation of a position.
+ *
+ * @param cache the cache
+ * @param key Zobrist key of the position
+ * @param depth minimum search depth of the stored evaluation
+ * @param ev output evaluation, written on hit
+ * @return bool true on hit
+ */
+bool cache_lookup(Cache *cache, uint64_t key, unsigned depth, Eval *ev);
+
+/**
+ * @brief Stores an evaluation of a position. An entry of the same position
+ * searched deeper is kept; any other entry in the slot is replaced.
+ *
+ * @param cache the cache
+ * @param key Zobrist key of the position
+ * @param depth search depth of the evaluation
+ * @param ev the evaluation
+ * @return bool true if it was written
+ */
+bool cache_store(Cache *cache, uint64_t key, unsigned depth, const Eval *ev);
+
+/**
+ * @brief Adds the counters of a thread to those of the cache.
+ *
+ * @param cache the cache
+ * @param counts lookups, hits and stores of the thread (entries is ignored)
+ */
+void cache_add_stats(Cache *cache, const CacheStats *counts);
+
+/**
+ * @brief Reads the counters of the cache.
+ *
+ * @param cache the cache
+ * @param stats output counters
+ */
+void cache_stats(Cache *cache, CacheStats *stats);
+
+#endif
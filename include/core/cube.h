@@ -0,0 +1,127 @@
+/**
+ * @file cube.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Doubling cube decisions from cubeless evaluations (money game)
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_CUBE_H
+#define CORE_CUBE_H
+
+#include <core/eval.h>
+#include <core/met.h>
+#include <core/search.h>
+
+#include <stdbool.h>
+
+/**
+ * @brief Owner of the cube, seen from the player to move.
+ */
+#define CUBE_CENTERED		0
+#define CUBE_MINE			1
+#define CUBE_THEIRS			2
+
+/**
+ * @brief Highest value of the cube.
+ */
+#define CUBE_MAX			64
+
+/**
+ * @brief Cube efficiency of Janowski's model: how much of the value of
+ * a live cube is kept in practice (0: dead cube, 1: fully live).
+ */
+#define CUBE_EFFICIENCY		0.68f
+
+/**
+ * @brief Key mixed into the Zobrist key of a position to cache the
+ * evaluations used for cube decisions apart from the search ones.
+ */
+#define CUBE_KEY			0x63756265636b6579ULL
+
+/**
+ * @brief State of the cube: its value and its owner. In a match, met is
+ * the match equity table and away the points each player needs, the
+ * player to move first; met is NULL for money play.
+ *
+ */
+typedef struct cube_t {
+	unsigned value;
+	int owner;
+	const Met *met;
+	int away[2];
+} Cube;
+
+/**
+ * @brief Cube decision of the player to move, before the roll.
+ * Equities are cubeful and per unit of the current cube value, or match
+ * winning chances in a match: no double, double and take, double and pass.
+ * take_point is the lowest win chance with which the opponent takes.
+ *
+ */
+typedef struct cube_decision_t {
+	Eval eval;
+	float no_double;
+	float double_take;
+	float double_pass;
+	float take_point;
+	bool can_double;
+	bool double_;
+	bool take;
+} CubeDecision;
+
+/**
+ * @brief Cubeful equity of an evaluation with Janowski's model: the
+ * cubeless equity blended with the live cube equity, which is linear
+ * between the take point and the cash point of the players.
+ *
+ * @param ev cubeless evaluation, from the point of view of the player to move
+ * @param owner owner of the cube (CUBE_CENTERED, CUBE_MINE or CUBE_THEIRS)
+ * @return float equity per unit of the cube value
+ */
+float cube_equity(const Eval *ev, int owner);
+
+/**
+ * @brief Cube decision for an evaluation: double when doubling gives more
+ * than not doubling; take when the take is worth more than passing.
+ *
+ * @param ev cubeless evaluation, from the point of view of the player to move
+ * @param cube the cube
+ * @param d output decision
+ */
+void cube_decide(const Eval *ev, const Cube *cube, CubeDecision *d);
+
+/**
+ * @brief Evaluates a position before the roll and makes the cube decision.
+ * The evaluation is cached by the key of the position, so asking again
+ * for the same position costs one cache lookup.
+ *
+ * @param pos the position, with the player to move before the roll
+ * @param cube the cube
+ * @param depth 0 for the static evaluation, or the plies of search_evaluate
+ * @param opts evaluator and cache (may be NULL) of the search
+ * @param d output decision
+ * @return bool false if the search was stopped, leaving d unset
+ */
+bool cube_analyze(const Position *pos, const Cube *cube, unsigned depth,
+		const SearchOptions *opts, CubeDecision *d);
+
+/**
+ * @brief Iterative deepening of cube_analyze: depth 0, 1, ... up to depth
+ * while the time budget lasts. Depth 0 always completes.
+ * Positions found in the current opening book are decided from its
+ * rollout at once, as if searched to depth.
+ *
+ * @param pos the position, with the player to move before the roll
+ * @param cube the cube
+ * @param depth deepest search
+ * @param opts evaluator and cache (may be NULL) of the search
+ * @param budget seconds, 0 for no limit
+ * @param d output decision of the deepest search that completed
+ * @return unsigned depth of the decision
+ */
+unsigned cube_iterate(const Position *pos, const Cube *cube, unsigned depth,
+		const SearchOptions *opts, double budget, CubeDecision *d);
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file eval.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Outputs of position evaluators
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_EVAL_H
+#define CORE_EVAL_H
+
+#include <core/position.h>
+
+/**
+ * @brief Indexes of the evaluator outputs. Probabilities are cumulative:
+ * a backgammon is also a gammon, and a gammon is also a win.
+ */
+#define EVAL_WIN				0
+#define EVAL_WIN_GAMMON			1
+#define EVAL_WIN_BACKGAMMON		2
+#define EVAL_LOSE_GAMMON		3
+#define EVAL_LOSE_BACKGAMMON	4
+#define EVAL_OUTPUTS			5
+
+/**
+ * @brief Evaluation of a position from the point of view of one player.
+ *
+ */
+typedef struct eval_t {
+	float out[EVAL_OUTPUTS];
+} Eval;
+
+/**
+ * @brief Position evaluator: fills the outputs from the point of view of
+ * the player to move.
+ */
+typedef void (*Evaluator)(const Position *pos, Eval *ev);
+
+/**
+ * @brief Cubeless money equity of an evaluation, in points per game.
+ *
+ * @param ev the evaluation
+ * @return float equity between -3 and 3
+ */
+float eval_equity(const Eval *ev);
+
+/**
+ * @brief Changes the point of view of an evaluation to the opponent.
+ *
+ * @param ev the evaluation
+ */
+void eval_invert(Eval *ev);
+
+/**
+ * @brief Exact evaluation of a finished game, from the point of view of the
+ * player to move.
+ *
+ * @param pos a position with a winner
+ * @param ev output evaluation
+ */
+void eval_terminal(const Position *pos, Eval *ev);
+
+/**
+ * @brief Exact evaluation from the current bearoff databases, when both
+ * players are bearing off: the two-sided one first, then the one-sided one.
+ *
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ * @return bool false if no database covers the position
+ */
+bool eval_exact(const Position *pos, Eval *ev);
+
+/**
+ * @brief Hand-made evaluator: race balance, blots in reach of the opponent,
+ * points made in the home board and prisoners. Meant as a baseline and as a
+ * fallback when no trained evaluator is available. Positions where both
+ * players are bearing off are read from the current bearoff databases.
+ *
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ */
+void eval_heuristic(const Position *pos, Eval *ev);
+
+/**
+ * @brief Evaluates positions in one call. The positions and the outputs
+ * are contiguous arrays; evaluators that share work between positions
+ * (eval_nnet) do so, the others evaluate them one by one.
+ *
+ * @param evaluate the evaluator
+ * @param positions the positions
+ * @param count number of positions
+ * @param evals output evaluations, from the point of view of the player
+ * to move of each position
+ */
+void eval_batch(Evaluator evaluate, const Position positions[], unsigned count, Eval evals[]);
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * @file filemap.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Read-only mapping of whole files into memory, on POSIX and Windows
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_FILEMAP_H
+#define CORE_FILEMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Maps a whole file into memory, read-only. The pages are shared
+ * with other processes mapping the same file.
+ *
+ * @param path file name
+ * @param size output size of the file in bytes
+ * @return void* the memory, NULL if the file is missing, empty or cannot
+ * be mapped
+ */
+void *filemap_open(const char *path, size_t *size);
+
+/**
+ * @brief Unmaps a file mapped by filemap_open.
+ *
+ * @param map the memory
+ * @param size size of the file in bytes
+ */
+void filemap_close(void *map, size_t size);
+
+/**
+ * @brief Reads a little-endian 64-bit value from memory of any alignment.
+ *
+ * @param p the bytes
+ * @return uint64_t the value
+ */
+static inline uint64_t filemap_le64(const uint8_t *p) {
+	return (uint64_t) p[0] | (uint64_t) p[1] << 8 | (uint64_t) p[2] << 16
+		| (uint64_t) p[3] << 24 | (uint64_t) p[4] << 32 | (uint64_t) p[5] << 40
+		| (uint64_t) p[6] << 48 | (uint64_t) p[7] << 56;
+}
+
+#endif
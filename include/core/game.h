@@ -0,0 +1,208 @@
+/**
+ * @file game.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Headless rules core: board state, move scanning and piece movement.
+ * This module has no GTK, GLib or cairo dependency and is built as libbgcore.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_GAME_H
+#define CORE_GAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of single-die movements that game_scan_movements can
+ * produce: 15 pieces, 4 dice and a board or goal destination for each.
+ */
+#define GAME_MAX_MOVEMENTS		128
+
+/**
+ * @brief Index of the prison and the goal used by a direction.
+ * Direction -1 is captured into prison[1] and bears off into goal[0].
+ */
+#define PRISON_OF(dir)			((dir) == -1 ? 1 : 0)
+#define GOAL_OF(dir)			((dir) == -1 ? 0 : 1)
+
+/**
+ * @brief Index of the counters of a direction in Game.steps and Game.outside.
+ */
+#define SIDE_OF(dir)			((dir) == -1 ? 0 : 1)
+
+/**
+ * @brief Steps a piece of a direction needs to win from a place, and
+ * whether the place is outside the territory of the direction (1 or 0).
+ */
+#define PLACE_STEPS(dir, place)		((dir) == -1 ? (place) + 1 : 24 - (place))
+#define PLACE_OUTSIDE(dir, place)	((dir) == -1 ? (place) > 5 : (place) < 18)
+
+/**
+ * @brief Number of dice available in a roll: 4 for doubles, 2 otherwise.
+ */
+#define GAME_DICE_COUNT(game)	((game)->dice[0] == (game)->dice[1] ? 4 : 2)
+
+/**
+ * @brief Represents a possible move, packed in 16 bits:
+ * bits 0-4 source + 1 (0: prison), bits 5-9 destination + 1 (0: goal)
+ * and bits 10-12 the value of the die.
+ *
+ */
+typedef uint16_t Movement;
+
+#define MOVEMENT(src, dest, dice)	((Movement) (((src) + 1) | (((dest) + 1) << 5) | ((dice) << 10)))
+#define MOVEMENT_SRC(m)				((int) ((m) & 0x1F) - 1)
+#define MOVEMENT_DEST(m)			((int) (((m) >> 5) & 0x1F) - 1)
+#define MOVEMENT_DICE(m)			((unsigned) ((m) >> 10) & 0x7)
+#define MOVEMENT_PRISON_SRC(m)		(((m) & 0x1F) == 0)
+#define MOVEMENT_GOAL_DEST(m)		((((m) >> 5) & 0x1F) == 0)
+
+/**
+ * @brief Fixed-capacity list of movements, meant to live on the stack or
+ * inside another structure, so scanning never allocates.
+ *
+ */
+typedef struct move_list_t {
+	Movement moves[GAME_MAX_MOVEMENTS];
+	unsigned count;
+} MoveList;
+
+/**
+ * @brief Rules state of a game. If the value of a place is positive, it
+ * holds counterclockwise pieces (direction 1), and with a negative value
+ * clockwise pieces (direction -1). The absolute value is the piece count.
+ * The steps and outside counters (indexed with SIDE_OF) and the Zobrist key
+ * of the pieces are kept up to date by game_move_piece, so the queries on
+ * them are O(1).
+ *
+ */
+typedef struct game_t {
+	int places[24];
+	int prison[2];
+	int goal[2];
+	unsigned dice[2];
+	bool consumed_dice[4];
+	int direction;
+
+	int steps[2];
+	int outside[2];
+	uint64_t hash;
+} Game;
+
+/**
+ * @brief Clears the board: no pieces, dice set to 1-1.
+ *
+ * @param game Game instance
+ */
+void game_reset(Game *game);
+
+/**
+ * @brief Arranges the pieces according to the rules and restores the dice.
+ *
+ * @param game Game instance
+ */
+void game_init(Game *game);
+
+/**
+ * @brief Recounts the steps and outside counters and the key from the pieces.
+ * Needed only after writing places, prisons or goals directly.
+ *
+ * @param game Game instance
+ */
+void game_update_counters(Game *game);
+
+/**
+ * @brief Sets the dice values and clears the consumption flags.
+ *
+ * @param game Game instance
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ */
+void game_set_dice(Game *game, unsigned d0, unsigned d1);
+
+/**
+ * @brief Checks if all the pieces of the player to move are in their territory.
+ *
+ * @param game Game instance
+ * @return bool true if all the pieces are in the territory.
+ */
+bool game_all_pieces_in_territory(const Game *game);
+
+/**
+ * @brief Searches for possible single-die movements for the player to move.
+ *
+ * @param game Game instance
+ * @param list output list, overwritten
+ * @return unsigned number of movements found
+ */
+unsigned game_scan_movements(const Game *game, MoveList *list);
+
+/**
+ * @brief Moves a piece of the player to move and consumes the die.
+ * If the destination has an opponent's piece, it is sent to prison.
+ *
+ * @param game Game instance
+ * @param m the registered movement
+ */
+void game_move_piece(Game *game, Movement m);
+
+/**
+ * @brief Returns the number of steps a player needs to win
+ *
+ * @param game Game instance
+ * @param direction direction of the target player
+ * @return unsigned number of remaining steps
+ */
+unsigned game_count_steps(const Game *game, int direction);
+
+/**
+ * @brief Returns the number of pieces of a player outside their territory,
+ * prisoners included.
+ *
+ * @param game Game instance
+ * @param direction direction of the target player
+ * @return unsigned number of pieces outside the territory
+ */
+unsigned game_pieces_outside(const Game *game, int direction);
+
+/**
+ * @brief Returns the number of pieces of a player in prison.
+ *
+ * @param game Game instance
+ * @param direction direction of the target player
+ * @return unsigned number of prisoners
+ */
+unsigned game_prisoners(const Game *game, int direction);
+
+/**
+ * @brief Zobrist key of the game: the pieces and the player to move.
+ * Equal to the key of the Position built from the game.
+ *
+ * @param game Game instance
+ * @return uint64_t key of the game
+ */
+uint64_t game_hash(const Game *game);
+
+/**
+ * @brief Returns the direction of the player who removed all 15 pieces.
+ *
+ * @param game Game instance
+ * @return int direction of the winner, 0 while the game is in progress
+ */
+int game_winner(const Game *game);
+
+/**
+ * @brief Determines the points earned by the winner.
+ * 1: When the opponent has removed some pieces from the board.
+ * 2: (Gammon) When the opponent has not removed any pieces.
+ * 3: (Backgammon) When the opponent still has pieces in the winner's territory or in the winner's prison.
+ *
+ * @param game Game instance
+ * @param win_dir Direction of the winner
+ * @return unsigned The points earned by the winner
+ */
+unsigned game_winner_points(const Game *game, int win_dir);
+
+#endif
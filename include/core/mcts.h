@@ -0,0 +1,129 @@
+/**
+ * @file mcts.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Monte Carlo tree search over full plays, with the dice rolls as
+ * chance nodes, on all the cores over one shared tree
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_MCTS_H
+#define CORE_MCTS_H
+
+#include <core/eval.h>
+#include <core/met.h>
+#include <core/movegen.h>
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Most threads of one search.
+ */
+#define MCTS_MAX_THREADS		64
+
+/**
+ * @brief Plays kept for the nodes below the root: the best ones by the
+ * static evaluation. The root keeps all of them.
+ */
+#define MCTS_MAX_EDGES			24
+
+/**
+ * @brief Default memory of a tree, both pools.
+ */
+#define MCTS_DEFAULT_MEMORY		(64 * 1024 * 1024)
+
+/**
+ * @brief Settings of a search. Simulations go on until stop becomes true,
+ * the time budget (seconds) or the number of simulations is over (0 for
+ * no limit of either), or the pool of the tree is full.
+ * Plays are compared by cubeless equity, or by match winning chance when
+ * match is set. threads share the tree, 0 for one per core. exploration
+ * weighs the visits of a play against its value.
+ *
+ */
+typedef struct mcts_options_t {
+	Evaluator evaluate;
+	const Match *match;
+	unsigned threads;
+	double budget;
+	uint64_t simulations;
+	float exploration;
+	uint64_t seed;
+	atomic_bool *stop;
+} MctsOptions;
+
+/**
+ * @brief Outcome of a search: the most visited play, its mean value and
+ * visits, the simulations run and the time they took, the nodes reused
+ * from the previous search and the memory of the tree.
+ *
+ */
+typedef struct mcts_result_t {
+	Play play;
+	float equity;
+	uint64_t visits;
+	unsigned plays;
+	uint64_t simulations;
+	double seconds;
+	uint64_t reused;
+	size_t memory;
+	bool full;
+} MctsResult;
+
+/**
+ * @brief A search tree, kept between searches.
+ */
+typedef struct mcts_t Mcts;
+
+/**
+ * @brief Default settings: heuristic evaluator, money play, one thread
+ * per core, 1 second, exploration 1, seed 1.
+ *
+ * @param opts output settings
+ */
+void mcts_options_init(MctsOptions *opts);
+
+/**
+ * @brief Creates an empty tree. Its memory is split in two pools: the
+ * nodes grow in one, and the subtree kept for the next search is copied
+ * to the other.
+ *
+ * @param memory bytes of both pools
+ * @return Mcts* the tree, NULL on error
+ */
+Mcts *mcts_new(size_t memory);
+
+/**
+ * @brief Frees a tree.
+ *
+ * @param mcts the tree, may be NULL
+ */
+void mcts_free(Mcts *mcts);
+
+/**
+ * @brief Forgets the tree.
+ *
+ * @param mcts the tree
+ */
+void mcts_clear(Mcts *mcts);
+
+/**
+ * @brief Searches the play of a roll. If the tree of the previous search
+ * reached the position (the same one, or one after a play and a reply),
+ * its subtree is kept and the search goes on from it.
+ *
+ * @param mcts the tree
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param opts settings
+ * @param res output result
+ */
+void mcts_search(Mcts *mcts, const Position *pos, unsigned d0, unsigned d1,
+		const MctsOptions *opts, MctsResult *res);
+
+#endif
@@ -0,0 +1,141 @@
+/**
+ * @file met.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Match equity table: match winning chances at every score, and
+ * conversion of evaluations into match winning chances
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_MET_H
+#define CORE_MET_H
+
+#include <core/eval.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Longest match of the table, in points.
+ */
+#define MET_MAX_SCORE		250
+
+/**
+ * @brief Cube values of the table: 1, 2, 4, ..., 64.
+ */
+#define MET_CUBE_LEVELS		7
+
+/**
+ * @brief Gammon rate assumed by the table: share of the games that end
+ * with a gammon.
+ */
+#define MET_GAMMON_RATE		0.2f
+
+#define MET_MAGIC			"BGME"
+#define MET_VERSION			1
+
+/**
+ * @brief The table, indexed by the points each player needs to win the
+ * match ("away"). mwc[a][b] is the match winning chance of a player who
+ * needs a points at the start of a game against one who needs b.
+ * cash[l][a][b] is the win chance of the game at which the owner of a cube
+ * of value 2^l doubles: the opponent's take point.
+ *
+ */
+typedef struct met_t {
+	float mwc[MET_MAX_SCORE + 1][MET_MAX_SCORE + 1];
+	float cash[MET_CUBE_LEVELS][MET_MAX_SCORE + 1][MET_MAX_SCORE + 1];
+} Met;
+
+/**
+ * @brief Score of a match, for the search. away is indexed with SIDE_OF
+ * the direction of each player; cube is the value of the cube.
+ *
+ */
+typedef struct match_t {
+	const Met *met;
+	unsigned away[2];
+	unsigned cube;
+} Match;
+
+/**
+ * @brief Computes the table. The cube is fully live: players double at
+ * the opponent's take point, which in turn depends on the scores after
+ * the double.
+ *
+ * @return Met* the table, NULL if out of memory
+ */
+Met *met_new(void);
+
+/**
+ * @brief Loads the table from a file. When the file is missing or
+ * invalid the table is computed and saved to it.
+ *
+ * @param path file name, NULL to compute the table without saving it
+ * @return Met* the table, NULL if out of memory
+ */
+Met *met_open(const char *path);
+
+/**
+ * @brief Writes the table to a file.
+ *
+ * @param met the table
+ * @param path file name
+ * @return bool false on error
+ */
+bool met_save(const Met *met, const char *path);
+
+/**
+ * @brief Frees the table.
+ *
+ * @param met the table
+ */
+void met_free(Met *met);
+
+/**
+ * @brief Match winning chance at the start of a game.
+ *
+ * @param met the table
+ * @param away points the player needs (0 or less: match won)
+ * @param opp_away points the opponent needs (0 or less: match lost)
+ * @return float the match winning chance
+ */
+float met_mwc(const Met *met, int away, int opp_away);
+
+/**
+ * @brief Win chance of the game at which the owner of the cube doubles
+ * the opponent out.
+ *
+ * @param met the table
+ * @param away points the owner needs
+ * @param opp_away points the opponent needs
+ * @param cube value of the cube
+ * @return float the cash point, 1 if doubling is never needed
+ */
+float met_cash_point(const Met *met, int away, int opp_away, unsigned cube);
+
+/**
+ * @brief Match winning chance of an evaluation with a dead cube: each
+ * result of the game moves the score by its points times the cube.
+ *
+ * @param met the table
+ * @param ev evaluation, from the point of view of the player to move
+ * @param away points the player to move needs
+ * @param opp_away points the opponent needs
+ * @param cube value of the cube
+ * @return float the match winning chance
+ */
+float met_equity(const Met *met, const Eval *ev, int away, int opp_away, unsigned cube);
+
+/**
+ * @brief Key of a score, mixed into the Zobrist keys of the positions
+ * cached by a search: the best plays, and so the evaluations, depend on
+ * the score.
+ *
+ * @param match the score, may be NULL
+ * @return uint64_t the key, 0 for money play
+ */
+uint64_t met_match_key(const Match *match);
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file movegen.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Full-turn legal move generator of the rules core
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_MOVEGEN_H
+#define CORE_MOVEGEN_H
+
+#include <core/game.h>
+#include <core/position.h>
+
+/**
+ * @brief Upper bound of distinct full plays for a roll (15 checkers moving
+ * four steps of a double: C(18, 4) = 3060).
+ */
+#define MOVEGEN_MAX_PLAYS		3072
+
+/**
+ * @brief A complete play of the turn: the sequence of single-die movements.
+ *
+ */
+typedef struct play_t {
+	Movement moves[4];
+	unsigned count;
+} Play;
+
+/**
+ * @brief Enumerates every legal full play for the dice of the game.
+ * A play uses as many dice as possible; when only one die of a non-double
+ * can be used, the larger one is required if it can be played.
+ * Plays reaching the same final position are reported once.
+ *
+ * @param game Game instance with the dice to play
+ * @param plays output buffer of at least MOVEGEN_MAX_PLAYS entries
+ * @return unsigned number of plays. A single empty play when no die can be used.
+ */
+unsigned movegen_generate(const Game *game, Play plays[]);
+
+/**
+ * @brief Enumerates every legal full play of a roll for the player to move
+ * of a position. Same rules as movegen_generate.
+ *
+ * @param pos the position
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param plays output buffer of at least MOVEGEN_MAX_PLAYS entries
+ * @return unsigned number of plays. A single empty play when no die can be used.
+ */
+unsigned movegen_plays(const Position *pos, unsigned d0, unsigned d1, Play plays[]);
+
+/**
+ * @brief Applies every movement of a play to the game.
+ *
+ * @param game Game instance
+ * @param play the play
+ */
+void movegen_apply(Game *game, const Play *play);
+
+/**
+ * @brief Applies every movement of a play to a position. The turn is not
+ * switched.
+ *
+ * @param pos the position
+ * @param play the play
+ */
+void movegen_apply_position(Position *pos, const Play *play);
+
+/**
+ * @brief Positions after each play of a roll, with the turn passed to the
+ * opponent: the children of a position in a search.
+ *
+ * @param pos the position, with the player to move on roll
+ * @param plays the plays
+ * @param count number of plays
+ * @param next output positions, one per play
+ */
+void movegen_children(const Position *pos, const Play plays[], unsigned count,
+		Position next[]);
+
+/**
+ * @brief Filters the single-die movements of the game to those that begin a
+ * legal full play, so a die-by-die player obeys the same rules.
+ *
+ * @param game Game instance with the dice to play
+ * @param list output list, overwritten
+ * @return unsigned number of legal movements
+ */
+unsigned movegen_legal_movements(const Game *game, MoveList *list);
+
+#endif
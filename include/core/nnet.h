@@ -0,0 +1,192 @@
+/**
+ * @file nnet.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Feed-forward neural network evaluator (TD-Gammon style)
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_NNET_H
+#define CORE_NNET_H
+
+#include <core/eval.h>
+#include <core/position.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Inputs, seen from the player to move: 4 units per place for each
+ * player (1, 2, 3 pieces and the excess / 2), prisoners / 2 and pieces
+ * borne off / 15 for each player.
+ */
+#define NNET_INPUTS			196
+
+/**
+ * @brief The hidden layer is a multiple of NNET_ALIGN floats, so the SIMD
+ * kernels never need a scalar tail.
+ */
+#define NNET_ALIGN			8
+#define NNET_MAX_HIDDEN		1024
+
+/**
+ * @brief Weight file format: "BGNN", then version, inputs, hidden and
+ * outputs as uint32, then w1, b1, w2 and b2 as float. Little endian.
+ */
+#define NNET_MAGIC			"BGNN"
+#define NNET_VERSION		1
+
+/**
+ * @brief Non-zero inputs of a position. Most of the inputs of a position
+ * are 0, so the first layer only adds the rows of the active ones.
+ *
+ */
+typedef struct nnet_input_t {
+	uint16_t index[NNET_INPUTS];
+	float value[NNET_INPUTS];
+	unsigned count;
+} NNetInput;
+
+/**
+ * @brief Network with one hidden layer. w1 is stored input-major
+ * ([inputs][hidden]) and w2 output-major ([outputs][hidden]), so every
+ * kernel runs over contiguous, aligned floats.
+ *
+ */
+typedef struct nnet_t {
+	unsigned hidden;
+	float *w1, *b1;
+	float *w2, *b2;
+} NNet;
+
+/**
+ * @brief Creates a network with small random weights.
+ *
+ * @param hidden size of the hidden layer, rounded up to NNET_ALIGN
+ * @param seed random seed
+ * @return NNet* the network, NULL if out of memory
+ */
+NNet *nnet_new(unsigned hidden, uint64_t seed);
+
+/**
+ * @brief Destroys a network.
+ *
+ * @param net the network
+ */
+void nnet_free(NNet *net);
+
+/**
+ * @brief Loads a network from a weight file.
+ *
+ * @param path file name
+ * @return NNet* the network, NULL if the file is missing or invalid
+ */
+NNet *nnet_load(const char *path);
+
+/**
+ * @brief Saves a network to a weight file.
+ *
+ * @param net the network
+ * @param path file name
+ * @return bool false on error
+ */
+bool nnet_save(const NNet *net, const char *path);
+
+/**
+ * @brief Computes the non-zero inputs of a position.
+ *
+ * @param pos the position
+ * @param in output inputs
+ */
+void nnet_encode(const Position *pos, NNetInput *in);
+
+/**
+ * @brief Forward pass. Outputs are the raw sigmoids, not made consistent.
+ *
+ * @param net the network
+ * @param in inputs of the position
+ * @param hidden output activations of the hidden layer (net->hidden floats,
+ * aligned to 32 bytes)
+ * @param out output values (EVAL_OUTPUTS floats)
+ */
+void nnet_forward(const NNet *net, const NNetInput *in, float hidden[], float out[]);
+
+/**
+ * @brief Derivative of the hidden activation, from its output value.
+ *
+ * @param h output of the activation
+ * @return float derivative
+ */
+float nnet_activation_derivative(float h);
+
+/**
+ * @brief One gradient step of the squared error towards a target, for a
+ * single position. Several threads may train the same network at once
+ * (Hogwild): the updates are not synchronized and some may be lost.
+ *
+ * @param net the network
+ * @param in inputs of the position
+ * @param target target outputs (EVAL_OUTPUTS floats)
+ * @param rate learning rate
+ * @return float squared error of the outputs before the step
+ */
+float nnet_train(NNet *net, const NNetInput *in, const float target[], float rate);
+
+/**
+ * @brief Evaluates a position with a network.
+ * The outputs are made consistent: gammons never exceed wins.
+ *
+ * @param net the network
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ */
+void nnet_evaluate(const NNet *net, const Position *pos, Eval *ev);
+
+/**
+ * @brief Evaluates positions with a network in one call. The first layer
+ * of the first position is computed in full; every other position starts
+ * from the one before it and adds the rows of the inputs that differ, which
+ * are few when the positions come from the plays of one roll. Unrelated
+ * positions are computed in full. The output layer is computed for several
+ * positions at once.
+ *
+ * @param net the network
+ * @param positions the positions
+ * @param count number of positions
+ * @param evals output evaluations, from the point of view of the player
+ * to move of each position
+ */
+void nnet_evaluate_batch(const NNet *net, const Position positions[], unsigned count,
+		Eval evals[]);
+
+/**
+ * @brief Sets the network used by eval_nnet. The network must not be freed
+ * or modified while searches use it.
+ *
+ * @param net the network, NULL to fall back to eval_heuristic
+ */
+void nnet_set_current(const NNet *net);
+
+/**
+ * @brief Evaluator that uses the current network (see nnet_set_current),
+ * or the current bearoff databases when both players are bearing off.
+ *
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ */
+void eval_nnet(const Position *pos, Eval *ev);
+
+/**
+ * @brief Batch version of eval_nnet: positions covered by the bearoff
+ * databases are read from them, and each run of the others is evaluated
+ * with nnet_evaluate_batch.
+ *
+ * @param positions the positions
+ * @param count number of positions
+ * @param evals output evaluations, from the point of view of the player
+ * to move of each position
+ */
+void eval_nnet_batch(const Position positions[], unsigned count, Eval evals[]);
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file ponder.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Pondering: analysis of the opponent's likely replies in the
+ * background, so that the next search is answered from the cache
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_PONDER_H
+#define CORE_PONDER_H
+
+#include <core/search.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Replies of the player to move considered for each roll.
+ */
+#define PONDER_PLAYS		4
+
+/**
+ * @brief Most positions pondered: the replies to all the rolls.
+ */
+#define PONDER_MAX			(21 * PONDER_PLAYS)
+
+/**
+ * @brief A running ponder. The worker ranks the replies of the player to
+ * move, then evaluates the position after each of them, most likely
+ * first, with the depth of the engine that answers. The evaluations
+ * fill the cache of the settings; the ponder keeps nothing else, so its
+ * memory is bounded by PONDER_MAX positions.
+ *
+ */
+typedef struct ponder_t {
+	Position pos;
+	unsigned dice[2];
+	SearchOptions opts;
+	Match match;
+
+	Position replies[PONDER_MAX];
+	unsigned count;
+
+	pthread_t thread;
+	atomic_bool stop;
+	_Atomic unsigned done;
+	_Atomic uint64_t nodes;
+} Ponder;
+
+/**
+ * @brief Starts pondering a position on a background thread.
+ *
+ * @param pos the position, with the player to move (the one that thinks
+ * now) before or after the roll
+ * @param d0 value of the first die, 0 if the dice are not rolled yet
+ * @param d1 value of the second die, 0 if the dice are not rolled yet
+ * @param opts settings of the engine that answers: depth, evaluator,
+ * cache (required), match and threads
+ * @return Ponder* the ponder, NULL on error
+ */
+Ponder *ponder_start(const Position *pos, unsigned d0, unsigned d1,
+		const SearchOptions *opts);
+
+/**
+ * @brief Number of replies analyzed so far.
+ *
+ * @param ponder the ponder
+ * @return unsigned replies done
+ */
+unsigned ponder_done(Ponder *ponder);
+
+/**
+ * @brief Stops the ponder as soon as possible and frees it. Returns
+ * when its threads are finished.
+ *
+ * @param ponder the ponder, may be NULL
+ */
+void ponder_free(Ponder *ponder);
+
+#endif
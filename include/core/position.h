@@ -0,0 +1,94 @@
+/**
+ * @file position.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Compact position of the rules core for search and simulation
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_POSITION_H
+#define CORE_POSITION_H
+
+#include <core/game.h>
+
+/**
+ * @brief A position in one cache line. Points use the sign convention of
+ * Game.places; bar, off, steps and outside are indexed with SIDE_OF.
+ * turn is the direction of the player to move. hash is the Zobrist key of
+ * the position, kept up to date by make/unmake and position_switch_turn.
+ *
+ */
+typedef struct position_t {
+	int8_t points[24];
+	uint8_t bar[2];
+	uint8_t off[2];
+	int8_t turn;
+	uint8_t outside[2];
+	uint8_t reserved;
+	int16_t steps[2];
+	uint64_t hash;
+} Position;
+
+/**
+ * @brief Builds the position of a game. The player to move is game->direction.
+ *
+ * @param pos output position
+ * @param game Game instance
+ */
+void position_from_game(Position *pos, const Game *game);
+
+/**
+ * @brief Writes the pieces and the player to move of a position into a game.
+ * The dice of the game are not modified.
+ *
+ * @param pos the position
+ * @param game Game instance
+ */
+void position_to_game(const Position *pos, Game *game);
+
+/**
+ * @brief Applies a single movement of the player to move.
+ * The movement must be legal; no checks are done.
+ *
+ * @param pos the position
+ * @param m the movement
+ * @return int 1 if an opponent's piece was sent to prison, 0 otherwise.
+ * Must be passed back to position_unmake_move.
+ */
+int position_make_move(Position *pos, Movement m);
+
+/**
+ * @brief Reverts a movement applied by position_make_move.
+ *
+ * @param pos the position
+ * @param m the movement
+ * @param hit value returned by position_make_move
+ */
+void position_unmake_move(Position *pos, Movement m, int hit);
+
+/**
+ * @brief Passes the turn to the opponent.
+ *
+ * @param pos the position
+ */
+void position_switch_turn(Position *pos);
+
+/**
+ * @brief Returns the direction of the player who bore off all 15 pieces.
+ *
+ * @param pos the position
+ * @return int direction of the winner, 0 while the game is in progress
+ */
+int position_winner(const Position *pos);
+
+/**
+ * @brief Points earned by the winner: 1, 2 (gammon) or 3 (backgammon).
+ *
+ * @param pos the position
+ * @param win_dir direction of the winner
+ * @return unsigned the points earned by the winner
+ */
+unsigned position_winner_points(const Position *pos, int win_dir);
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * @file rng.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Small, seedable random generator for simulations, one per thread
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_RNG_H
+#define CORE_RNG_H
+
+#include <stdint.h>
+
+/**
+ * @brief State of a xoshiro256** generator. Not shared between threads
+ * or games: each one seeds its own stream, so no lock is needed and a
+ * seed and a stream replay the same numbers.
+ *
+ */
+typedef struct rng_t {
+	uint64_t s[4];
+} Rng;
+
+/**
+ * @brief Seeds a generator. Different streams of the same seed give
+ * unrelated sequences.
+ *
+ * @param rng the generator
+ * @param seed seed
+ * @param stream stream number, for example the thread index
+ */
+void rng_seed(Rng *rng, uint64_t seed, uint64_t stream);
+
+/**
+ * @brief Next 64 random bits.
+ *
+ * @param rng the generator
+ * @return uint64_t random number
+ */
+uint64_t rng_next(Rng *rng);
+
+/**
+ * @brief Rolls a die. The 6 values have exactly the same chance.
+ *
+ * @param rng the generator
+ * @return unsigned value between 1 and 6
+ */
+unsigned rng_die(Rng *rng);
+
+#endif
@@ -0,0 +1,182 @@
+/**
+ * @file rollout.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Monte Carlo rollouts of candidate positions on all the cores
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_ROLLOUT_H
+#define CORE_ROLLOUT_H
+
+#include <core/eval.h>
+#include <core/position.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Strata of a stratified rollout: the 36 first rolls.
+ */
+#define ROLLOUT_STRATA			36
+
+/**
+ * @brief Games of a candidate that cover every pair of first two rolls
+ * once in a stratified rollout.
+ */
+#define ROLLOUT_BLOCK			(ROLLOUT_STRATA * ROLLOUT_STRATA)
+
+/**
+ * @brief Settings of a rollout. Every game is played to the end by a 1-ply
+ * player using the evaluator.
+ * trials is the number of games per candidate (0: until stopped) and
+ * threads the number of workers (0: one per core).
+ * Variance reduction: stratify plays the first two rolls of the games of
+ * a candidate in turns over the 1296 pairs, instead of at random; luck
+ * measures the luck of every roll, the equity of its best play minus the
+ * mean over the 36 rolls (21 times the searches per game), and subtracts
+ * from the points of the games the part explained by their luck (a
+ * control variate fitted to the games). With precision, the rollout stops
+ * once the equity of every candidate has a smaller standard error, checked
+ * from the first ROLLOUT_BLOCK games on when stratified.
+ *
+ */
+typedef struct rollout_options_t {
+	unsigned trials;
+	unsigned threads;
+	Evaluator evaluate;
+	uint64_t seed;
+	bool stratify;
+	bool luck;
+	float precision;
+} RolloutOptions;
+
+/**
+ * @brief Results of one candidate so far, from the point of view of its
+ * player to move: mean outputs, their standard errors and the equity.
+ * plain_error is the standard error that the same number of games would
+ * give without variance reduction, so (plain_error / equity_error)^2
+ * plain games are worth one game of this rollout.
+ *
+ */
+typedef struct rollout_result_t {
+	Eval eval;
+	Eval std_error;
+	float equity;
+	float equity_error;
+	float plain_error;
+	uint64_t trials;
+} RolloutResult;
+
+/**
+ * @brief Sums of the games of a candidate with one first roll: games,
+ * points won, luck of the candidate's player, their squares and product.
+ *
+ */
+typedef struct rollout_stratum_t {
+	double games;
+	double points, points2;
+	double luck, luck2;
+	double points_luck;
+} RolloutStratum;
+
+/**
+ * @brief Sums of the games of one candidate: outputs and, for each first
+ * roll, points and luck.
+ *
+ */
+typedef struct rollout_sums_t {
+	uint64_t trials;
+	double out[EVAL_OUTPUTS];
+	RolloutStratum strata[ROLLOUT_STRATA];
+} RolloutSums;
+
+/**
+ * @brief A running rollout. Workers take games in turns over the
+ * candidates, so all of them advance at the same pace.
+ *
+ */
+typedef struct rollout_t {
+	Position *candidates;
+	unsigned count;
+	RolloutOptions opts;
+
+	pthread_t *threads;
+	unsigned thread_count;
+
+	pthread_mutex_t lock;
+	RolloutSums *sums;
+
+	_Atomic uint64_t next;
+	_Atomic bool stop;
+	_Atomic unsigned running;
+	_Atomic unsigned streams;
+} Rollout;
+
+/**
+ * @brief Default settings: 1296 games per candidate, one thread per core,
+ * heuristic evaluator, seed 1, stratified first rolls, no luck
+ * adjustment, no precision.
+ *
+ * @param opts output settings
+ */
+void rollout_options_init(RolloutOptions *opts);
+
+/**
+ * @brief Starts rolling out candidate positions in background threads.
+ * Each candidate is a position before the roll of its player to move.
+ *
+ * @param candidates positions to roll out, copied
+ * @param count number of candidates
+ * @param opts settings
+ * @return Rollout* the running rollout, NULL on error
+ */
+Rollout *rollout_start(const Position candidates[], unsigned count,
+		const RolloutOptions *opts);
+
+/**
+ * @brief Reads the results so far. Can be called while the rollout runs.
+ *
+ * @param rollout the rollout
+ * @param results output array, one entry per candidate
+ */
+void rollout_results(Rollout *rollout, RolloutResult results[]);
+
+/**
+ * @brief Checks if every worker has finished.
+ *
+ * @param rollout the rollout
+ * @return bool true when done or stopped
+ */
+bool rollout_done(Rollout *rollout);
+
+/**
+ * @brief Asks the workers to stop after their current game.
+ *
+ * @param rollout the rollout
+ */
+void rollout_stop(Rollout *rollout);
+
+/**
+ * @brief Stops the rollout, waits for the workers and frees it.
+ *
+ * @param rollout the rollout
+ */
+void rollout_free(Rollout *rollout);
+
+/**
+ * @brief Rolls out candidates and waits for the results.
+ *
+ * @param candidates positions to roll out
+ * @param count number of candidates
+ * @param opts settings (trials or precision must be set)
+ * @param results output array, one entry per candidate
+ * @return bool false on error
+ */
+bool rollout_run(const Position candidates[], unsigned count,
+		const RolloutOptions *opts, RolloutResult results[]);
+
+#endif
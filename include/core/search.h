@@ -0,0 +1,154 @@
+/**
+ * @file search.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Expectiminimax search over full plays and dice rolls
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_SEARCH_H
+#define CORE_SEARCH_H
+
+#include <core/cache.h>
+#include <core/eval.h>
+#include <core/met.h>
+#include <core/movegen.h>
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Most threads of one search.
+ */
+#define SEARCH_MAX_THREADS	64
+
+/**
+ * @brief Settings of a search.
+ * depth 1 evaluates the position after each play; every extra ply averages
+ * over the 21 rolls of the next player, who answers with a search one
+ * ply shallower.
+ * Plays are compared by cubeless equity, or by match winning chance when
+ * match is set.
+ * threads share the plays (or rolls) of the root, 0 for one per core.
+ * When stop is set and becomes true, or when the search_clock passes
+ * deadline (0 for none), the search returns as soon as possible with
+ * meaningless results.
+ *
+ */
+typedef struct search_options_t {
+	unsigned depth;
+	Evaluator evaluate;
+	Cache *cache;
+	const Match *match;
+	unsigned threads;
+	atomic_bool *stop;
+	double deadline;
+} SearchOptions;
+
+/**
+ * @brief Outcome of a search. equity is the measure the plays were
+ * compared by; stopped tells that the search did not complete; book that
+ * the play was taken from the opening book.
+ *
+ */
+typedef struct search_result_t {
+	Play play;
+	Eval eval;
+	float equity;
+	unsigned plays;
+	unsigned depth;
+	uint64_t nodes;
+	double seconds;
+	bool stopped;
+	bool book;
+} SearchResult;
+
+/**
+ * @brief Default settings: depth 1, heuristic evaluator, no cache,
+ * money play, one thread, never stopped, no deadline.
+ *
+ * @param opts output settings
+ */
+void search_options_init(SearchOptions *opts);
+
+/**
+ * @brief Chooses the play with the highest equity for a roll.
+ * When the search is stopped the result is the first play.
+ *
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param opts settings
+ * @param res output result: best play, its evaluation from the point of view
+ * of the player to move, number of plays, nodes and elapsed time
+ */
+void search_best_play(const Position *pos, unsigned d0, unsigned d1,
+		const SearchOptions *opts, SearchResult *res);
+
+/**
+ * @brief Evaluates every play of a roll and keeps the best ones, sorted
+ * by equity, best first.
+ *
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param opts settings
+ * @param plays output best plays
+ * @param evals output evaluations of the plays, from the point of view of
+ * the player to move
+ * @param max capacity of plays and evals
+ * @return unsigned number of plays stored, 0 if the search was stopped
+ */
+unsigned search_rank_plays(const Position *pos, unsigned d0, unsigned d1,
+		const SearchOptions *opts, Play plays[], Eval evals[], unsigned max);
+
+/**
+ * @brief Evaluates a position before the roll of the player to move.
+ * depth 0 is the static evaluation; depth n averages over the 21 rolls
+ * the best play found with a search of depth n.
+ *
+ * @param pos the position
+ * @param depth plies to look ahead
+ * @param opts settings (opts->depth is ignored)
+ * @param ev output evaluation, from the point of view of the player to move
+ * @return uint64_t number of nodes visited
+ */
+uint64_t search_evaluate(const Position *pos, unsigned depth,
+		const SearchOptions *opts, Eval *ev);
+
+/**
+ * @brief Iterative deepening: searches the roll with depth 1, 2, ... up
+ * to opts->depth while the time budget lasts, and keeps the result of
+ * the deepest search that completed. Depth 1 always completes.
+ * Rolls found in the current opening book are answered from it at once.
+ *
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param opts settings: opts->depth is the deepest search
+ * @param budget seconds, 0 for no limit
+ * @param res output result; depth is the depth reached, nodes and seconds
+ * add up every iteration
+ */
+void search_iterate(const Position *pos, unsigned d0, unsigned d1,
+		const SearchOptions *opts, double budget, SearchResult *res);
+
+/**
+ * @brief Monotonic clock used by the deadlines of the searches.
+ *
+ * @return double seconds
+ */
+double search_clock(void);
+
+/**
+ * @brief Tells whether searches with some settings are stopped: asked
+ * to stop, or past their deadline.
+ *
+ * @param opts settings
+ * @return bool true if stopped
+ */
+bool search_stopped(const SearchOptions *opts);
+
+#endif
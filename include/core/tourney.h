@@ -0,0 +1,103 @@
+/**
+ * @file tourney.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Matches between two engines, played without the GUI on all
+ * the cores, with the cube and the scoring of the game
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_TOURNEY_H
+#define CORE_TOURNEY_H
+
+#include <core/eval.h>
+#include <core/met.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Memory of the evaluation cache of each engine of each thread.
+ */
+#define TOURNEY_CACHE_SIZE		(4 * 1024 * 1024)
+
+/**
+ * @brief Memory of the search tree of each MCTS engine of each thread.
+ */
+#define TOURNEY_MCTS_MEMORY		(32 * 1024 * 1024)
+
+/**
+ * @brief Most threads of a tournament.
+ */
+#define TOURNEY_MAX_THREADS		64
+
+/**
+ * @brief Settings of an engine, like those of an AI player of the GUI.
+ * Plays are searched depth plies deep (search_iterate without a time
+ * limit), or by simulations of Monte Carlo tree search when it is not 0.
+ * Cube decisions search one ply less than depth; without cube, the
+ * engine never doubles and always takes.
+ *
+ */
+typedef struct tourney_engine_t {
+	unsigned depth;
+	uint64_t simulations;
+	Evaluator evaluate;
+	bool cube;
+} TourneyEngine;
+
+/**
+ * @brief Settings of a tournament: matches of length points between two
+ * engines. Engine 0 moves in direction -1; the engines take turns to
+ * start the games. met gives the match equities of the cube decisions
+ * and of the plays, NULL to play for money equity. Match n is played
+ * with the dice of stream n of seed, whatever the number of threads.
+ *
+ */
+typedef struct tourney_options_t {
+	TourneyEngine engines[2];
+	unsigned matches;
+	unsigned length;
+	unsigned threads;
+	uint64_t seed;
+	const Met *met;
+	void (*progress)(unsigned done, unsigned total);
+} TourneyOptions;
+
+/**
+ * @brief Results of a tournament, indexed by engine. gammons counts the
+ * games won by gammon or backgammon; points adds the points won in the
+ * games, cube included; net and net2 add the net points of engine 0 of
+ * each game and their squares, for the variance.
+ *
+ */
+typedef struct tourney_result_t {
+	unsigned matches;
+	unsigned wins[2];
+	uint64_t games;
+	uint64_t game_wins[2];
+	uint64_t gammons[2];
+	uint64_t points[2];
+	double net, net2;
+} TourneyResult;
+
+/**
+ * @brief Default settings: 2-ply engines with the cube and the heuristic
+ * evaluator, 100 matches of 7 points, one thread per core, seed 1,
+ * money equity, no progress report.
+ *
+ * @param opts output settings
+ */
+void tourney_options_init(TourneyOptions *opts);
+
+/**
+ * @brief Plays the matches and waits for the results.
+ *
+ * @param opts settings
+ * @param res output results
+ * @return bool false on error
+ */
+bool tourney_run(const TourneyOptions *opts, TourneyResult *res);
+
+#endif
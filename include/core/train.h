@@ -0,0 +1,134 @@
+/**
+ * @file train.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Self-play training of the network evaluator by TD(lambda)
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_TRAIN_H
+#define CORE_TRAIN_H
+
+#include <core/nnet.h>
+#include <core/rng.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Longest game kept for training. Longer games are cut and their
+ * last position is bootstrapped from the network.
+ */
+#define TRAIN_MAX_PLIES		1024
+
+/**
+ * @brief Settings of a training run. Every game is played by the network
+ * against itself, choosing the play with the best 0-ply equity.
+ * games is the number of games (0: until stopped) and threads the number
+ * of workers (0: one per core).
+ *
+ */
+typedef struct train_options_t {
+	unsigned games;
+	unsigned threads;
+	float rate;
+	float lambda;
+	uint64_t seed;
+} TrainOptions;
+
+/**
+ * @brief Totals of the games played so far. error is the sum of the
+ * squared errors of the trained positions, before each update.
+ *
+ */
+typedef struct train_stats_t {
+	uint64_t games;
+	uint64_t positions;
+	double error;
+} TrainStats;
+
+/**
+ * @brief A running training. All the workers update the same network
+ * without locks (Hogwild).
+ *
+ */
+typedef struct train_t {
+	NNet *net;
+	TrainOptions opts;
+
+	pthread_t *threads;
+	unsigned thread_count;
+
+	pthread_mutex_t lock;
+	TrainStats stats;
+
+	_Atomic uint64_t next;
+	_Atomic bool stop;
+	_Atomic unsigned running;
+	_Atomic unsigned streams;
+} Train;
+
+/**
+ * @brief Default settings: until stopped, one thread per core,
+ * rate 0.1, lambda 0.7, seed 1.
+ *
+ * @param opts output settings
+ */
+void train_options_init(TrainOptions *opts);
+
+/**
+ * @brief Plays one game of the network against itself and trains it on
+ * the lambda-returns of the game.
+ *
+ * @param net the network
+ * @param opts settings (rate and lambda)
+ * @param rng random generator of the thread
+ * @param stats totals to update
+ */
+void train_game(NNet *net, const TrainOptions *opts, Rng *rng, TrainStats *stats);
+
+/**
+ * @brief Starts training a network in background threads.
+ * The network must not be freed before train_free.
+ *
+ * @param net the network
+ * @param opts settings
+ * @return Train* the running training, NULL on error
+ */
+Train *train_start(NNet *net, const TrainOptions *opts);
+
+/**
+ * @brief Reads the totals so far. Can be called while the training runs.
+ *
+ * @param train the training
+ * @param stats output totals
+ */
+void train_stats(Train *train, TrainStats *stats);
+
+/**
+ * @brief Checks if every worker has finished.
+ *
+ * @param train the training
+ * @return bool true when done or stopped
+ */
+bool train_done(Train *train);
+
+/**
+ * @brief Asks the workers to stop after their current game.
+ *
+ * @param train the training
+ */
+void train_stop(Train *train);
+
+/**
+ * @brief Stops the training, waits for the workers and frees it.
+ * The network is not freed.
+ *
+ * @param train the training
+ */
+void train_free(Train *train);
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ * @file zobrist.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief 64-bit Zobrist keys of positions, updated incrementally
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef CORE_ZOBRIST_H
+#define CORE_ZOBRIST_H
+
+#include <core/position.h>
+
+#include <stdint.h>
+
+/**
+ * @brief Random keys. Points are indexed by the signed piece count + 15;
+ * bar and off by SIDE_OF and the piece count. The tables are filled before
+ * main runs, with a fixed seed, so keys are the same on every run.
+ */
+extern uint64_t zobrist_points[24][31];
+extern uint64_t zobrist_bar[2][16];
+extern uint64_t zobrist_off[2][16];
+extern uint64_t zobrist_turn;
+
+#define ZOBRIST_POINT(place, count)		(zobrist_points[place][(count) + 15])
+
+/**
+ * @brief Key of the pieces of a game, without the player to move.
+ *
+ * @param game Game instance
+ * @return uint64_t key of places, prisons and goals
+ */
+uint64_t zobrist_game(const Game *game);
+
+/**
+ * @brief Key of a position, player to move included.
+ *
+ * @param pos the position
+ * @return uint64_t key of the position
+ */
+uint64_t zobrist_position(const Position *pos);
+
+#endif
@@ -12,6 +12,8 @@
 
 #include <glib.h>
 #include <cairo.h>
+#include <core/game.h>
+#include <core/rng.h>
 
 // Drawing constants
 #define DICE_SIZE					0.065
@@ -22,22 +24,21 @@
 #define COLOR_DICE_DISABLE(cr)		cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 0.75)
 
 /**
- * @brief Chooses random values for dice[0] and dice[1].
+ * @brief Chooses random values for the dice of the game.
  * 
- * @param dice Set of dice
- * @param consumed Dice consumption flags
+ * @param game Rules state holding the dice
+ * @param rng Dice generator of the game
  */
-void dice_roll(guint dice[], gboolean consumend[]);
+void dice_roll(Game *game, Rng *rng);
 
 /**
  * @brief Draws the dice.
  * 
  * @param cr Cairo context
- * @param dice Set of dice
- * @param consumed Dice consumption flags
+ * @param game Rules state holding the dice
  * @param w Drawing area width
  * @param h Drawing area height
  */
-void dice_draw(cairo_t *cr, guint dice[], gboolean consumed[], gint w, gint h);
+void dice_draw(cairo_t *cr, const Game *game, gint w, gint h);
 
 #endif
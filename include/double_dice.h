@@ -11,11 +11,32 @@
 #ifndef DOUBLE_DICE_H
 #define DOUBLE_DICE_H
 
+#include <glib.h>
+
+/**
+ * @brief Tells whether the current player may double: the last double
+ * was not theirs and the cube is below 64.
+ * 
+ * @param bg Backgammon instance
+ * @return gboolean TRUE if they may
+ */
+gboolean double_allowed(void *bg);
+
 /**
- * @brief Doubles the dice for the current player
+ * @brief Doubles the dice for the current player: the opponent is asked,
+ * and answers through double_answer, at once or later
  * 
  * @param bg Backgammon instance
  */
 void double_perform(void *bg);
 
+/**
+ * @brief Answer of the opponent to a double: ends the round, or doubles
+ * the points and resumes the turn of the current player
+ * 
+ * @param bg Backgammon instance
+ * @param take TRUE if the opponent takes
+ */
+void double_answer(void *bg, gboolean take);
+
 #endif
@@ -10,7 +10,12 @@
 #ifndef DRAW_H
 #define DRAW_H
 
-#include <backgammon.h>
+#include <render.h>
+
+/**
+ * @brief Piece color of the checkers of a place value
+ */
+#define DRAW_PIECE_OF(state, data)	((state)->pieces[(data) > 0 ? 1 : 0])
 
 /**
  * @brief Draws a triangle with orientation based on the place index and color.
@@ -28,12 +33,12 @@ void draw_colored_triangle(cairo_t *cr, Place place, guchar color,
  * @brief Draws the set of pieces at a specific place.
  * 
  * @param cr Cairo context
- * @param bg Backgammon instance
+ * @param state state of the board
  * @param place The place where the pieces are located
  * @param w Width of the drawing area
  * @param h Height of the drawing area
  */
-void draw_piece_group(cairo_t *cr, Backgammon *bg, Place place, gint w, gint h);
+void draw_piece_group(cairo_t *cr, const RenderState *state, Place place, gint w, gint h);
 
 /**
  * @brief Draws a target mark at a specific place.
@@ -49,22 +54,31 @@ void draw_mark(cairo_t *cr, Place place, gint w, gint h);
  * @brief Draws the pieces in a prison.
  * 
  * @param cr Cairo context
- * @param bg Backgammon instance
+ * @param state state of the board
  * @param prison The prison to be drawn
  * @param w Width of the drawing area
  * @param h Height of the drawing area
  */
-void draw_prison(cairo_t *cr, Backgammon *bg, gint prison, gint w, gint h);
+void draw_prison(cairo_t *cr, const RenderState *state, gint prison, gint w, gint h);
 
 /**
  * @brief Draws the pieces in the goal area.
  * 
  * @param cr Cairo context
- * @param bg Backgammon instance
+ * @param state state of the board
  * @param goal The goal area to be drawn
  * @param w Width of the drawing area
  * @param h Height of the drawing area
  */
-void draw_goal(cairo_t *cr, Backgammon *bg, gint goal, gint w, gint h);
+void draw_goal(cairo_t *cr, const RenderState *state, gint goal, gint w, gint h);
+
+/**
+ * @brief Draws the whole board: the places, the pieces, the marks, the
+ * selection, the dice, the prisons and the goals.
+ *
+ * @param cr Cairo context
+ * @param state state of the board
+ */
+void draw_board(cairo_t *cr, const RenderState *state);
 
 #endif
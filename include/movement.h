@@ -12,28 +12,7 @@
 
 #include <gtk/gtk.h>
 #include <backgammon.h>
-
-/**
- * @brief Represents a possible move
- * 
- */
-typedef struct movement_t {
-    gint src, dest;
-    gboolean prison_src, goal_dest;
-	guint dice_value;
-} Movement;
-
-/**
- * @brief Creates a new instance of Movement
- * 
- * @param src source
- * @param dest destination
- * @param prison_src source as prison
- * @param goal_dest destination as goal
- * @return Movement* a new instance of Movement
- */
-Movement *movement_new(gint src, gint dest, gboolean prison_src,
-			gboolean goal_dest, guint dice_value);
+#include <core/game.h>
 
 /**
  * @brief Searches for possible moves for the current player.
@@ -56,6 +35,6 @@ void clean_movements(Backgammon *bg);
  * @param bg Backgammon instance
  * @param movement the register movement
  */
-void move_piece(Backgammon *bg, Movement *movement);
+void move_piece(Backgammon *bg, Movement movement);
 
 #endif
@@ -13,6 +13,13 @@
 #include <gtk/gtk.h>
 #include <backgammon.h>
 
+/**
+ * @brief Index of the MCTS AI in the player combos, and the depth of the
+ * searches of its cube decisions
+ */
+#define NEW_DIALOG_MCTS				4
+#define NEW_DIALOG_MCTS_DEPTH		2
+
 /**
  * @brief NewDialog data type
  * 
@@ -23,7 +30,7 @@ typedef struct new_dialog_t {
 	GtkComboBoxText *pl1_combo, *pl2_combo;
 	GtkButton *clockwise_button, *piece_button;
 	GtkImage *clockwise_image, *piece_image;
-	GtkAdjustment *score_adj;
+	GtkAdjustment *score_adj, *pl1_time_adj, *pl2_time_adj;
 	Backgammon *bg;
 	gboolean clockwise, white;
 } NewDialog;
@@ -12,18 +12,29 @@
 
 #include <glib.h>
 
+/**
+ * @brief Thinking of an AI player on a worker thread.
+ */
+typedef struct ia_job_t IaJob;
+
 /**
  * @brief Structure for a generic player that associates the name,
  * piece, and direction on the board.
  * It contains a function pointer to change behavior
  * based on whether it's a human or AI player.
+ * search_depth is the deepest look-ahead of an AI player, in plies, and
+ * think_time the seconds it may think on each decision. An mcts AI
+ * chooses its plays by Monte Carlo tree search; its cube decisions use
+ * search_depth.
  * 
  */
 typedef struct player_t {
 	GString *name;
 	gint piece, direction, score, double_points;
 	gboolean (*play_func)(void *, gboolean);
-	gboolean ia;
+	gboolean ia, mcts;
+	guint search_depth;
+	gdouble think_time;
 } Player;
 
 /**
@@ -35,7 +46,8 @@ typedef struct player_t {
 void player_update(void *bg);
 
 /**
- * @brief Counts the number of steps the player needs to win
+ * @brief Returns the number of steps the player needs to win.
+ * The count is maintained by the rules core, so this is O(1).
  * 
  * @param bg Instance of Backgammon
  * @param player Target player
@@ -47,8 +59,9 @@ guint player_count_steps(void *bg, Player *player);
  * @brief Function assigned to a player to configure them as a human player.
  * 
  * @param bg Backgammon instance
- * @param double_request TRUE when the player is asked to double
- * @return boolean FALSE if opponent rejects the double
+ * @param double_request TRUE when the player is asked to answer a double;
+ * the answer goes to double_answer
+ * @return boolean TRUE
  */
 gboolean human_play_func(void *bg, gboolean double_request);
 
@@ -56,8 +69,9 @@ gboolean human_play_func(void *bg, gboolean double_request);
  * @brief Function assigned to a player to configure them as an artificial intelligence.
  * 
  * @param bg Backgammon instance
- * @param double_request TRUE when the player is asked to double
- * @return boolean FALSE if opponent rejects the double
+ * @param double_request TRUE when the player is asked to answer a double;
+ * the answer goes to double_answer
+ * @return boolean TRUE
  */
 gboolean ia_play_func(void *bg, gboolean double_request);
 
@@ -69,4 +83,22 @@ gboolean ia_play_func(void *bg, gboolean double_request);
  */
 gboolean ia_delayed_func(gpointer data);
 
+/**
+ * @brief Delay before the next step of an AI player: none when it has
+ * to think, since thinking takes its time budget; the pace of the
+ * movements otherwise.
+ * 
+ * @param bg Backgammon instance
+ * @return guint delay in milliseconds
+ */
+guint ia_step_delay(void *bg);
+
+/**
+ * @brief Cancels the pending turn of the AI: the delay, the ponder, and
+ * the search running on the worker thread, whose result is dropped.
+ * 
+ * @param bg Backgammon instance
+ */
+void ia_cancel(void *bg);
+
 #endif
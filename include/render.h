@@ -0,0 +1,96 @@
+/**
+ * @file render.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Rendering of the board on a worker thread, into two image
+ * surfaces: the draw signal only copies the last finished frame
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <board.h>
+
+/**
+ * @brief Everything a frame shows, copied from the board on the main
+ * thread: the painting never reads the game while it changes.
+ * pieces holds the piece color of the checkers of each direction,
+ * indexed by SIDE_OF(direction). width and height are the size of the
+ * drawing area, scale its device scale (HiDPI).
+ *
+ */
+typedef struct render_state_t {
+	Game game;
+	Place places[24], goal[2];
+	gint selected, prison_sel;
+	gint pieces[2];
+	gint width, height, scale;
+} RenderState;
+
+/**
+ * @brief Timing counters of the renderer, in microseconds. Frames are
+ * painted on the worker; draws (copying a frame to the window) and input
+ * (the click handler) run on the main thread.
+ *
+ */
+typedef struct render_stats_t {
+	guint64 frames, frame_time, frame_max;
+	guint64 draws, draw_time, draw_max;
+	guint64 inputs, input_time, input_max;
+} RenderStats;
+
+/**
+ * @brief Creates a renderer and starts its worker thread.
+ *
+ * @param area DrawingArea that shows the frames
+ * @return Render* New instance of Render
+ */
+Render *render_new(GtkWidget *area);
+
+/**
+ * @brief Stops the worker thread and frees the renderer.
+ *
+ * @param render Render instance, may be NULL
+ */
+void render_free(Render *render);
+
+/**
+ * @brief Asks for a frame of a state. Nothing is painted if the state is
+ * the one of the last request; otherwise the worker paints it and the
+ * area is redrawn when it is done.
+ *
+ * @param render Render instance
+ * @param state state of the board
+ */
+void render_request(Render *render, const RenderState *state);
+
+/**
+ * @brief Copies the last finished frame to a Cairo context. A frame of
+ * another size is scaled to fit until the new one is ready.
+ *
+ * @param render Render instance
+ * @param cr Cairo context of the draw signal
+ * @param width width of the area
+ * @param height height of the area
+ */
+void render_blit(Render *render, cairo_t *cr, gint width, gint height);
+
+/**
+ * @brief Counts the time spent handling an input event.
+ *
+ * @param render Render instance
+ * @param elapsed microseconds spent
+ */
+void render_count_input(Render *render, gint64 elapsed);
+
+/**
+ * @brief Reads the timing counters.
+ *
+ * @param render Render instance
+ * @param stats output counters
+ */
+void render_get_stats(Render *render, RenderStats *stats);
+
+#endif
@@ -0,0 +1,65 @@
+/**
+ * @file rollout_dialog.h
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Dialog that rolls out the current decision and shows the results
+ * while they arrive
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef ROLLOUT_DIALOG_H
+#define ROLLOUT_DIALOG_H
+
+#include <gtk/gtk.h>
+#include <backgammon.h>
+
+#include <core/movegen.h>
+#include <core/rollout.h>
+
+/**
+ * @brief Number of candidate plays rolled out, the best ones at 1-ply
+ */
+#define ROLLOUT_CANDIDATES			5
+
+/**
+ * @brief Interval between refreshes of the results, in milliseconds
+ */
+#define ROLLOUT_REFRESH_TIMEOUT		250
+
+/**
+ * @brief RolloutDialog data type.
+ * With plays, each candidate is the position after one of them;
+ * otherwise the only candidate is the position before the roll.
+ *
+ */
+typedef struct rollout_dialog_t {
+	GtkWindow *window;
+	GtkButton *stop_button;
+	GtkLabel *results_label;
+	Rollout *rollout;
+	Play plays[ROLLOUT_CANDIDATES];
+	guint count, timer;
+	gboolean with_plays;
+	gint direction;
+	Backgammon *bg;
+} RolloutDialog;
+
+/**
+ * @brief Creates a RolloutDialog and starts the rollout of the current
+ * decision: the best plays of the dice just rolled, or the position
+ * before the roll.
+ *
+ * @param bg Instance of Backgammon
+ * @return RolloutDialog* RolloutDialog instance, NULL if there is nothing to analyze
+ */
+RolloutDialog *rollout_dialog_new(Backgammon *bg);
+
+/**
+ * @brief Shows the RolloutDialog.
+ *
+ * @param dialog Instance of RolloutDialog
+ */
+void rollout_dialog_show(RolloutDialog *dialog);
+
+#endif
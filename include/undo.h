@@ -21,6 +21,9 @@ typedef struct undo_t {
 	gint places[24];
 	gint prison[2];
 	gint goal[2];
+	gint steps[2];
+	gint outside[2];
+	guint64 hash;
 } Undo;
 
 /**
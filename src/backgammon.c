@@ -13,11 +13,13 @@
 #include <new_dialog.h>
 #include <utils.h>
 #include <results_dialog.h>
+#include <rollout_dialog.h>
 
 #include <undo.h>
 #include <double_dice.h>
 
 #include <libintl.h>
+#include <stdlib.h>
 
 #define _(str)		gettext(str)
 
@@ -77,6 +79,20 @@ static void new_game_menu_item_activate(GtkMenuItem *menu_item, gpointer data) {
 	new_dialog_show(new_dialog_new((Backgammon *)data));
 }
 
+/**
+ * @brief Occurs when clicking on the "game"->"rollout" menu item.
+ * Rolls out the decision of the current player and shows the results.
+ * 
+ * @param menu_item Rollout menu item
+ * @param data Backgammon instance
+ */
+static void rollout_menu_item_activate(GtkMenuItem *menu_item, gpointer data) {
+	RolloutDialog *dialog;
+
+	dialog = rollout_dialog_new((Backgammon *)data);
+	if (dialog) rollout_dialog_show(dialog);
+}
+
 /**
  * @brief Occurs when clicking the "Next Turn" button.
  * Typically associated with the human player. Switches to the next player's turn.
@@ -138,8 +154,18 @@ Backgammon *bg_new(int argc, char *argv[]) {
 	GtkBuilder *builder;
 	GtkCssProvider *css_provider;
 	GdkScreen *screen;
-
-	bg = (Backgammon *)g_malloc(sizeof(Backgammon));
+	GError *error = NULL;
+	gint64 seed = 0;
+	gint game = 0;
+	GOptionEntry entries[] = {
+		{"seed", 's', 0, G_OPTION_ARG_INT64, &seed,
+				"Seed of the dice (default: from the clock)", "SEED"},
+		{"game", 'g', 0, G_OPTION_ARG_INT, &game,
+				"Number of the first game, to replay a game of a seed", "N"},
+		{NULL}
+	};
+
+	bg = (Backgammon *)g_malloc0(sizeof(Backgammon));
 
 	// Default names
 
@@ -148,7 +174,22 @@ Backgammon *bg_new(int argc, char *argv[]) {
 
 	bg->max_score = 15;
 
-	gtk_init(&argc, &argv);
+	bg->player[0].think_time = IA_THINK_TIME;
+	bg->player[1].think_time = IA_THINK_TIME;
+	bg->player[0].mcts = FALSE;
+	bg->player[1].mcts = FALSE;
+	bg->player[0].search_depth = 1;
+	bg->player[1].search_depth = 1;
+
+	// error is only set by a bad option; otherwise there is no display
+	if (!gtk_init_with_args(&argc, &argv, NULL, entries, NULL, &error)) {
+		g_printerr("%s\n", error ? error->message : "Cannot open display");
+		exit(1);
+	}
+
+	// Each game starts by counting itself, so the first one is number game
+	bg->seed = seed ? (guint64) seed : (guint64) g_get_real_time();
+	bg->game = (guint) game - 1;
 
 	css_provider = gtk_css_provider_new();
 	gtk_css_provider_load_from_path(css_provider, "ui/styles.css", NULL);
@@ -206,6 +247,12 @@ Backgammon *bg_new(int argc, char *argv[]) {
 		G_CALLBACK(new_game_menu_item_activate), bg
 	);
 
+	g_signal_connect(
+		gtk_builder_get_object(builder, "rollout-menu-item"),
+		"activate",
+		G_CALLBACK(rollout_menu_item_activate), bg
+	);
+
 	g_signal_connect(
 		gtk_builder_get_object(builder, "quit-menu-item"),
 		"activate",
@@ -237,6 +284,33 @@ Backgammon *bg_new(int argc, char *argv[]) {
 	bg->player_turn = -1;
 	bg->status = S_NOT_PLAYING;
 
+	// The network evaluator, when its weights are available
+	bg->net = nnet_load(NNET_WEIGHTS_FILE);
+	nnet_set_current(bg->net);
+	bg->evaluate = bg->net ? eval_nnet : eval_heuristic;
+
+	// Exact bearoff evaluations, when the database is available
+	bg->bearoff = bearoff_open(BEAROFF_FILE);
+	bearoff_set_current(bg->bearoff);
+	bg->bearoff2 = bearoff2_open(BEAROFF2_FILE);
+	bearoff2_set_current(bg->bearoff2);
+
+	// Instant plays of the opening, when the book is available
+	bg->book = book_open(BOOK_FILE);
+	book_set_current(bg->book);
+
+	// Match winning chances, to play and double by the score
+	bg->met = met_open(MET_FILE);
+
+	bg->cache = cache_new(IA_CACHE_SIZE);
+	bg->mcts[0] = bg->mcts[1] = NULL;
+	bg->ia_job = NULL;
+	bg->ia_timer = 0;
+	bg->ia_ready = FALSE;
+	bg->ia_play.count = 0;
+	bg->ia_move = 0;
+	bg->ponder = NULL;
+
 	return bg;
 }
 
@@ -258,7 +332,22 @@ void bg_run(Backgammon *bg) {
  * @param bg Backgammon instance
  */
 void bg_free(Backgammon *bg) {
+	// The worker and the ponder use the evaluator and the cache
+	ia_cancel(bg);
+
 	board_free(bg->board);
+	cache_free(bg->cache);
+	mcts_free(bg->mcts[0]);
+	mcts_free(bg->mcts[1]);
+	nnet_set_current(NULL);
+	nnet_free(bg->net);
+	bearoff_set_current(NULL);
+	bearoff_close(bg->bearoff);
+	bearoff2_set_current(NULL);
+	bearoff2_close(bg->bearoff2);
+	book_set_current(NULL);
+	book_close(bg->book);
+	met_free(bg->met);
 	g_string_free(bg->player[0].name, TRUE);
 	g_string_free(bg->player[1].name, TRUE);
 	g_free(bg);
@@ -274,6 +363,13 @@ void bg_free(Backgammon *bg) {
 void bg_next_step(Backgammon *bg) {
 
 	if (bg->status == S_NOT_PLAYING) {
+		// A new stream of dice for each game, abandoned ones included
+		bg->game ++;
+		rng_seed(&bg->dice, bg->seed, bg->game);
+#ifdef BG_DEBUG
+		g_print("Game %u, seed %" G_GUINT64_FORMAT "\n", bg->game, bg->seed);
+#endif
+
 		bg->player_turn = -1;
 		bg_next_turn(bg);
 	}
@@ -281,12 +377,15 @@ void bg_next_step(Backgammon *bg) {
 	player_update(bg);
 
 	if (bg_check_end_game(bg)) {
+		// Nothing left to ponder
+		ia_cancel(bg);
 		bg_end_game(bg);
 		return ;
 	}
 
 	if (bg_current_player(bg)->ia) {
-		g_timeout_add(DELAYED_FUNC_TIMEOUT, ia_delayed_func, bg);
+		// Thinking starts at once; it takes the time budget of the player
+		bg->ia_timer = g_timeout_add(ia_step_delay(bg), ia_delayed_func, bg);
 	} else bg_current_player(bg)->play_func(bg, FALSE);
 }
 
@@ -303,6 +402,9 @@ void bg_next_turn(Backgammon *bg) {
 	bg->player_turn++;
 	if (bg->player_turn >= 2) bg->player_turn = 0;
 
+	// The rules core moves the pieces of the current player
+	bg->board->game.direction = bg_current_player(bg)->direction;
+
 	str = g_string_new("");
 	g_string_printf(str, _("%s' turn"), bg_current_player(bg)->name->str);
 	gtk_label_set_text(bg->turn_label, str->str);
@@ -357,26 +459,7 @@ Player *bg_player_by_data(Backgammon *bg, gint data) {
  * @return gboolean True if all the pieces are in the territory of the current player.
 */
 gboolean bg_all_pieces_in_territory(Backgammon *bg) {
-	Player *cplayer;
-	Board *board;
-	guint i, start, end;
-
-	cplayer = bg_current_player(bg);
-	board = bg->board;
-
-	if (cplayer->direction == -1) {
-		if (board->prison[1]) return FALSE;
-		start = 6; end = 24;
-	} else {
-		if (board->prison[0]) return FALSE;
-		start = 0; end = 18;
-	}
-	
-	for (i = start; i < end; i ++) {
-		if (board->places[i].data * cplayer->direction > 0) return FALSE;
-	}
-
-	return TRUE;
+	return game_all_pieces_in_territory(&bg->board->game);
 }
 
 /**
@@ -386,8 +469,7 @@ gboolean bg_all_pieces_in_territory(Backgammon *bg) {
  * @return gboolean True when one of the players has removed all their pieces.
  */
 gboolean bg_check_end_game(Backgammon *bg) {
-	return bg->board->goal[0].data == 15 || bg->board->goal[0].data == -15 ||
-		bg->board->goal[1].data == 15 || bg->board->goal[1].data == -15;
+	return game_winner(&bg->board->game) != 0;
 }
 
 /**
@@ -404,13 +486,8 @@ void bg_end_game(Backgammon *bg) {
 
 	bg->status = S_END_ROUND;
 
-	if (bg->board->goal[0].data == -15 || bg->board->goal[0].data == 15) {
-		winner = bg->player[0].direction == -1 ?
-					&bg->player[0] : &bg->player[1];
-	} else {
-		winner = bg->player[0].direction == 1 ?
-					&bg->player[0] : &bg->player[1];
-	}
+	winner = bg->player[0].direction == game_winner(&bg->board->game) ?
+				&bg->player[0] : &bg->player[1];
 
 	// Get points: 1 normal; 2 gammon; 3 backgammon
 	score = get_winner_points(bg, winner->direction);
@@ -442,33 +519,5 @@ void bg_end_game(Backgammon *bg) {
  * @return guint The points earned by the winner
  */
 guint get_winner_points(Backgammon *bg, gint win_dir) {
-	Board *b;
-	guint points, i;
-	b = bg->board;
-
-	points = 1;
-
-	// Check Gammon
-	if (win_dir == -1) {
-		if (b->goal[1].data) return points;
-	} else {
-		if (b->goal[0].data) return points;
-	}
-
-	points ++;
-
-	// Check backgammon
-	if (win_dir == -1) {
-		if (b->prison[0]) return points + 1;
-		for (i = 0; i < 6; i ++) {
-			if (b->places[i].data * win_dir < 0) return points + 1;
-		}
-	} else {
-		if (b->prison[1]) return points + 1;
-		for (i = 18; i < 24; i ++) {
-			if (b->places[i].data * win_dir < 0) return points + 1;
-		}
-	}
-
-	return points;
+	return game_winner_points(&bg->board->game, win_dir);
 }
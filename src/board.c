@@ -9,93 +9,80 @@
  */
 #include <board.h>
 #include <cairo.h>
-#include <dice.h>
 
 #include <backgammon.h>
-#include <draw.h>
+#include <render.h>
 #include <click.h>
 
+#include <string.h>
+
 /**
- * @brief Occurs when drawing the board
+ * @brief Copies what the board shows, at the size of the drawing area.
  * 
+ * @param bg Backgammon instance
  * @param area DrawingArea
- * @param cr Cairo context
- * @param data Backgammon instance
- * @return gboolean TRUE if there were no problems while drawing
+ * @param state output state
  */
-static gboolean board_on_draw(GtkWidget *area, cairo_t *cr, gpointer data) {
-	gdouble w, h;
-	gint i;
-
-	Backgammon *bg;
-	Board *board;
-
-	bg = (Backgammon *) data;
-	board = bg->board;
-
-	w = gtk_widget_get_allocated_width(area);
-	h = gtk_widget_get_allocated_height(area);
+static void board_snapshot(Backgammon *bg, GtkWidget *area, RenderState *state) {
+	Board *board = bg->board;
+	guint i;
 
-	// Aspect ratio
-	if (h > w * BOARD_RATIO) {
-		h = w * BOARD_RATIO;
-	} else {
-		w = h * (1.0 / BOARD_RATIO);
-	}
+	// Zeroed padding: states are compared with memcmp
+	memset(state, 0, sizeof(RenderState));
 
-	// Background
-	COLOR_BACKGROUND(cr);
-	cairo_paint(cr);
+	state->game = board->game;
+	memcpy(state->places, board->places, sizeof(board->places));
+	memcpy(state->goal, board->goal, sizeof(board->goal));
+	state->selected = board->selected;
+	state->prison_sel = board->prison_sel;
 
-	// Triangles, pieces, and marks
-	for (i = 0; i < 24; i ++) {
-		draw_colored_triangle(cr, board->places[i], i % 2, w, h);
-		draw_piece_group(cr, bg, board->places[i], w, h);
-		draw_mark(cr, board->places[i], w, h);
-	}
+	for (i = 0; i < 2; i ++)
+		state->pieces[SIDE_OF(bg->player[i].direction)] = bg->player[i].piece;
 
-	// Bars
-	COLOR_BAR(cr);
-	cairo_rectangle(cr, w * 0.0714 * 6, 0, w * 0.0714, h);
-	cairo_rectangle(cr, w * 0.0714 * 13, 0, w * 0.0714, h);
-	cairo_fill(cr);
-
-	// Selection
-	if (board->selected != -1) {
-		COLOR_SELECTION(cr);
-		cairo_rectangle(cr, board->places[board->selected].x * w,
-			board->places[board->selected].y * h,
-			PLACE_SIZE * w, TRIANGLE_HEIGHT * h);
-		cairo_stroke(cr);
-	}
+	state->width = gtk_widget_get_allocated_width(area);
+	state->height = gtk_widget_get_allocated_height(area);
+	state->scale = gtk_widget_get_scale_factor(area);
+}
 
-	if (board->prison_sel != -1) {
-		COLOR_SELECTION(cr);
-		if (board->prison_sel == 0)
-			cairo_rectangle(cr, PLACE_SIZE * 6 * w,
-				0.21 * h, PLACE_SIZE * w, PLACE_SIZE * w);
-		else
-			cairo_rectangle(cr, PLACE_SIZE * 6 * w,
-				0.66 * h, PLACE_SIZE * w, PLACE_SIZE * w);
-		cairo_stroke(cr);
-	}
+/**
+ * @brief Occurs when drawing the board. The board is painted on the
+ * render thread: this asks for a frame of the current state and copies
+ * the last finished one.
+ * 
+ * @param area DrawingArea
+ * @param cr Cairo context
+ * @param data Backgammon instance
+ * @return gboolean TRUE if there were no problems while drawing
+ */
+static gboolean board_on_draw(GtkWidget *area, cairo_t *cr, gpointer data) {
+	Backgammon *bg = (Backgammon *) data;
+	RenderState state;
 
-	// Dice
-	dice_draw(cr, board->dice, board->consumed_dice, w, h);
+	board_snapshot(bg, area, &state);
+	render_request(bg->board->render, &state);
+	render_blit(bg->board->render, cr, state.width, state.height);
 
-	// Prisons
-	draw_prison(cr, bg, 0, w, h);
-	draw_prison(cr, bg, 1, w, h);
+	return TRUE;
+}
 
-	// Goal
-	draw_goal(cr, bg, 0, w, h);
-	draw_goal(cr, bg, 1, w, h);
+/**
+ * @brief Occurs when a mouse button is pressed on the board: handles the
+ * click and counts the time it took.
+ * 
+ * @param area DrawingArea
+ * @param event Mouse button event
+ * @param data Backgammon instance
+ * @return gboolean result of board_on_click
+ */
+static gboolean board_on_button_press(GtkWidget *area, GdkEventButton *event, gpointer data) {
+	Backgammon *bg = (Backgammon *) data;
+	gint64 start = g_get_monotonic_time();
+	gboolean result;
 
-	// Goal marks
-	draw_mark(cr, board->goal[0], w, h);
-	draw_mark(cr, board->goal[1], w, h);
+	result = board_on_click(GTK_DRAWING_AREA(area), event, data);
+	render_count_input(bg->board->render, g_get_monotonic_time() - start);
 
-	return TRUE;
+	return result;
 }
 
 /**
@@ -114,9 +101,11 @@ Board *board_new(GtkBuilder *builder, void *bg) {
 	gtk_widget_set_events(
 		GTK_WIDGET(board->drawing_area),
 		GDK_BUTTON_PRESS_MASK);
-	g_signal_connect(board->drawing_area, "button-press-event", G_CALLBACK(board_on_click), bg);
+	g_signal_connect(board->drawing_area, "button-press-event", G_CALLBACK(board_on_button_press), bg);
+
+	board->render = render_new(GTK_WIDGET(board->drawing_area));
 
-	board->movements = NULL;
+	board->movements.count = 0;
 
 	board_reset(board);
 
@@ -129,6 +118,7 @@ Board *board_new(GtkBuilder *builder, void *bg) {
  * @param board Board instance
  */
 void board_free(Board *board) {
+	render_free(board->render);
 	g_free(board);
 }
 
@@ -138,36 +128,7 @@ void board_free(Board *board) {
  * @param board Board instance
  */
 void board_init(Board *board) {
-	guint i;
-
-	for (i = 0; i < 23; i ++) board->places[i].data = 0;
-	for (i = 0; i < 2; i ++) {
-		board->goal[i].data = 0;
-		board->prison[i] = 0;
-	}
-
-	// Test:
-/*
-	board->goal[0].data = -13;
-	board->goal[1].data = 13;
-*/	
-
-	board->places[0].data = 2;
-	board->places[5].data = -5;
-	board->places[7].data = -3;
-	board->places[11].data = 5;
-	board->places[12].data = -5;
-	board->places[16].data = 3;
-	board->places[18].data = 5;
-	board->places[23].data = -2;
-
-/*
-	board->places[0].data = -2;
-	board->places[23].data = 2;
-*/
-
-	// Dice
-	for (i = 0; i < 4; i ++) board->consumed_dice[i] = FALSE;
+	game_init(&board->game);
 }
 
 /**
@@ -179,12 +140,14 @@ void board_reset(Board *board) {
 	guint i;
 	gdouble x = 1.0 - PLACE_SIZE * 2;
 
-	// Arrange the pieces
+	// Clear the pieces and the dice
+	game_reset(&board->game);
+
+	// Arrange the places
 	for (i = 0; i < 24; i ++) {
 		board->places[i].mark = FALSE;
 
 		board->places[i].id = i;
-		board->places[i].data = 0;
 		board->places[i].x = x;
 		board->places[i].y = i < 12 ? 0 : 1.0 - TRIANGLE_HEIGHT;
 		if (i < 12) x -= PLACE_SIZE;
@@ -197,23 +160,15 @@ void board_reset(Board *board) {
 	board->selected = -1;
 	board->prison_sel = -1;
 
-	board->prison[0] = 0;
-	board->prison[1] = 0;
-
 	board->goal[0].id = 0;
-	board->goal[0].data = 0;
 	board->goal[0].x = board->goal[1].x = 1.0 - PLACE_SIZE * 1;
 	board->goal[0].y = 0;
 	board->goal[0].mark = FALSE;
 
 	board->goal[1].id = 23;
-	board->goal[1].data = 0;
 	board->goal[1].y = 1.0 - TRIANGLE_HEIGHT;
 	board->goal[1].mark = FALSE;
 
-	board->dice[0] = 1;
-	board->dice[1] = 1;
-
 	board->enable_dice = FALSE;
 	board->enable_places = FALSE;
 }
@@ -125,7 +125,7 @@ gboolean board_on_click(GtkDrawingArea *drw, GdkEventButton *event, gpointer dat
  * @param bg Backgammon instance
  */
 void dice_click(Backgammon *bg) {
-	dice_roll(bg->board->dice, bg->board->consumed_dice);
+	dice_roll(&bg->board->game, &bg->dice);
 
 	// Store undo board info
 	undo_backup(bg);
@@ -144,9 +144,8 @@ void dice_click(Backgammon *bg) {
  */
 void place_click(Backgammon *bg, Place *place) {
 	Board *b = bg->board;
-	GList *iter;
-	Movement *m;
-	guint cdir;
+	Movement m;
+	guint i, cdir;
 
 	cdir = bg_current_player(bg)->direction;
 
@@ -154,9 +153,9 @@ void place_click(Backgammon *bg, Place *place) {
 	if (place->mark) {
 		if (b->selected != -1) {
 			// Place origin selected
-			for (iter = b->movements; iter; iter = iter->next) {
-				m = (Movement *) iter->data;
-				if (m->src == b->selected && m->dest == place->id) {
+			for (i = 0; i < b->movements.count; i ++) {
+				m = b->movements.moves[i];
+				if (MOVEMENT_SRC(m) == b->selected && MOVEMENT_DEST(m) == place->id) {
 					// Clear selections
 					b->prison_sel = -1;
 					b->selected = -1;
@@ -169,9 +168,9 @@ void place_click(Backgammon *bg, Place *place) {
 			}
 		} else {
 			// Prison origin selected
-			for (iter = b->movements; iter; iter = iter->next) {
-				m = (Movement *) iter->data;
-				if (m->prison_src && m->dest == place->id) {
+			for (i = 0; i < b->movements.count; i ++) {
+				m = b->movements.moves[i];
+				if (MOVEMENT_PRISON_SRC(m) && MOVEMENT_DEST(m) == place->id) {
 					// Clear selections
 					b->prison_sel = -1;
 					b->selected = -1;
@@ -195,15 +194,15 @@ void place_click(Backgammon *bg, Place *place) {
 		b->selected = place->id;
 
 		// Find movements by source
-		for (iter = b->movements; iter; iter = iter->next) {
-			m = (Movement *)iter->data;
-			if (m->src == place->id) {
+		for (i = 0; i < b->movements.count; i ++) {
+			m = b->movements.moves[i];
+			if (MOVEMENT_SRC(m) == place->id) {
 				// Mark the destiny
-				if (m->goal_dest) {
+				if (MOVEMENT_GOAL_DEST(m)) {
 					if (cdir == -1) b->goal[0].mark = TRUE;
 					else b->goal[1].mark = TRUE;
 				} else {
-					b->places[m->dest].mark = TRUE;
+					b->places[MOVEMENT_DEST(m)].mark = TRUE;
 				}
 			}
 		}
@@ -219,22 +218,22 @@ void place_click(Backgammon *bg, Place *place) {
  * @param prison Target prison
  */
 void prison_click(Backgammon *bg, gint prison) {
-	GList *iter;
-	Movement *m;
+	Movement m;
+	guint i;
 	bg->board->selected = -1;
 
 	// If not prisoners ...
-	if (bg->board->prison[prison] * bg_current_player(bg)->direction <= 0) {
+	if (bg->board->game.prison[prison] * bg_current_player(bg)->direction <= 0) {
 		board_clear_marks(bg->board);
 	} else {
 		// Select the prison
 		bg->board->prison_sel = prison;
 		
 		// Mark all possible movements
-		for (iter = bg->board->movements; iter; iter = iter->next) {
-			m = (Movement *) iter->data;
-			if (m->prison_src) {
-				bg->board->places[m->dest].mark = TRUE;
+		for (i = 0; i < bg->board->movements.count; i ++) {
+			m = bg->board->movements.moves[i];
+			if (MOVEMENT_PRISON_SRC(m)) {
+				bg->board->places[MOVEMENT_DEST(m)].mark = TRUE;
 			}
 		}
 	}
@@ -249,16 +248,16 @@ void prison_click(Backgammon *bg, gint prison) {
  * @param goal Target goal
  */
 void goal_click(Backgammon *bg, Place *goal) {
-	GList *iter;
-	Movement *m;
+	Movement m;
+	guint i;
 
 	// Goal must be marked
 	if (!goal->mark) return ;
 
 	// Find the movements
-	for (iter = bg->board->movements; iter; iter = iter->next) {
-		m = (Movement *) iter->data;
-		if (m->goal_dest) {
+	for (i = 0; i < bg->board->movements.count; i ++) {
+		m = bg->board->movements.moves[i];
+		if (MOVEMENT_GOAL_DEST(m)) {
 			// Clear selections
 			bg->board->prison_sel = -1;
 			bg->board->selected = -1;
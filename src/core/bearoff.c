@@ -0,0 +1,472 @@
+/**
+ * @file bearoff.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/bearoff.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/bearoff.h>
+#include <core/filemap.h>
+#include <core/movegen.h>
+#include <core/zobrist.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Most steps of a position: 15 pieces 6 steps away.
+ */
+#define MAX_PIPS		90
+
+/**
+ * @brief Header of a database file, followed by BEAROFF_POSITIONS entries.
+ *
+ */
+typedef struct bearoff_header_t {
+	char magic[4];
+	uint32_t version, positions, rolls, gammon_rolls;
+} BearoffHeader;
+
+/**
+ * @brief State of the builder. The distributions are kept in floats until
+ * the file is written. Positions are solved by levels of equal steps:
+ * every play lowers the steps, so the positions of a level only need the
+ * lower ones and can be solved in parallel.
+ *
+ */
+typedef struct builder_t {
+	uint8_t (*points)[6];
+	float *mean, *gammon_mean;
+	float (*prob)[BEAROFF_ROLLS];
+	float (*gammon)[BEAROFF_GAMMON_ROLLS];
+
+	unsigned *level;
+	unsigned count;
+	_Atomic unsigned next;
+} Builder;
+
+/**
+ * @brief Binomial coefficients C(n, k) for n <= 20 and k <= 6.
+ */
+static unsigned binomial[21][7];
+
+/**
+ * @brief Database used by the evaluators.
+ */
+static _Atomic(const Bearoff *) current;
+
+/**
+ * @brief Fills the binomial table.
+ */
+__attribute__((constructor))
+static void bearoff_init(void) {
+	int n, k;
+
+	for (n = 0; n <= 20; n ++) {
+		binomial[n][0] = 1;
+		for (k = 1; k <= 6; k ++)
+			binomial[n][k] = n ? binomial[n - 1][k - 1] + binomial[n - 1][k] : 0;
+	}
+}
+
+/**
+ * @brief Index of a distribution of pieces in the database.
+ * Each point j is mapped to the marker j + pieces up to j, which makes six
+ * increasing numbers below 21; they are ranked with the combinatorial
+ * number system.
+ *
+ * @param points pieces on each point, by distance to the goal
+ * (points[0] is 1 step away)
+ * @return unsigned index, below BEAROFF_POSITIONS
+ */
+unsigned bearoff_index(const unsigned points[6]) {
+	unsigned j, sum = 0, index = 0;
+
+	for (j = 0; j < 6; j ++) {
+		sum += points[j];
+		index += binomial[sum + j][j + 1];
+	}
+
+	return index;
+}
+
+/**
+ * @brief Index of the pieces of a player, if they are all in their
+ * territory.
+ *
+ * @param pos the position
+ * @param dir direction of the player
+ * @return int the bearoff_index, -1 if some piece is outside the
+ * territory or in prison
+ */
+int bearoff_side_index(const Position *pos, int dir) {
+	unsigned a[6], i;
+	int count;
+
+	if (pos->outside[SIDE_OF(dir)] || pos->bar[SIDE_OF(dir)]) return -1;
+
+	// Point i is i + 1 steps away from the goal
+	for (i = 0; i < 6; i ++) {
+		count = dir == -1 ? -pos->points[i] : pos->points[23 - i];
+		a[i] = count > 0 ? count : 0;
+	}
+
+	return bearoff_index(a);
+}
+
+/**
+ * @brief Solves one position from the solved positions of lower steps.
+ * The play of each roll minimizes the expected rolls to bear off every
+ * piece; the gammon distribution uses the play that bears off the first
+ * piece soonest.
+ *
+ * @param b the builder
+ * @param index index of the position
+ */
+static void solve(Builder *b, unsigned index) {
+	Play plays[MOVEGEN_MAX_PLAYS];
+	Position pos, next;
+	unsigned a[6], i, n, k, d0, d1, total = 0, best = 0, best_gammon = 0;
+	float w, mean, gammon_mean;
+
+	memset(&pos, 0, sizeof(Position));
+	for (i = 0; i < 6; i ++) {
+		total += b->points[index][i];
+		pos.points[i] = -b->points[index][i];
+		pos.steps[SIDE_OF(-1)] += b->points[index][i] * (i + 1);
+	}
+	pos.off[SIDE_OF(-1)] = 15 - total;
+	pos.turn = -1;
+	pos.hash = zobrist_position(&pos);
+
+	memset(b->prob[index], 0, sizeof(b->prob[index]));
+	memset(b->gammon[index], 0, sizeof(b->gammon[index]));
+	b->mean[index] = 0.0f;
+	b->gammon_mean[index] = 0.0f;
+
+	// A piece is already off: no gammon
+	if (total < 15) b->gammon[index][0] = 1.0f;
+
+	if (!total) {
+		b->prob[index][0] = 1.0f;
+		return;
+	}
+
+	for (d0 = 1; d0 <= 6; d0 ++) {
+		for (d1 = d0; d1 <= 6; d1 ++) {
+			w = d0 == d1 ? 1.0f / 36.0f : 2.0f / 36.0f;
+			n = movegen_plays(&pos, d0, d1, plays);
+
+			mean = gammon_mean = (float) MAX_PIPS;
+			for (i = 0; i < n; i ++) {
+				next = pos;
+				movegen_apply_position(&next, &plays[i]);
+
+				for (k = 0; k < 6; k ++) a[k] = -next.points[k];
+				k = bearoff_index(a);
+
+				if (b->mean[k] < mean) {
+					mean = b->mean[k];
+					best = k;
+				}
+				if (b->gammon_mean[k] < gammon_mean) {
+					gammon_mean = b->gammon_mean[k];
+					best_gammon = k;
+				}
+			}
+
+			// One roll more than the best position reached
+			b->mean[index] += w * (1.0f + mean);
+			for (k = 0; k < BEAROFF_ROLLS - 1; k ++)
+				b->prob[index][k + 1] += w * b->prob[best][k];
+			b->prob[index][BEAROFF_ROLLS - 1] += w * b->prob[best][BEAROFF_ROLLS - 1];
+
+			if (total == 15) {
+				b->gammon_mean[index] += w * (1.0f + gammon_mean);
+				for (k = 0; k < BEAROFF_GAMMON_ROLLS - 1; k ++)
+					b->gammon[index][k + 1] += w * b->gammon[best_gammon][k];
+				b->gammon[index][BEAROFF_GAMMON_ROLLS - 1] +=
+						w * b->gammon[best_gammon][BEAROFF_GAMMON_ROLLS - 1];
+			}
+		}
+	}
+}
+
+/**
+ * @brief Worker thread: solves positions of the current level.
+ *
+ * @param data the builder
+ * @return void* NULL
+ */
+static void *worker(void *data) {
+	Builder *b = (Builder *) data;
+	unsigned i;
+
+	while ((i = atomic_fetch_add(&b->next, 1)) < b->count) solve(b, b->level[i]);
+
+	return NULL;
+}
+
+/**
+ * @brief Writes the solved database to a file.
+ *
+ * @param b the builder
+ * @param path file name
+ * @return bool false on error
+ */
+static bool write_file(const Builder *b, const char *path) {
+	BearoffHeader header;
+	BearoffEntry entry;
+	unsigned i, k;
+	FILE *file;
+	bool ok = true;
+
+	file = fopen(path, "wb");
+	if (!file) return false;
+
+	memcpy(header.magic, BEAROFF_MAGIC, 4);
+	header.version = BEAROFF_VERSION;
+	header.positions = BEAROFF_POSITIONS;
+	header.rolls = BEAROFF_ROLLS;
+	header.gammon_rolls = BEAROFF_GAMMON_ROLLS;
+	ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+	for (i = 0; ok && i < BEAROFF_POSITIONS; i ++) {
+		entry.mean = b->mean[i];
+		for (k = 0; k < BEAROFF_ROLLS; k ++)
+			entry.prob[k] = (uint16_t) (b->prob[i][k] * BEAROFF_ONE + 0.5f);
+		for (k = 0; k < BEAROFF_GAMMON_ROLLS; k ++)
+			entry.gammon[k] = (uint16_t) (b->gammon[i][k] * BEAROFF_ONE + 0.5f);
+		ok = fwrite(&entry, sizeof(entry), 1, file) == 1;
+	}
+
+	if (fclose(file)) ok = false;
+	return ok;
+}
+
+/**
+ * @brief Computes the database and writes it to a file.
+ *
+ * @param path file name
+ * @param threads number of workers (0: one per core)
+ * @return bool false on error
+ */
+bool bearoff_build(const char *path, unsigned threads) {
+	Builder b;
+	pthread_t *tids;
+	unsigned a[6], start[MAX_PIPS + 2], fill[MAX_PIPS + 1];
+	unsigned i, t, started, pips, index;
+	long cores;
+	bool ok = false;
+
+	if (!threads) {
+		cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (unsigned) cores : 1;
+	}
+
+	memset(&b, 0, sizeof(Builder));
+	b.points = malloc(sizeof(*b.points) * BEAROFF_POSITIONS);
+	b.mean = malloc(sizeof(float) * BEAROFF_POSITIONS);
+	b.gammon_mean = malloc(sizeof(float) * BEAROFF_POSITIONS);
+	b.prob = malloc(sizeof(*b.prob) * BEAROFF_POSITIONS);
+	b.gammon = malloc(sizeof(*b.gammon) * BEAROFF_POSITIONS);
+	b.level = malloc(sizeof(unsigned) * BEAROFF_POSITIONS);
+	tids = malloc(sizeof(pthread_t) * threads);
+	if (!b.points || !b.mean || !b.gammon_mean || !b.prob || !b.gammon || !b.level || !tids)
+		goto done;
+
+	// Every distribution, counted by steps
+	memset(start, 0, sizeof(start));
+	for (a[0] = 0; a[0] <= 15; a[0] ++)
+	for (a[1] = 0; a[0] + a[1] <= 15; a[1] ++)
+	for (a[2] = 0; a[0] + a[1] + a[2] <= 15; a[2] ++)
+	for (a[3] = 0; a[0] + a[1] + a[2] + a[3] <= 15; a[3] ++)
+	for (a[4] = 0; a[0] + a[1] + a[2] + a[3] + a[4] <= 15; a[4] ++)
+	for (a[5] = 0; a[0] + a[1] + a[2] + a[3] + a[4] + a[5] <= 15; a[5] ++) {
+		index = bearoff_index(a);
+		for (i = 0, pips = 0; i < 6; i ++) {
+			b.points[index][i] = a[i];
+			pips += a[i] * (i + 1);
+		}
+		start[pips + 1] ++;
+	}
+
+	// Positions sorted by steps: level p is level[start[p]..start[p + 1]]
+	for (pips = 1; pips <= MAX_PIPS + 1; pips ++) start[pips] += start[pips - 1];
+	memcpy(fill, start, sizeof(fill));
+	for (index = 0; index < BEAROFF_POSITIONS; index ++) {
+		for (i = 0, pips = 0; i < 6; i ++) pips += b.points[index][i] * (i + 1);
+		b.level[fill[pips] ++] = index;
+	}
+
+	for (pips = 0; pips <= MAX_PIPS; pips ++) {
+		b.count = start[pips + 1];
+		atomic_store(&b.next, start[pips]);
+
+		for (started = 0; started < threads; started ++)
+			if (pthread_create(&tids[started], NULL, worker, &b)) break;
+
+		// Without threads, the level is solved here
+		if (!started) worker(&b);
+		for (t = 0; t < started; t ++) pthread_join(tids[t], NULL);
+	}
+
+	ok = write_file(&b, path);
+
+done:
+	free(b.points);
+	free(b.mean);
+	free(b.gammon_mean);
+	free(b.prob);
+	free(b.gammon);
+	free(b.level);
+	free(tids);
+	return ok;
+}
+
+/**
+ * @brief Maps a database file into memory.
+ *
+ * @param path file name
+ * @return Bearoff* the database, NULL if the file is missing or invalid
+ */
+Bearoff *bearoff_open(const char *path) {
+	const BearoffHeader *header;
+	Bearoff *db;
+	size_t size;
+	void *map;
+
+	map = filemap_open(path, &size);
+	if (!map) return NULL;
+
+	header = (const BearoffHeader *) map;
+	db = malloc(sizeof(Bearoff));
+	if (!db || size != sizeof(BearoffHeader) + sizeof(BearoffEntry) * BEAROFF_POSITIONS
+			|| memcmp(header->magic, BEAROFF_MAGIC, 4) || header->version != BEAROFF_VERSION
+			|| header->positions != BEAROFF_POSITIONS || header->rolls != BEAROFF_ROLLS
+			|| header->gammon_rolls != BEAROFF_GAMMON_ROLLS) {
+		free(db);
+		filemap_close(map, size);
+		return NULL;
+	}
+
+	db->map = map;
+	db->size = size;
+	db->entries = (const BearoffEntry *) ((const char *) map + sizeof(BearoffHeader));
+
+	return db;
+}
+
+/**
+ * @brief Unmaps a database.
+ *
+ * @param db the database
+ */
+void bearoff_close(Bearoff *db) {
+	if (!db) return;
+
+	filemap_close(db->map, db->size);
+	free(db);
+}
+
+/**
+ * @brief Entry of the pieces of a player, if they are all in their
+ * territory.
+ *
+ * @param db the database
+ * @param pos the position
+ * @param dir direction of the player
+ * @return const BearoffEntry* the entry, NULL if some piece is outside
+ * the territory or in prison
+ */
+const BearoffEntry *bearoff_entry(const Bearoff *db, const Position *pos, int dir) {
+	int index = bearoff_side_index(pos, dir);
+
+	return index < 0 ? NULL : &db->entries[index];
+}
+
+/**
+ * @brief Exact evaluation of a position where both players are bearing off.
+ * The player to move finishes first when they need no more rolls than
+ * the opponent.
+ *
+ * @param db the database, may be NULL
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ * @return bool false if the position is not in the database
+ */
+bool bearoff_evaluate(const Bearoff *db, const Position *pos, Eval *ev) {
+	const BearoffEntry *me, *opp;
+	float rest[BEAROFF_ROLLS + 1], first[BEAROFF_GAMMON_ROLLS + 1];
+	float win = 0.0f, win_gammon = 0.0f, lose_gammon = 0.0f;
+	int n, side = SIDE_OF(pos->turn);
+
+	if (!db) return false;
+
+	me = bearoff_entry(db, pos, pos->turn);
+	if (!me) return false;
+	opp = bearoff_entry(db, pos, -pos->turn);
+	if (!opp) return false;
+
+	if (position_winner(pos)) {
+		eval_terminal(pos, ev);
+		return true;
+	}
+
+	// rest[n]: the opponent needs n rolls or more
+	rest[BEAROFF_ROLLS] = 0.0f;
+	for (n = BEAROFF_ROLLS - 1; n >= 0; n --) rest[n] = rest[n + 1] + opp->prob[n];
+
+	for (n = 1; n < BEAROFF_ROLLS; n ++) win += me->prob[n] * rest[n];
+	win /= (float) BEAROFF_ONE * BEAROFF_ONE;
+
+	// The opponent has not borne off any piece after n - 1 rolls
+	if (!pos->off[!side]) {
+		first[BEAROFF_GAMMON_ROLLS] = 0.0f;
+		for (n = BEAROFF_GAMMON_ROLLS - 1; n >= 0; n --) first[n] = first[n + 1] + opp->gammon[n];
+		for (n = 1; n < BEAROFF_GAMMON_ROLLS; n ++) win_gammon += me->prob[n] * first[n];
+		win_gammon /= (float) BEAROFF_ONE * BEAROFF_ONE;
+	}
+
+	// The player to move has not borne off any piece after n rolls
+	if (!pos->off[side]) {
+		first[BEAROFF_GAMMON_ROLLS] = 0.0f;
+		for (n = BEAROFF_GAMMON_ROLLS - 1; n >= 0; n --) first[n] = first[n + 1] + me->gammon[n];
+		for (n = 1; n < BEAROFF_GAMMON_ROLLS - 1; n ++) lose_gammon += opp->prob[n] * first[n + 1];
+		lose_gammon /= (float) BEAROFF_ONE * BEAROFF_ONE;
+	}
+
+	if (win > 1.0f) win = 1.0f;
+	ev->out[EVAL_WIN] = win;
+	ev->out[EVAL_WIN_GAMMON] = win_gammon < win ? win_gammon : win;
+	ev->out[EVAL_WIN_BACKGAMMON] = 0.0f;
+	ev->out[EVAL_LOSE_GAMMON] = lose_gammon < 1.0f - win ? lose_gammon : 1.0f - win;
+	ev->out[EVAL_LOSE_BACKGAMMON] = 0.0f;
+
+	return true;
+}
+
+/**
+ * @brief Sets the database used by the evaluators. It must not be closed
+ * while searches use it.
+ *
+ * @param db the database, NULL for none
+ */
+void bearoff_set_current(const Bearoff *db) {
+	atomic_store(&current, db);
+}
+
+/**
+ * @brief Database used by the evaluators.
+ *
+ * @return const Bearoff* the database, NULL for none
+ */
+const Bearoff *bearoff_current(void) {
+	return atomic_load_explicit(&current, memory_order_acquire);
+}
@@ -0,0 +1,588 @@
+/**
+ * @file bearoff2.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/bearoff2.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/bearoff2.h>
+#include <core/bearoff.h>
+#include <core/filemap.h>
+#include <core/movegen.h>
+#include <core/zobrist.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Most steps of both sides together: 6 pieces 6 steps away each.
+ */
+#define MAX_PIPS		(2 * 6 * BEAROFF2_PIECES)
+
+/**
+ * @brief Rolls of two dice, doubles once.
+ */
+#define ROLLS			21
+
+/**
+ * @brief Most bytes of a compressed block: the first value, the Rice
+ * parameter and BEAROFF2_BLOCK - 1 codes of at most 16 + 1 + 16 bits.
+ */
+#define MAX_BLOCK_BYTES	(3 + (BEAROFF2_BLOCK - 1) * 33 / 8 + 1)
+
+/**
+ * @brief Header of a database file, followed by the ranks of the sides
+ * (BEAROFF2_SIDE), the block index (BEAROFF2_BLOCKS + 1 offsets), the
+ * compressed data and 8 bytes of padding, so lookups can always read
+ * 64 bits at once.
+ *
+ */
+typedef struct bearoff2_header_t {
+	char magic[4];
+	uint32_t version, pieces, positions, block, blocks;
+} Bearoff2Header;
+
+/**
+ * @brief State of the builder. The positions a side reaches with each roll
+ * are found once; then positions are solved by levels of total steps,
+ * since every play lowers them.
+ *
+ */
+typedef struct builder2_t {
+	unsigned pips[BEAROFF2_SIDE];
+	uint16_t rank[BEAROFF2_SIDE];
+	float weight[ROLLS];
+	unsigned first[BEAROFF2_SIDE][ROLLS + 1];
+	uint16_t *next;
+	float *win;
+
+	unsigned *level;
+	unsigned count;
+	_Atomic unsigned cursor;
+} Builder2;
+
+/**
+ * @brief A side and its expected rolls to bear off, to rank the sides.
+ *
+ */
+typedef struct side_rank_t {
+	float mean;
+	unsigned side;
+} SideRank;
+
+/**
+ * @brief Writes bits into a buffer, least significant bit first.
+ *
+ */
+typedef struct bit_writer_t {
+	uint8_t *out;
+	unsigned bits;
+} BitWriter;
+
+/**
+ * @brief Database used by the evaluators.
+ */
+static _Atomic(const Bearoff2 *) current;
+
+/**
+ * @brief Finds the distinct positions reached by a side with every roll.
+ * The positions of the roll r of side s are next[first[s][r]..first[s][r + 1]].
+ *
+ * @param b the builder
+ * @return bool false if out of memory
+ */
+static bool find_successors(Builder2 *b) {
+	Play plays[MOVEGEN_MAX_PLAYS];
+	Position pos, after;
+	unsigned a[6], c[6], i, j, k, n, s, r, d0, d1, total, count = 0, capacity = 0;
+	uint16_t *grown, reached;
+
+	for (a[0] = 0; a[0] <= BEAROFF2_PIECES; a[0] ++)
+	for (a[1] = 0; a[0] + a[1] <= BEAROFF2_PIECES; a[1] ++)
+	for (a[2] = 0; a[0] + a[1] + a[2] <= BEAROFF2_PIECES; a[2] ++)
+	for (a[3] = 0; a[0] + a[1] + a[2] + a[3] <= BEAROFF2_PIECES; a[3] ++)
+	for (a[4] = 0; a[0] + a[1] + a[2] + a[3] + a[4] <= BEAROFF2_PIECES; a[4] ++)
+	for (a[5] = 0; a[0] + a[1] + a[2] + a[3] + a[4] + a[5] <= BEAROFF2_PIECES; a[5] ++) {
+		s = bearoff_index(a);
+
+		memset(&pos, 0, sizeof(Position));
+		for (i = 0, total = 0; i < 6; i ++) {
+			total += a[i];
+			pos.points[i] = -a[i];
+			pos.steps[SIDE_OF(-1)] += a[i] * (i + 1);
+		}
+		pos.off[SIDE_OF(-1)] = 15 - total;
+		pos.turn = -1;
+		pos.hash = zobrist_position(&pos);
+		b->pips[s] = pos.steps[SIDE_OF(-1)];
+
+		r = 0;
+		for (d0 = 1; d0 <= 6; d0 ++) {
+			for (d1 = d0; d1 <= 6; d1 ++, r ++) {
+				b->weight[r] = d0 == d1 ? 1.0f / 36.0f : 2.0f / 36.0f;
+				b->first[s][r] = count;
+				if (!total) continue;
+
+				n = movegen_plays(&pos, d0, d1, plays);
+				for (i = 0; i < n; i ++) {
+					after = pos;
+					movegen_apply_position(&after, &plays[i]);
+					for (k = 0; k < 6; k ++) c[k] = -after.points[k];
+					reached = bearoff_index(c);
+
+					// Different plays often reach the same position
+					for (j = b->first[s][r]; j < count && b->next[j] != reached; j ++);
+					if (j < count) continue;
+
+					if (count == capacity) {
+						capacity = capacity ? capacity * 2 : 4096;
+						grown = realloc(b->next, sizeof(uint16_t) * capacity);
+						if (!grown) return false;
+						b->next = grown;
+					}
+					b->next[count ++] = reached;
+				}
+			}
+		}
+		b->first[s][r] = count;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Solves one position: for every roll, the best play leaves the
+ * opponent with the lowest win chance.
+ *
+ * @param b the builder
+ * @param index me * BEAROFF2_SIDE + opp
+ */
+static void solve(Builder2 *b, unsigned index) {
+	unsigned me = index / BEAROFF2_SIDE, opp = index % BEAROFF2_SIDE;
+	unsigned r, j, s;
+	float win = 0.0f, best, w;
+
+	// A side without pieces left has already won
+	if (!me || !opp) {
+		b->win[index] = me ? 0.0f : 1.0f;
+		return;
+	}
+
+	for (r = 0; r < ROLLS; r ++) {
+		best = 0.0f;
+		for (j = b->first[me][r]; j < b->first[me][r + 1]; j ++) {
+			s = b->next[j];
+			w = s ? 1.0f - b->win[opp * BEAROFF2_SIDE + s] : 1.0f;
+			if (w > best) best = w;
+		}
+		win += b->weight[r] * best;
+	}
+
+	b->win[index] = win;
+}
+
+/**
+ * @brief Worker thread: solves positions of the current level.
+ *
+ * @param data the builder
+ * @return void* NULL
+ */
+static void *worker(void *data) {
+	Builder2 *b = (Builder2 *) data;
+	unsigned i;
+
+	while ((i = atomic_fetch_add(&b->cursor, 1)) < b->count) solve(b, b->level[i]);
+
+	return NULL;
+}
+
+/**
+ * @brief Compares two sides by expected rolls, then by index.
+ *
+ * @param a first SideRank
+ * @param b second SideRank
+ * @return int order for qsort
+ */
+static int compare_sides(const void *a, const void *b) {
+	const SideRank *x = (const SideRank *) a, *y = (const SideRank *) b;
+
+	if (x->mean != y->mean) return x->mean < y->mean ? -1 : 1;
+	return x->side < y->side ? -1 : 1;
+}
+
+/**
+ * @brief Ranks the sides by expected rolls to bear off. Stored in this
+ * order, neighbouring values are close, which makes the differences small.
+ *
+ * @param b the builder
+ */
+static void rank_sides(Builder2 *b) {
+	SideRank sides[BEAROFF2_SIDE];
+	unsigned i, j, r, s, pips;
+	float best;
+
+	// Every play lowers the steps: solve by increasing steps
+	for (pips = 0; pips <= MAX_PIPS / 2; pips ++) {
+		for (s = 0; s < BEAROFF2_SIDE; s ++) {
+			if (b->pips[s] != pips) continue;
+
+			sides[s].side = s;
+			sides[s].mean = 0.0f;
+			if (!s) continue;
+
+			for (r = 0; r < ROLLS; r ++) {
+				best = (float) MAX_PIPS;
+				for (j = b->first[s][r]; j < b->first[s][r + 1]; j ++)
+					if (sides[b->next[j]].mean < best) best = sides[b->next[j]].mean;
+				sides[s].mean += b->weight[r] * (1.0f + best);
+			}
+		}
+	}
+
+	qsort(sides, BEAROFF2_SIDE, sizeof(SideRank), compare_sides);
+	for (i = 0; i < BEAROFF2_SIDE; i ++) b->rank[sides[i].side] = i;
+}
+
+/**
+ * @brief Appends bits to a buffer.
+ *
+ * @param w the writer
+ * @param value the bits
+ * @param count number of bits
+ */
+static void put_bits(BitWriter *w, uint32_t value, unsigned count) {
+	unsigned i;
+
+	for (i = 0; i < count; i ++, w->bits ++) {
+		if (!(w->bits & 7)) w->out[w->bits >> 3] = 0;
+		w->out[w->bits >> 3] |= ((value >> i) & 1) << (w->bits & 7);
+	}
+}
+
+/**
+ * @brief Zigzag code of a difference: small magnitudes give small codes.
+ *
+ * @param delta the difference
+ * @return uint32_t the code
+ */
+static uint32_t zigzag(int delta) {
+	return delta < 0 ? ((uint32_t) -delta << 1) - 1 : (uint32_t) delta << 1;
+}
+
+/**
+ * @brief Compresses one block: the first value, then the differences
+ * between consecutive values as Rice codes (quotient in unary, k low bits),
+ * with the k that makes the block shortest.
+ *
+ * @param values values of the block
+ * @param count number of values
+ * @param out output buffer of MAX_BLOCK_BYTES
+ * @return unsigned bytes written
+ */
+static unsigned compress_block(const uint16_t values[], unsigned count, uint8_t *out) {
+	BitWriter w = {out, 0};
+	unsigned i, k, best_k = 0, size, best_size = ~0u;
+	uint32_t z;
+
+	for (k = 0; k <= 16; k ++) {
+		for (i = 1, size = 0; i < count; i ++)
+			size += (zigzag(values[i] - values[i - 1]) >> k) + 1 + k;
+		if (size < best_size) {
+			best_size = size;
+			best_k = k;
+		}
+	}
+
+	put_bits(&w, values[0], 16);
+	put_bits(&w, best_k, 8);
+
+	for (i = 1; i < count; i ++) {
+		z = zigzag(values[i] - values[i - 1]);
+		for (k = z >> best_k; k; k --) put_bits(&w, 0, 1);
+		put_bits(&w, 1, 1);
+		put_bits(&w, z, best_k);
+	}
+
+	return (w.bits + 7) >> 3;
+}
+
+/**
+ * @brief Compresses the solved database and writes it to a file.
+ *
+ * @param b the builder
+ * @param path file name
+ * @return bool false on error
+ */
+static bool write_file(const Builder2 *b, const char *path) {
+	Bearoff2Header header;
+	uint16_t values[BEAROFF2_BLOCK], side[BEAROFF2_SIDE];
+	uint8_t padding[8] = {0};
+	uint32_t *blocks;
+	uint8_t *data;
+	unsigned i, n, me, opp, block, size = 0;
+	FILE *file;
+	bool ok;
+
+	blocks = malloc(sizeof(uint32_t) * (BEAROFF2_BLOCKS + 1));
+	data = malloc((size_t) BEAROFF2_BLOCKS * MAX_BLOCK_BYTES);
+	if (!blocks || !data) {
+		free(blocks);
+		free(data);
+		return false;
+	}
+
+	// Stored position i is the pair of sides ranked i / SIDE and i % SIDE
+	for (i = 0; i < BEAROFF2_SIDE; i ++) side[b->rank[i]] = i;
+
+	for (block = 0; block < BEAROFF2_BLOCKS; block ++) {
+		for (n = 0, i = block * BEAROFF2_BLOCK; n < BEAROFF2_BLOCK && i < BEAROFF2_POSITIONS; n ++, i ++) {
+			me = side[i / BEAROFF2_SIDE];
+			opp = side[i % BEAROFF2_SIDE];
+			values[n] = (uint16_t) (b->win[me * BEAROFF2_SIDE + opp] * BEAROFF2_ONE + 0.5f);
+		}
+
+		blocks[block] = size;
+		size += compress_block(values, n, data + size);
+	}
+	blocks[BEAROFF2_BLOCKS] = size;
+
+	memcpy(header.magic, BEAROFF2_MAGIC, 4);
+	header.version = BEAROFF2_VERSION;
+	header.pieces = BEAROFF2_PIECES;
+	header.positions = BEAROFF2_POSITIONS;
+	header.block = BEAROFF2_BLOCK;
+	header.blocks = BEAROFF2_BLOCKS;
+
+	file = fopen(path, "wb");
+	ok = file
+		&& fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(b->rank, sizeof(uint16_t), BEAROFF2_SIDE, file) == BEAROFF2_SIDE
+		&& fwrite(blocks, sizeof(uint32_t), BEAROFF2_BLOCKS + 1, file) == BEAROFF2_BLOCKS + 1
+		&& fwrite(data, 1, size, file) == size
+		&& fwrite(padding, 1, sizeof(padding), file) == sizeof(padding);
+	if (file && fclose(file)) ok = false;
+
+	free(blocks);
+	free(data);
+	return ok;
+}
+
+/**
+ * @brief Computes the database by retrograde analysis and writes it
+ * to a file.
+ *
+ * @param path file name
+ * @param threads number of workers (0: one per core)
+ * @return bool false on error
+ */
+bool bearoff2_build(const char *path, unsigned threads) {
+	Builder2 *b;
+	pthread_t *tids;
+	unsigned start[MAX_PIPS + 2], fill[MAX_PIPS + 1];
+	unsigned i, t, started, pips;
+	long cores;
+	bool ok = false;
+
+	if (!threads) {
+		cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (unsigned) cores : 1;
+	}
+
+	b = calloc(1, sizeof(Builder2));
+	tids = malloc(sizeof(pthread_t) * threads);
+	if (!b || !tids) goto done;
+
+	b->win = malloc(sizeof(float) * BEAROFF2_POSITIONS);
+	b->level = malloc(sizeof(unsigned) * BEAROFF2_POSITIONS);
+	if (!b->win || !b->level || !find_successors(b)) goto done;
+	rank_sides(b);
+
+	// Positions sorted by the steps of both sides
+	memset(start, 0, sizeof(start));
+	for (i = 0; i < BEAROFF2_POSITIONS; i ++)
+		start[b->pips[i / BEAROFF2_SIDE] + b->pips[i % BEAROFF2_SIDE] + 1] ++;
+	for (pips = 1; pips <= MAX_PIPS + 1; pips ++) start[pips] += start[pips - 1];
+	memcpy(fill, start, sizeof(fill));
+	for (i = 0; i < BEAROFF2_POSITIONS; i ++)
+		b->level[fill[b->pips[i / BEAROFF2_SIDE] + b->pips[i % BEAROFF2_SIDE]] ++] = i;
+
+	for (pips = 0; pips <= MAX_PIPS; pips ++) {
+		b->count = start[pips + 1];
+		atomic_store(&b->cursor, start[pips]);
+
+		for (started = 0; started < threads; started ++)
+			if (pthread_create(&tids[started], NULL, worker, b)) break;
+
+		// Without threads, the level is solved here
+		if (!started) worker(b);
+		for (t = 0; t < started; t ++) pthread_join(tids[t], NULL);
+	}
+
+	ok = write_file(b, path);
+
+done:
+	if (b) {
+		free(b->next);
+		free(b->win);
+		free(b->level);
+	}
+	free(b);
+	free(tids);
+	return ok;
+}
+
+/**
+ * @brief Maps a database file into memory.
+ *
+ * @param path file name
+ * @return Bearoff2* the database, NULL if the file is missing or invalid
+ */
+Bearoff2 *bearoff2_open(const char *path) {
+	const Bearoff2Header *header;
+	Bearoff2 *db;
+	size_t data, size;
+	void *map;
+
+	map = filemap_open(path, &size);
+	if (!map) return NULL;
+
+	data = sizeof(Bearoff2Header) + sizeof(uint16_t) * BEAROFF2_SIDE
+		+ sizeof(uint32_t) * (BEAROFF2_BLOCKS + 1);
+	header = (const Bearoff2Header *) map;
+	db = malloc(sizeof(Bearoff2));
+	if (!db || size < data || memcmp(header->magic, BEAROFF2_MAGIC, 4) || header->version != BEAROFF2_VERSION
+			|| header->pieces != BEAROFF2_PIECES || header->positions != BEAROFF2_POSITIONS
+			|| header->block != BEAROFF2_BLOCK || header->blocks != BEAROFF2_BLOCKS) {
+		free(db);
+		filemap_close(map, size);
+		return NULL;
+	}
+
+	db->map = map;
+	db->size = size;
+	db->rank = (const uint16_t *) ((const char *) map + sizeof(Bearoff2Header));
+	db->blocks = (const uint32_t *) (db->rank + BEAROFF2_SIDE);
+	db->data = (const uint8_t *) map + data;
+
+	// The index must stay inside the file, before the padding read by lookups
+	if (db->blocks[BEAROFF2_BLOCKS] + 8 > size - data) {
+		bearoff2_close(db);
+		return NULL;
+	}
+
+	return db;
+}
+
+/**
+ * @brief Unmaps a database.
+ *
+ * @param db the database
+ */
+void bearoff2_close(Bearoff2 *db) {
+	if (!db) return;
+
+	filemap_close(db->map, db->size);
+	free(db);
+}
+
+/**
+ * @brief Win chance of the player to move.
+ *
+ * @param db the database
+ * @param me bearoff_index of the pieces of the player to move
+ * @param opp bearoff_index of the pieces of the opponent
+ * @return float the win chance
+ */
+float bearoff2_lookup(const Bearoff2 *db, unsigned me, unsigned opp) {
+	unsigned index = db->rank[me] * BEAROFF2_SIDE + db->rank[opp];
+	unsigned n = index % BEAROFF2_BLOCK, bit = 0, q, k;
+	const uint8_t *p = db->data + db->blocks[index / BEAROFF2_BLOCK];
+	uint64_t window;
+	uint32_t z, value;
+
+	// First value, then add the differences up to the position
+	value = p[0] | p[1] << 8;
+	k = p[2];
+	p += 3;
+
+	for (; n; n --) {
+		// The next 57 bits or more, from the padded data
+		window = filemap_le64(p + (bit >> 3)) >> (bit & 7);
+
+		// Unary quotient: zeros up to the first one
+		q = window ? __builtin_ctzll(window) : 57;
+		if (q + 1 + k > 57) {
+			// Long code: quotient bit by bit
+			for (q = 0; !((p[bit >> 3] >> (bit & 7)) & 1); bit ++) q ++;
+			bit ++;
+			window = filemap_le64(p + (bit >> 3)) >> (bit & 7);
+			z = (uint32_t) (window & ((1u << k) - 1)) | q << k;
+			bit += k;
+		} else {
+			z = (uint32_t) ((window >> (q + 1)) & ((1u << k) - 1)) | q << k;
+			bit += q + 1 + k;
+		}
+
+		value += z & 1 ? -((z + 1) >> 1) : z >> 1;
+	}
+
+	return (float) (value & 0xFFFF) / BEAROFF2_ONE;
+}
+
+/**
+ * @brief Exact evaluation of a bearoff with few pieces on both sides.
+ * With so few pieces left both players have borne off, so there are
+ * no gammons.
+ *
+ * @param db the database, may be NULL
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ * @return bool false if the position is not in the database
+ */
+bool bearoff2_evaluate(const Bearoff2 *db, const Position *pos, Eval *ev) {
+	int me, opp;
+
+	if (!db) return false;
+
+	if (pos->off[SIDE_OF(pos->turn)] < 15 - BEAROFF2_PIECES
+			|| pos->off[SIDE_OF(-pos->turn)] < 15 - BEAROFF2_PIECES) return false;
+
+	me = bearoff_side_index(pos, pos->turn);
+	opp = bearoff_side_index(pos, -pos->turn);
+	if (me < 0 || opp < 0) return false;
+
+	if (position_winner(pos)) {
+		eval_terminal(pos, ev);
+		return true;
+	}
+
+	memset(ev, 0, sizeof(Eval));
+	ev->out[EVAL_WIN] = bearoff2_lookup(db, me, opp);
+
+	return true;
+}
+
+/**
+ * @brief Sets the database used by the evaluators. It must not be closed
+ * while searches use it.
+ *
+ * @param db the database, NULL for none
+ */
+void bearoff2_set_current(const Bearoff2 *db) {
+	atomic_store(&current, db);
+}
+
+/**
+ * @brief Database used by the evaluators.
+ *
+ * @return const Bearoff2* the database, NULL for none
+ */
+const Bearoff2 *bearoff2_current(void) {
+	return atomic_load_explicit(&current, memory_order_acquire);
+}
@@ -0,0 +1,552 @@
+/**
+ * @file book.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/book.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/book.h>
+#include <core/cache.h>
+#include <core/search.h>
+#include <core/zobrist.h>
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Evaluation cache of the searches that rank the candidates.
+ */
+#define BUILD_CACHE_SIZE	(16 * 1024 * 1024)
+
+/**
+ * @brief Header of a book file, followed by the entries.
+ *
+ */
+typedef struct book_header_t {
+	char magic[4];
+	uint32_t version;
+	uint32_t count;
+	uint32_t entry_size;
+} BookHeader;
+
+/**
+ * @brief A rolled out position, by the key of its orientation with
+ * direction -1 to move.
+ *
+ */
+typedef struct book_memo_t {
+	uint64_t key;
+	Eval eval;
+} BookMemo;
+
+/**
+ * @brief State of the builder: the entries so far and the rollouts done,
+ * which serve both orientations of the board.
+ *
+ */
+typedef struct book_builder_t {
+	const BookOptions *opts;
+	SearchOptions search;
+	unsigned candidates;
+
+	BookEntry *entries;
+	unsigned count, capacity;
+
+	BookMemo *memo;
+	unsigned memo_count, memo_capacity;
+
+	unsigned done, total;
+} BookBuilder;
+
+/**
+ * @brief Book used by the searches of the AI.
+ */
+static _Atomic(const Book *) current;
+
+/**
+ * @brief Key of a roll, mixed into the key of the position. The order
+ * of the dice does not matter.
+ *
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @return uint64_t the key
+ */
+static uint64_t dice_key(unsigned d0, unsigned d1) {
+	uint64_t key = d0 > d1 ? d0 * 8 + d1 : d1 * 8 + d0;
+
+	// splitmix64 finalizer of the roll
+	key += 0x9e3779b97f4a7c15ULL;
+	key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+
+	return key ^ (key >> 31);
+}
+
+/**
+ * @brief Mirrors a position: the players swap their pieces and the turn.
+ * The player to move keeps the same chances.
+ *
+ * @param pos the position
+ * @param out output mirrored position
+ */
+static void mirror(const Position *pos, Position *out) {
+	unsigned i;
+
+	*out = *pos;
+	for (i = 0; i < 24; i ++) out->points[i] = -pos->points[23 - i];
+	for (i = 0; i < 2; i ++) {
+		out->bar[i] = pos->bar[1 - i];
+		out->off[i] = pos->off[1 - i];
+		out->outside[i] = pos->outside[1 - i];
+		out->steps[i] = pos->steps[1 - i];
+	}
+	out->turn = -pos->turn;
+	out->hash = zobrist_position(out);
+}
+
+/**
+ * @brief Key of a position in the rollouts done: its orientation with
+ * direction -1 to move.
+ *
+ * @param pos the position
+ * @return uint64_t the key
+ */
+static uint64_t memo_key(const Position *pos) {
+	Position m;
+
+	if (pos->turn == -1) return pos->hash;
+
+	mirror(pos, &m);
+	return m.hash;
+}
+
+/**
+ * @brief Looks for a position in the rollouts done.
+ *
+ * @param b the builder
+ * @param key memo_key of the position
+ * @return BookMemo* the rollout, NULL if not done
+ */
+static BookMemo *memo_find(BookBuilder *b, uint64_t key) {
+	unsigned i;
+
+	for (i = 0; i < b->memo_count; i ++)
+		if (b->memo[i].key == key) return &b->memo[i];
+
+	return NULL;
+}
+
+/**
+ * @brief Appends an entry to the book.
+ *
+ * @param b the builder
+ * @param key key of the entry
+ * @param ev evaluation
+ * @param play the play, NULL for the evaluation of a position
+ * @return bool false if out of memory
+ */
+static bool add_entry(BookBuilder *b, uint64_t key, const Eval *ev, const Play *play) {
+	BookEntry *grown, *e;
+	unsigned i;
+
+	if (b->count == b->capacity) {
+		b->capacity = b->capacity ? b->capacity * 2 : 1024;
+		grown = realloc(b->entries, sizeof(BookEntry) * b->capacity);
+		if (!grown) return false;
+		b->entries = grown;
+	}
+
+	e = &b->entries[b->count ++];
+	memset(e, 0, sizeof(BookEntry));
+	e->key = key;
+	for (i = 0; i < EVAL_OUTPUTS; i ++)
+		e->out[i] = (uint16_t) (ev->out[i] * BOOK_ONE + 0.5f);
+
+	if (play) {
+		e->count = play->count;
+		for (i = 0; i < play->count; i ++) e->moves[i] = play->moves[i];
+	} else e->count = BOOK_POSITION;
+
+	return true;
+}
+
+/**
+ * @brief Rolls out positions before the roll, or takes their results
+ * from the rollouts done.
+ *
+ * @param b the builder
+ * @param positions the positions
+ * @param count number of positions
+ * @param evals output evaluations, from the point of view of the player
+ * to move of each position
+ * @return bool false on error
+ */
+static bool roll_out(BookBuilder *b, const Position positions[], unsigned count, Eval evals[]) {
+	Position todo[BOOK_MAX_CANDIDATES + 1];
+	RolloutResult results[BOOK_MAX_CANDIDATES + 1];
+	uint64_t keys[BOOK_MAX_CANDIDATES + 1];
+	BookMemo *grown, *memo;
+	unsigned i, j, n = 0;
+
+	for (i = 0; i < count; i ++) {
+		keys[i] = memo_key(&positions[i]);
+		if (memo_find(b, keys[i])) continue;
+
+		for (j = 0; j < n && memo_key(&todo[j]) != keys[i]; j ++);
+		if (j == n) todo[n ++] = positions[i];
+	}
+
+	if (n) {
+		if (!rollout_run(todo, n, &b->opts->rollout, results)) return false;
+
+		if (b->memo_count + n > b->memo_capacity) {
+			b->memo_capacity = b->memo_capacity ? b->memo_capacity * 2 : 1024;
+			grown = realloc(b->memo, sizeof(BookMemo) * b->memo_capacity);
+			if (!grown) return false;
+			b->memo = grown;
+		}
+
+		for (j = 0; j < n; j ++) {
+			b->memo[b->memo_count].key = memo_key(&todo[j]);
+			b->memo[b->memo_count ++].eval = results[j].eval;
+		}
+	}
+
+	for (i = 0; i < count; i ++) {
+		memo = memo_find(b, keys[i]);
+		evals[i] = memo->eval;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Adds a roll to the book: its best candidates, rolled out, and
+ * the positions they leave before the roll of the opponent.
+ *
+ * @param b the builder
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param after output positions after the candidates, may be NULL
+ * @param count output number of candidates, may be NULL
+ * @return bool false on error
+ */
+static bool add_roll(BookBuilder *b, const Position *pos, unsigned d0, unsigned d1,
+		Position after[], unsigned *count) {
+	Play plays[BOOK_MAX_CANDIDATES];
+	Eval evals[BOOK_MAX_CANDIDATES];
+	Position next[BOOK_MAX_CANDIDATES];
+	unsigned i, n;
+	Eval ev;
+
+	n = search_rank_plays(pos, d0, d1, &b->search, plays, evals, b->candidates);
+
+	for (i = 0; i < n; i ++) {
+		next[i] = *pos;
+		movegen_apply_position(&next[i], &plays[i]);
+		position_switch_turn(&next[i]);
+	}
+
+	if (!roll_out(b, next, n, evals)) return false;
+
+	for (i = 0; i < n; i ++) {
+		ev = evals[i];
+		eval_invert(&ev);
+
+		if (!add_entry(b, pos->hash ^ dice_key(d0, d1), &ev, &plays[i])
+				|| !add_entry(b, next[i].hash, &evals[i], NULL)) return false;
+		if (after) after[i] = next[i];
+	}
+	if (count) *count = n;
+
+	if (b->opts->progress) b->opts->progress(++ b->done, b->total);
+
+	return true;
+}
+
+/**
+ * @brief Orders entries by key, then by play, so that repeated entries
+ * are together.
+ *
+ * @param a first BookEntry
+ * @param b second BookEntry
+ * @return int order for qsort
+ */
+static int compare_entries(const void *a, const void *b) {
+	const BookEntry *x = (const BookEntry *) a, *y = (const BookEntry *) b;
+
+	if (x->key != y->key) return x->key < y->key ? -1 : 1;
+	if (x->count != y->count) return x->count < y->count ? -1 : 1;
+
+	return memcmp(x->moves, y->moves, sizeof(x->moves));
+}
+
+/**
+ * @brief Sorts the entries and writes them to a file. Positions and rolls
+ * reached in more than one way are written once.
+ *
+ * @param b the builder
+ * @param path file name
+ * @return bool false on error
+ */
+static bool write_book(BookBuilder *b, const char *path) {
+	BookHeader header;
+	unsigned i, n = 0;
+	FILE *file;
+	bool ok;
+
+	qsort(b->entries, b->count, sizeof(BookEntry), compare_entries);
+	for (i = 0; i < b->count; i ++)
+		if (!n || compare_entries(&b->entries[n - 1], &b->entries[i]))
+			b->entries[n ++] = b->entries[i];
+
+	memcpy(header.magic, BOOK_MAGIC, 4);
+	header.version = BOOK_VERSION;
+	header.count = n;
+	header.entry_size = sizeof(BookEntry);
+
+	file = fopen(path, "wb");
+	ok = file
+		&& fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(b->entries, sizeof(BookEntry), n, file) == n;
+	if (file && fclose(file)) ok = false;
+
+	return ok;
+}
+
+/**
+ * @brief Default settings: the rollout defaults, 4 candidates ranked
+ * with a 2-ply search, no progress report.
+ *
+ * @param opts output settings
+ */
+void book_options_init(BookOptions *opts) {
+	rollout_options_init(&opts->rollout);
+	opts->candidates = 4;
+	opts->depth = 2;
+	opts->progress = NULL;
+}
+
+/**
+ * @brief Builds the book and writes it to a file. It holds every roll
+ * of the starting position, with either player to move, and every
+ * roll of the replies to the candidates of the first roll.
+ *
+ * @param path file name
+ * @param opts settings
+ * @return bool false on error
+ */
+bool book_build(const char *path, const BookOptions *opts) {
+	BookBuilder b;
+	Position start, first[BOOK_MAX_CANDIDATES];
+	Game game;
+	Eval ev;
+	unsigned d0, d1, e0, e1, i, n;
+	int turn;
+	bool ok = false;
+
+	memset(&b, 0, sizeof(BookBuilder));
+	b.opts = opts;
+
+	b.candidates = opts->candidates;
+	if (b.candidates < 1) b.candidates = 1;
+	if (b.candidates > BOOK_MAX_CANDIDATES) b.candidates = BOOK_MAX_CANDIDATES;
+	b.total = 2 * 21 * (1 + b.candidates * 21);
+
+	search_options_init(&b.search);
+	b.search.depth = opts->depth ? opts->depth : 1;
+	b.search.evaluate = opts->rollout.evaluate;
+	b.search.threads = opts->rollout.threads;
+	b.search.cache = cache_new(BUILD_CACHE_SIZE);
+	if (!b.search.cache) return false;
+
+	// Either player may move first; the rollouts serve both
+	for (turn = -1; turn <= 1; turn += 2) {
+		game_reset(&game);
+		game_init(&game);
+		game.direction = turn;
+		position_from_game(&start, &game);
+
+		if (!roll_out(&b, &start, 1, &ev) || !add_entry(&b, start.hash, &ev, NULL)) goto done;
+
+		for (d0 = 1; d0 <= 6; d0 ++) {
+			for (d1 = d0; d1 <= 6; d1 ++) {
+				if (!add_roll(&b, &start, d0, d1, first, &n)) goto done;
+
+				// Replies to the candidates of the first roll
+				for (i = 0; i < n; i ++)
+					for (e0 = 1; e0 <= 6; e0 ++)
+						for (e1 = e0; e1 <= 6; e1 ++)
+							if (!add_roll(&b, &first[i], e0, e1, NULL, NULL)) goto done;
+			}
+		}
+	}
+
+	ok = write_book(&b, path);
+
+done:
+	cache_free(b.search.cache);
+	free(b.entries);
+	free(b.memo);
+	return ok;
+}
+
+/**
+ * @brief Loads a book file.
+ *
+ * @param path file name
+ * @return Book* the book, NULL if the file is missing or invalid
+ */
+Book *book_open(const char *path) {
+	BookHeader header;
+	FILE *file;
+	Book *book;
+	bool ok;
+
+	file = fopen(path, "rb");
+	if (!file) return NULL;
+
+	book = malloc(sizeof(Book));
+	ok = book && fread(&header, sizeof(header), 1, file) == 1
+		&& !memcmp(header.magic, BOOK_MAGIC, 4) && header.version == BOOK_VERSION
+		&& header.entry_size == sizeof(BookEntry);
+
+	if (ok) {
+		book->count = header.count;
+		book->entries = malloc(sizeof(BookEntry) * (header.count ? header.count : 1));
+		ok = book->entries
+			&& fread(book->entries, sizeof(BookEntry), header.count, file) == header.count;
+		if (!ok) free(book->entries);
+	}
+	fclose(file);
+
+	if (ok) return book;
+
+	free(book);
+	return NULL;
+}
+
+/**
+ * @brief Frees a book.
+ *
+ * @param book the book, may be NULL
+ */
+void book_close(Book *book) {
+	if (!book) return;
+
+	free(book->entries);
+	free(book);
+}
+
+/**
+ * @brief Finds the first entry of a key.
+ *
+ * @param book the book
+ * @param key the key
+ * @return unsigned index of the first entry not below the key
+ */
+static unsigned book_find(const Book *book, uint64_t key) {
+	unsigned low = 0, high = book->count, mid;
+
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (book->entries[mid].key < key) low = mid + 1;
+		else high = mid;
+	}
+
+	return low;
+}
+
+/**
+ * @brief Reads the evaluation of an entry.
+ *
+ * @param e the entry
+ * @param ev output evaluation
+ */
+static void entry_eval(const BookEntry *e, Eval *ev) {
+	unsigned i;
+
+	for (i = 0; i < EVAL_OUTPUTS; i ++) ev->out[i] = (float) e->out[i] / BOOK_ONE;
+}
+
+/**
+ * @brief Plays of a roll found in the book.
+ *
+ * @param book the book, may be NULL
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param plays output plays
+ * @param evals output evaluations after the plays, from the point of
+ * view of the player to move
+ * @param max capacity of plays and evals
+ * @return unsigned number of plays, 0 if the roll is not in the book
+ */
+unsigned book_plays(const Book *book, const Position *pos, unsigned d0, unsigned d1,
+		Play plays[], Eval evals[], unsigned max) {
+	uint64_t key;
+	unsigned i, j, n = 0;
+	const BookEntry *e;
+
+	if (!book) return 0;
+
+	key = pos->hash ^ dice_key(d0, d1);
+	for (i = book_find(book, key); i < book->count && n < max; i ++) {
+		e = &book->entries[i];
+		if (e->key != key) break;
+		if (e->count == BOOK_POSITION) continue;
+
+		plays[n].count = e->count;
+		for (j = 0; j < e->count && j < 4; j ++) plays[n].moves[j] = e->moves[j];
+		entry_eval(e, &evals[n ++]);
+	}
+
+	return n;
+}
+
+/**
+ * @brief Evaluation of a position before the roll found in the book.
+ *
+ * @param book the book, may be NULL
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ * @return bool false if the position is not in the book
+ */
+bool book_evaluate(const Book *book, const Position *pos, Eval *ev) {
+	unsigned i;
+
+	if (!book) return false;
+
+	for (i = book_find(book, pos->hash); i < book->count && book->entries[i].key == pos->hash; i ++) {
+		if (book->entries[i].count != BOOK_POSITION) continue;
+
+		entry_eval(&book->entries[i], ev);
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Sets the book used by the searches of the AI. It must not be
+ * closed while searches use it.
+ *
+ * @param book the book, NULL for none
+ */
+void book_set_current(const Book *book) {
+	atomic_store(&current, book);
+}
+
+/**
+ * @brief Book used by the searches of the AI.
+ *
+ * @return const Book* the book, NULL for none
+ */
+const Book *book_current(void) {
+	return atomic_load_explicit(&current, memory_order_acquire);
+}
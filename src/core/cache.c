@@ -0,0 +1,166 @@
+/**
+ * @file cache.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/cache.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/cache.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Creates a cache that uses at most the given memory.
+ * The number of entries is the largest power of two that fits.
+ *
+ * @param bytes memory budget
+ * @return Cache* the cache, NULL if the budget is too small or out of memory
+ */
+Cache *cache_new(size_t bytes) {
+	Cache *cache;
+	size_t n = 1;
+
+	if (bytes < sizeof(CacheEntry)) return NULL;
+	while (n * 2 * sizeof(CacheEntry) <= bytes) n *= 2;
+
+	cache = aligned_alloc(_Alignof(Cache), sizeof(Cache));
+	if (!cache) return NULL;
+
+	cache->entries = calloc(n, sizeof(CacheEntry));
+	if (!cache->entries) {
+		free(cache);
+		return NULL;
+	}
+
+	cache->mask = n - 1;
+	atomic_init(&cache->lookups, 0);
+	atomic_init(&cache->hits, 0);
+	atomic_init(&cache->stores, 0);
+
+	return cache;
+}
+
+/**
+ * @brief Destroys a cache.
+ *
+ * @param cache the cache
+ */
+void cache_free(Cache *cache) {
+	if (!cache) return;
+	free(cache->entries);
+	free(cache);
+}
+
+/**
+ * @brief Forgets every entry and resets the counters. Must not run at the
+ * same time as lookups or stores.
+ *
+ * @param cache the cache
+ */
+void cache_clear(Cache *cache) {
+	memset(cache->entries, 0, (cache->mask + 1) * sizeof(CacheEntry));
+	atomic_store(&cache->lookups, 0);
+	atomic_store(&cache->hits, 0);
+	atomic_store(&cache->stores, 0);
+}
+
+/**
+ * @brief Searches for an evaluation of a position.
+ *
+ * @param cache the cache
+ * @param key Zobrist key of the position
+ * @param depth minimum search depth of the stored evaluation
+ * @param ev output evaluation, written on hit
+ * @return bool true on hit
+ */
+bool cache_lookup(Cache *cache, uint64_t key, unsigned depth, Eval *ev) {
+	CacheEntry *e = &cache->entries[key & cache->mask];
+	uint32_t seq, bits[EVAL_OUTPUTS];
+	unsigned stored_depth;
+	uint64_t stored_key;
+	int i;
+
+	// A writer is filling the slot
+	seq = atomic_load_explicit(&e->seq, memory_order_acquire);
+	if (seq & 1) return false;
+
+	stored_key = atomic_load_explicit(&e->key, memory_order_relaxed);
+	stored_depth = atomic_load_explicit(&e->depth, memory_order_relaxed);
+	for (i = 0; i < EVAL_OUTPUTS; i ++)
+		bits[i] = atomic_load_explicit(&e->out[i], memory_order_relaxed);
+
+	// The slot changed while it was read
+	atomic_thread_fence(memory_order_acquire);
+	if (atomic_load_explicit(&e->seq, memory_order_relaxed) != seq) return false;
+
+	if (stored_key != key || stored_depth < depth) return false;
+
+	memcpy(ev->out, bits, sizeof(bits));
+	return true;
+}
+
+/**
+ * @brief Stores an evaluation of a position. An entry of the same position
+ * searched deeper is kept; any other entry in the slot is replaced.
+ *
+ * @param cache the cache
+ * @param key Zobrist key of the position
+ * @param depth search depth of the evaluation
+ * @param ev the evaluation
+ * @return bool true if it was written
+ */
+bool cache_store(Cache *cache, uint64_t key, unsigned depth, const Eval *ev) {
+	CacheEntry *e = &cache->entries[key & cache->mask];
+	uint32_t seq, bits[EVAL_OUTPUTS];
+	int i;
+
+	// Another writer owns the slot: losing one store is cheaper than waiting
+	seq = atomic_load_explicit(&e->seq, memory_order_relaxed);
+	if (seq & 1) return false;
+	if (!atomic_compare_exchange_strong_explicit(&e->seq, &seq, seq + 1,
+			memory_order_relaxed, memory_order_relaxed)) return false;
+	atomic_thread_fence(memory_order_release);
+
+	if (atomic_load_explicit(&e->key, memory_order_relaxed) == key &&
+			atomic_load_explicit(&e->depth, memory_order_relaxed) > depth) {
+		atomic_store_explicit(&e->seq, seq, memory_order_release);
+		return false;
+	}
+
+	memcpy(bits, ev->out, sizeof(bits));
+	atomic_store_explicit(&e->key, key, memory_order_relaxed);
+	atomic_store_explicit(&e->depth, depth, memory_order_relaxed);
+	for (i = 0; i < EVAL_OUTPUTS; i ++)
+		atomic_store_explicit(&e->out[i], bits[i], memory_order_relaxed);
+
+	atomic_store_explicit(&e->seq, seq + 2, memory_order_release);
+	return true;
+}
+
+/**
+ * @brief Adds the counters of a thread to those of the cache.
+ *
+ * @param cache the cache
+ * @param counts lookups, hits and stores of the thread (entries is ignored)
+ */
+void cache_add_stats(Cache *cache, const CacheStats *counts) {
+	atomic_fetch_add_explicit(&cache->lookups, counts->lookups, memory_order_relaxed);
+	atomic_fetch_add_explicit(&cache->hits, counts->hits, memory_order_relaxed);
+	atomic_fetch_add_explicit(&cache->stores, counts->stores, memory_order_relaxed);
+}
+
+/**
+ * @brief Reads the counters of the cache.
+ *
+ * @param cache the cache
+ * @param stats output counters
+ */
+void cache_stats(Cache *cache, CacheStats *stats) {
+	stats->lookups = atomic_load(&cache->lookups);
+	stats->hits = atomic_load(&cache->hits);
+	stats->stores = atomic_load(&cache->stores);
+	stats->entries = cache->mask + 1;
+}
@@ -0,0 +1,209 @@
+/**
+ * @file cube.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/cube.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/cube.h>
+#include <core/book.h>
+
+/**
+ * @brief Average points won when winning and lost when losing.
+ *
+ * @param ev cubeless evaluation
+ * @param win output average points of a win (at least 1)
+ * @param lose output average points of a loss (at least 1)
+ */
+static void average_points(const Eval *ev, float *win, float *lose) {
+	float p = ev->out[EVAL_WIN];
+
+	*win = p > 0.0f ?
+		(p + ev->out[EVAL_WIN_GAMMON] + ev->out[EVAL_WIN_BACKGAMMON]) / p : 1.0f;
+	*lose = p < 1.0f ?
+		(1.0f - p + ev->out[EVAL_LOSE_GAMMON] + ev->out[EVAL_LOSE_BACKGAMMON]) / (1.0f - p) : 1.0f;
+}
+
+/**
+ * @brief Cubeful equity of an evaluation with Janowski's model: the
+ * cubeless equity blended with the live cube equity, which is linear
+ * between the take point and the cash point of the players.
+ *
+ * @param ev cubeless evaluation, from the point of view of the player to move
+ * @param owner owner of the cube (CUBE_CENTERED, CUBE_MINE or CUBE_THEIRS)
+ * @return float equity per unit of the cube value
+ */
+float cube_equity(const Eval *ev, int owner) {
+	float p = ev->out[EVAL_WIN], w, l, take, cash, live;
+
+	average_points(ev, &w, &l);
+
+	// Live cube: below take the opponent cashes, above cash the player does
+	take = (l - 0.5f) / (w + l + 0.5f);
+	cash = (l + 1.0f) / (w + l + 0.5f);
+
+	if (owner == CUBE_MINE)
+		live = p >= cash ? 1.0f : -l + (l + 1.0f) * p / cash;
+	else if (owner == CUBE_THEIRS)
+		live = p <= take ? -1.0f : -1.0f + (w + 1.0f) * (p - take) / (1.0f - take);
+	else
+		live = p <= take ? -1.0f : (p >= cash ? 1.0f : -1.0f + 2.0f * (p - take) / (cash - take));
+
+	return CUBE_EFFICIENCY * live + (1.0f - CUBE_EFFICIENCY) * eval_equity(ev);
+}
+
+/**
+ * @brief Cubeful match winning chance of an evaluation: Janowski's model
+ * with the cash points of the match equity table, between the chances
+ * of losing and winning the game at the score.
+ *
+ * @param ev cubeless evaluation, from the point of view of the player to move
+ * @param cube the cube, with the score of the match
+ * @param value value of the cube
+ * @param owner owner of the cube
+ * @return float the match winning chance
+ */
+static float match_equity(const Eval *ev, const Cube *cube, unsigned value, int owner) {
+	const Met *met = cube->met;
+	int a = cube->away[0], b = cube->away[1], c = value;
+	float p = ev->out[EVAL_WIN], win, lose, cash, drop, high, low, live;
+
+	// Chances at the end of the game, when it is won and when it is lost
+	win = (p - ev->out[EVAL_WIN_GAMMON]) * met_mwc(met, a - c, b)
+		+ (ev->out[EVAL_WIN_GAMMON] - ev->out[EVAL_WIN_BACKGAMMON]) * met_mwc(met, a - 2 * c, b)
+		+ ev->out[EVAL_WIN_BACKGAMMON] * met_mwc(met, a - 3 * c, b);
+	lose = (1.0f - p - ev->out[EVAL_LOSE_GAMMON]) * met_mwc(met, a, b - c)
+		+ (ev->out[EVAL_LOSE_GAMMON] - ev->out[EVAL_LOSE_BACKGAMMON]) * met_mwc(met, a, b - 2 * c)
+		+ ev->out[EVAL_LOSE_BACKGAMMON] * met_mwc(met, a, b - 3 * c);
+	win = p > 0.0f ? win / p : met_mwc(met, a - c, b);
+	lose = p < 1.0f ? lose / (1.0f - p) : met_mwc(met, a, b - c);
+
+	// Cash points of both players, as win chances of the player to move
+	cash = met_cash_point(met, a, b, value);
+	drop = 1.0f - met_cash_point(met, b, a, value);
+	high = cash < 1.0f ? met_mwc(met, a - c, b) : win;
+	low = drop > 0.0f ? met_mwc(met, a, b - c) : lose;
+
+	if (owner == CUBE_MINE)
+		live = p >= cash ? high : lose + (high - lose) * p / cash;
+	else if (owner == CUBE_THEIRS)
+		live = p <= drop ? low : low + (win - low) * (p - drop) / (1.0f - drop);
+	else
+		live = p <= drop ? low : (p >= cash ? high : low + (high - low) * (p - drop) / (cash - drop));
+
+	return CUBE_EFFICIENCY * live + (1.0f - CUBE_EFFICIENCY) * (p * win + (1.0f - p) * lose);
+}
+
+/**
+ * @brief Cube decision for an evaluation: double when doubling gives more
+ * than not doubling; take when the take is worth more than passing.
+ *
+ * @param ev cubeless evaluation, from the point of view of the player to move
+ * @param cube the cube
+ * @param d output decision
+ */
+void cube_decide(const Eval *ev, const Cube *cube, CubeDecision *d) {
+	float w, l;
+
+	d->eval = *ev;
+	d->can_double = cube->owner != CUBE_THEIRS && cube->value * 2 <= CUBE_MAX;
+
+	// After a take the cube is worth twice and belongs to the opponent
+	if (cube->met) {
+		d->no_double = match_equity(ev, cube, cube->value, cube->owner);
+		d->double_take = match_equity(ev, cube, 2 * cube->value, CUBE_THEIRS);
+		d->double_pass = met_mwc(cube->met, cube->away[0] - (int) cube->value, cube->away[1]);
+		d->take_point = 1.0f - met_cash_point(cube->met, cube->away[0], cube->away[1], cube->value);
+	} else {
+		d->no_double = cube_equity(ev, cube->owner);
+		d->double_take = 2.0f * cube_equity(ev, CUBE_THEIRS);
+		d->double_pass = 1.0f;
+
+		// Opponent's take point, with their average points
+		average_points(ev, &l, &w);
+		d->take_point = (l - 0.5f) / (w + l + 0.5f * CUBE_EFFICIENCY);
+	}
+
+	d->take = d->double_take <= d->double_pass;
+	d->double_ = d->can_double
+		&& (d->take ? d->double_take : d->double_pass) > d->no_double;
+}
+
+/**
+ * @brief Evaluates a position before the roll and makes the cube decision.
+ * The evaluation is cached by the key of the position, so asking again
+ * for the same position costs one cache lookup.
+ *
+ * @param pos the position, with the player to move before the roll
+ * @param cube the cube
+ * @param depth 0 for the static evaluation, or the plies of search_evaluate
+ * @param opts evaluator and cache (may be NULL) of the search
+ * @param d output decision
+ * @return bool false if the search was stopped, leaving d unset
+ */
+bool cube_analyze(const Position *pos, const Cube *cube, unsigned depth,
+		const SearchOptions *opts, CubeDecision *d) {
+	uint64_t key = pos->hash ^ CUBE_KEY ^ met_match_key(opts->match);
+	CacheStats counts = {1, 0, 0, 0};
+	bool done = true;
+	Eval ev;
+
+	if (opts->cache && cache_lookup(opts->cache, key, depth, &ev)) counts.hits = 1;
+	else {
+		if (depth) {
+			search_evaluate(pos, depth, opts, &ev);
+			done = !search_stopped(opts);
+		} else opts->evaluate(pos, &ev);
+
+		if (done && opts->cache) counts.stores = cache_store(opts->cache, key, depth, &ev);
+	}
+
+	if (opts->cache) cache_add_stats(opts->cache, &counts);
+	if (!done) return false;
+
+	cube_decide(&ev, cube, d);
+	return true;
+}
+
+/**
+ * @brief Iterative deepening of cube_analyze: depth 0, 1, ... up to depth
+ * while the time budget lasts. Depth 0 always completes.
+ * Positions found in the current opening book are decided from its
+ * rollout at once, as if searched to depth.
+ *
+ * @param pos the position, with the player to move before the roll
+ * @param cube the cube
+ * @param depth deepest search
+ * @param opts evaluator and cache (may be NULL) of the search
+ * @param budget seconds, 0 for no limit
+ * @param d output decision of the deepest search that completed
+ * @return unsigned depth of the decision
+ */
+unsigned cube_iterate(const Position *pos, const Cube *cube, unsigned depth,
+		const SearchOptions *opts, double budget, CubeDecision *d) {
+	SearchOptions iter = *opts;
+	CubeDecision next;
+	Eval ev;
+	unsigned reached;
+	double start = search_clock();
+
+	// The book rollout is better than any search of ours
+	if (book_evaluate(book_current(), pos, &ev)) {
+		cube_decide(&ev, cube, d);
+		return depth;
+	}
+
+	iter.deadline = 0.0;
+	cube_analyze(pos, cube, 0, &iter, d);
+
+	iter.deadline = budget > 0.0 ? start + budget : 0.0;
+
+	for (reached = 0; reached < depth; reached ++) {
+		if (!cube_analyze(pos, cube, reached + 1, &iter, &next)) break;
+		*d = next;
+	}
+
+	return reached;
+}
@@ -0,0 +1,268 @@
+/**
+ * @file eval.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/eval.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/eval.h>
+#include <core/bearoff.h>
+#include <core/bearoff2.h>
+#include <core/nnet.h>
+
+#include <math.h>
+
+/**
+ * @brief Cubeless money equity of an evaluation, in points per game.
+ *
+ * @param ev the evaluation
+ * @return float equity between -3 and 3
+ */
+float eval_equity(const Eval *ev) {
+	return 2.0f * ev->out[EVAL_WIN] - 1.0f
+		+ ev->out[EVAL_WIN_GAMMON] - ev->out[EVAL_LOSE_GAMMON]
+		+ ev->out[EVAL_WIN_BACKGAMMON] - ev->out[EVAL_LOSE_BACKGAMMON];
+}
+
+/**
+ * @brief Changes the point of view of an evaluation to the opponent.
+ *
+ * @param ev the evaluation
+ */
+void eval_invert(Eval *ev) {
+	float tmp;
+
+	ev->out[EVAL_WIN] = 1.0f - ev->out[EVAL_WIN];
+
+	tmp = ev->out[EVAL_WIN_GAMMON];
+	ev->out[EVAL_WIN_GAMMON] = ev->out[EVAL_LOSE_GAMMON];
+	ev->out[EVAL_LOSE_GAMMON] = tmp;
+
+	tmp = ev->out[EVAL_WIN_BACKGAMMON];
+	ev->out[EVAL_WIN_BACKGAMMON] = ev->out[EVAL_LOSE_BACKGAMMON];
+	ev->out[EVAL_LOSE_BACKGAMMON] = tmp;
+}
+
+/**
+ * @brief Exact evaluation of a finished game, from the point of view of the
+ * player to move.
+ *
+ * @param pos a position with a winner
+ * @param ev output evaluation
+ */
+void eval_terminal(const Position *pos, Eval *ev) {
+	int i, winner;
+	unsigned points;
+
+	for (i = 0; i < EVAL_OUTPUTS; i ++) ev->out[i] = 0.0f;
+
+	winner = position_winner(pos);
+	points = position_winner_points(pos, winner);
+
+	if (winner == pos->turn) {
+		ev->out[EVAL_WIN] = 1.0f;
+		ev->out[EVAL_WIN_GAMMON] = points >= 2;
+		ev->out[EVAL_WIN_BACKGAMMON] = points == 3;
+	} else {
+		ev->out[EVAL_LOSE_GAMMON] = points >= 2;
+		ev->out[EVAL_LOSE_BACKGAMMON] = points == 3;
+	}
+}
+
+/**
+ * @brief Clamps a value between a minimum and a maximum.
+ *
+ * @param x the value
+ * @param min minimum
+ * @param max maximum
+ * @return float the clamped value
+ */
+static float clamp(float x, float min, float max) {
+	return x < min ? min : (x > max ? max : x);
+}
+
+/**
+ * @brief Checks if the pieces of both players can still meet.
+ *
+ * @param pos the position
+ * @return bool true if there is contact
+ */
+static bool has_contact(const Position *pos) {
+	int i, back_down = -1, back_up = 24;
+
+	// Farthest piece moving down (direction -1) and moving up (direction 1)
+	if (pos->bar[SIDE_OF(-1)]) back_down = 24;
+	if (pos->bar[SIDE_OF(1)]) back_up = -1;
+
+	for (i = 0; i < 24; i ++) {
+		if (pos->points[i] < 0 && i > back_down) back_down = i;
+		if (pos->points[i] > 0 && i < back_up) back_up = i;
+	}
+
+	return back_down > back_up;
+}
+
+/**
+ * @brief Counts the single pieces of a player that the opponent can hit
+ * with one die or with the sum of both.
+ *
+ * @param pos the position
+ * @param dir direction of the player
+ * @return int number of exposed blots
+ */
+static int exposed_blots(const Position *pos, int dir) {
+	int i, j, dist, count = 0;
+	bool exposed;
+
+	for (i = 0; i < 24; i ++) {
+		if (pos->points[i] * dir != 1) continue;
+
+		// Opponent's prisoners enter from outside the board
+		dist = (i - (dir == 1 ? 24 : -1)) * -dir;
+		exposed = pos->bar[SIDE_OF(-dir)] && dist >= 1 && dist <= 12;
+
+		for (j = 0; j < 24 && !exposed; j ++) {
+			if (pos->points[j] * dir >= 0) continue;
+			dist = (i - j) * -dir;
+			if (dist >= 1 && dist <= 12) exposed = true;
+		}
+
+		if (exposed) count ++;
+	}
+
+	return count;
+}
+
+/**
+ * @brief Counts the places of the home board held with two or more pieces.
+ *
+ * @param pos the position
+ * @param dir direction of the player
+ * @return int number of points made
+ */
+static int home_points(const Position *pos, int dir) {
+	int i, start, count = 0;
+
+	start = dir == -1 ? 0 : 18;
+	for (i = start; i < start + 6; i ++)
+		if (pos->points[i] * dir >= 2) count ++;
+
+	return count;
+}
+
+/**
+ * @brief Chance that a won game is a gammon, and that a gammon is a
+ * backgammon, judging from the loser's pieces.
+ *
+ * @param pos the position
+ * @param win_dir direction of the winner
+ * @param backgammon output ratio of backgammons among gammons
+ * @return float ratio of gammons among wins
+ */
+static float gammon_ratio(const Position *pos, int win_dir, float *backgammon) {
+	int i, start, trapped, loser, winner;
+	float gammon;
+
+	loser = SIDE_OF(-win_dir);
+	winner = SIDE_OF(win_dir);
+
+	*backgammon = 0.0f;
+	if (pos->off[loser]) return 0.0f;
+
+	gammon = clamp(0.02f * pos->outside[loser]
+			+ (pos->steps[loser] - pos->steps[winner]) / 200.0f, 0.0f, 0.6f);
+
+	// Loser's pieces in prison or in the winner's home board
+	trapped = pos->bar[loser];
+	start = win_dir == -1 ? 0 : 18;
+	for (i = start; i < start + 6; i ++)
+		if (pos->points[i] * win_dir < 0) trapped -= pos->points[i] * win_dir;
+
+	*backgammon = clamp(0.1f * trapped, 0.0f, 0.5f);
+
+	return gammon;
+}
+
+/**
+ * @brief Exact evaluation from the current bearoff databases, when both
+ * players are bearing off: the two-sided one first, then the one-sided one.
+ *
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ * @return bool false if no database covers the position
+ */
+bool eval_exact(const Position *pos, Eval *ev) {
+	return bearoff2_evaluate(bearoff2_current(), pos, ev)
+		|| bearoff_evaluate(bearoff_current(), pos, ev);
+}
+
+/**
+ * @brief Hand-made evaluator: race balance, blots in reach of the opponent,
+ * points made in the home board and prisoners. Meant as a baseline and as a
+ * fallback when no trained evaluator is available. Positions where both
+ * players are bearing off are read from the current bearoff databases.
+ *
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ */
+void eval_heuristic(const Position *pos, Eval *ev) {
+	int me, side;
+	float mine, theirs, x, win, gammon, backgammon;
+
+	if (position_winner(pos)) {
+		eval_terminal(pos, ev);
+		return;
+	}
+
+	// Both players bearing off: exact
+	if (eval_exact(pos, ev)) return;
+
+	me = pos->turn;
+	side = SIDE_OF(me);
+	mine = pos->steps[side];
+	theirs = pos->steps[!side];
+
+	// Race: the player to move is worth about 4 steps
+	x = 2.0f * (theirs - mine + 4.0f) / sqrtf(mine + theirs + 1.0f);
+
+	if (has_contact(pos)) {
+		x += 0.25f * exposed_blots(pos, -me) - 0.15f * exposed_blots(pos, me);
+		x += 0.12f * (home_points(pos, me) - home_points(pos, -me));
+		x += 0.4f * (pos->bar[!side] - pos->bar[side]);
+	}
+
+	win = 1.0f / (1.0f + expf(-x));
+	ev->out[EVAL_WIN] = win;
+
+	gammon = win * gammon_ratio(pos, me, &backgammon);
+	ev->out[EVAL_WIN_GAMMON] = gammon;
+	ev->out[EVAL_WIN_BACKGAMMON] = gammon * backgammon;
+
+	gammon = (1.0f - win) * gammon_ratio(pos, -me, &backgammon);
+	ev->out[EVAL_LOSE_GAMMON] = gammon;
+	ev->out[EVAL_LOSE_BACKGAMMON] = gammon * backgammon;
+}
+
+/**
+ * @brief Evaluates positions in one call. The positions and the outputs
+ * are contiguous arrays; evaluators that share work between positions
+ * (eval_nnet) do so, the others evaluate them one by one.
+ *
+ * @param evaluate the evaluator
+ * @param positions the positions
+ * @param count number of positions
+ * @param evals output evaluations, from the point of view of the player
+ * to move of each position
+ */
+void eval_batch(Evaluator evaluate, const Position positions[], unsigned count, Eval evals[]) {
+	unsigned i;
+
+	if (evaluate == eval_nnet) {
+		eval_nnet_batch(positions, count, evals);
+		return;
+	}
+
+	for (i = 0; i < count; i ++) evaluate(&positions[i], &evals[i]);
+}
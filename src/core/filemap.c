@@ -0,0 +1,109 @@
+/**
+ * @file filemap.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/filemap.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/filemap.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+/**
+ * @brief Maps a whole file into memory, read-only. The pages are shared
+ * with other processes mapping the same file.
+ *
+ * @param path file name
+ * @param size output size of the file in bytes
+ * @return void* the memory, NULL if the file is missing, empty or cannot
+ * be mapped
+ */
+void *filemap_open(const char *path, size_t *size) {
+	HANDLE file, mapping;
+	LARGE_INTEGER length;
+	void *map = NULL;
+
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return NULL;
+
+	if (GetFileSizeEx(file, &length) && length.QuadPart > 0
+			&& (uint64_t) length.QuadPart <= SIZE_MAX) {
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping) {
+			// The view keeps the mapping alive after its handle is closed
+			map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+
+	if (map) *size = (size_t) length.QuadPart;
+	return map;
+}
+
+/**
+ * @brief Unmaps a file mapped by filemap_open.
+ *
+ * @param map the memory
+ * @param size size of the file in bytes
+ */
+void filemap_close(void *map, size_t size) {
+	(void) size;
+	UnmapViewOfFile(map);
+}
+
+#else
+
+/**
+ * @brief Maps a whole file into memory, read-only. The pages are shared
+ * with other processes mapping the same file.
+ *
+ * @param path file name
+ * @param size output size of the file in bytes
+ * @return void* the memory, NULL if the file is missing, empty or cannot
+ * be mapped
+ */
+void *filemap_open(const char *path, size_t *size) {
+	struct stat st;
+	void *map;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) return NULL;
+
+	if (fstat(fd, &st) || st.st_size <= 0) {
+		close(fd);
+		return NULL;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return NULL;
+
+	*size = st.st_size;
+	return map;
+}
+
+/**
+ * @brief Unmaps a file mapped by filemap_open.
+ *
+ * @param map the memory
+ * @param size size of the file in bytes
+ */
+void filemap_close(void *map, size_t size) {
+	munmap(map, size);
+}
+
+#endif
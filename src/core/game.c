@@ -0,0 +1,416 @@
+/**
+ * @file game.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/game.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/game.h>
+#include <core/zobrist.h>
+
+#include <string.h>
+
+/**
+ * @brief Returns the position of the last piece before the pieces
+ * reach the goal
+ *
+ * @param game Game instance
+ * @return int the position of the last piece
+ */
+static int get_index_of_last_piece(const Game *game) {
+	int i, cdir;
+	cdir = game->direction;
+
+	if (cdir == -1) {
+		for (i = 5; i >= 0; i--) {
+			if (cdir * game->places[i] > 0) return i;
+		}
+	} else {
+		for (i = 18; i < 24; i++) {
+			if (cdir * game->places[i] > 0) return i;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Marks the first unconsumed die with the given value as consumed.
+ *
+ * @param game Game instance
+ * @param dice_value value of the die
+ */
+static void consume_die(Game *game, unsigned dice_value) {
+	int i;
+
+	for (i = 0; i < GAME_DICE_COUNT(game); i++) {
+		if (game->consumed_dice[i]) continue;
+		if (game->dice[i % 2] == dice_value) {
+			game->consumed_dice[i] = true;
+			break;
+		}
+	}
+}
+
+/**
+ * @brief Clears the board: no pieces, dice set to 1-1.
+ *
+ * @param game Game instance
+ */
+void game_reset(Game *game) {
+	memset(game, 0, sizeof(Game));
+	game->dice[0] = 1;
+	game->dice[1] = 1;
+	game->direction = 1;
+}
+
+/**
+ * @brief Arranges the pieces according to the rules and restores the dice.
+ *
+ * @param game Game instance
+ */
+void game_init(Game *game) {
+	int i;
+
+	for (i = 0; i < 24; i ++) game->places[i] = 0;
+	for (i = 0; i < 2; i ++) {
+		game->goal[i] = 0;
+		game->prison[i] = 0;
+	}
+
+	game->places[0] = 2;
+	game->places[5] = -5;
+	game->places[7] = -3;
+	game->places[11] = 5;
+	game->places[12] = -5;
+	game->places[16] = 3;
+	game->places[18] = 5;
+	game->places[23] = -2;
+
+	game_update_counters(game);
+
+	// Dice
+	for (i = 0; i < 4; i ++) game->consumed_dice[i] = false;
+}
+
+/**
+ * @brief Recounts the steps and outside counters and the key from the pieces.
+ * Needed only after writing places, prisons or goals directly.
+ *
+ * @param game Game instance
+ */
+void game_update_counters(Game *game) {
+	int i, dir, val;
+
+	for (dir = -1; dir <= 1; dir += 2) {
+		// Prison
+		val = game->prison[PRISON_OF(dir)] * dir;
+		game->steps[SIDE_OF(dir)] = val * 24;
+		game->outside[SIDE_OF(dir)] = val;
+
+		for (i = 0; i < 24; i ++) {
+			val = game->places[i] * dir;
+			if (val <= 0) continue;
+
+			game->steps[SIDE_OF(dir)] += val * PLACE_STEPS(dir, i);
+			game->outside[SIDE_OF(dir)] += val * PLACE_OUTSIDE(dir, i);
+		}
+	}
+
+	game->hash = zobrist_game(game);
+}
+
+/**
+ * @brief Sets the dice values and clears the consumption flags.
+ *
+ * @param game Game instance
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ */
+void game_set_dice(Game *game, unsigned d0, unsigned d1) {
+	int i;
+
+	for (i = 0; i < 4; i ++) game->consumed_dice[i] = false;
+	game->dice[0] = d0;
+	game->dice[1] = d1;
+}
+
+/**
+ * @brief Checks if all the pieces of the player to move are in their territory.
+ *
+ * @param game Game instance
+ * @return bool true if all the pieces are in the territory.
+ */
+bool game_all_pieces_in_territory(const Game *game) {
+	return game->outside[SIDE_OF(game->direction)] == 0;
+}
+
+/**
+ * @brief Searches for possible movements for the player to move
+ * from prison
+ *
+ * @param game Game instance
+ * @param list output list
+ * @return unsigned number of movements found
+ */
+static unsigned scan_prison_movements(const Game *game, MoveList *list) {
+	int i, destiny, value;
+	unsigned dice_value;
+
+	for (i = 0; i < GAME_DICE_COUNT(game); i++) {
+		if (game->consumed_dice[i]) continue;
+		dice_value = game->dice[i % 2];
+
+		if (game->direction == -1)
+			destiny = 24 - dice_value;
+		else destiny = dice_value - 1;
+
+		// If the destination has opponent's pieces
+		if (game->places[destiny] * game->direction < 0) {
+			value = game->places[destiny];
+			value *= value < 0 ? -1 : 1;
+
+			// If there are two or more opponent's pieces
+			if (value != 1) continue;
+		}
+
+		list->moves[list->count++] = MOVEMENT(-1, destiny, dice_value);
+	}
+
+	return list->count;
+}
+
+/**
+ * @brief Searches for a movement of the piece at src to the goal.
+ * If the piece is the last one in the race, a move less than the dice value will be allowed.
+ *
+ * @param game Game instance
+ * @param list output list
+ * @param src source of the piece on the board
+ * @param dice_value value of the dice
+ */
+static void scan_goal_movement(const Game *game, MoveList *list, int src, int dice_value) {
+	bool found = false;
+
+	if (game->direction == -1) {
+		if (src < 6) {
+			if ((dice_value - src) == 1) {
+				found = true;
+			} else if ((dice_value - src) > 1) {
+				found = get_index_of_last_piece(game) <= src;
+			}
+		}
+	} else {
+		if (src > 17) {
+			if ((dice_value + src) == 24) {
+				found = true;
+			} else if ((dice_value + src) > 24) {
+				found = get_index_of_last_piece(game) >= src;
+			}
+		}
+	}
+
+	if (found) list->moves[list->count++] = MOVEMENT(src, -1, dice_value);
+}
+
+/**
+ * @brief Searches for possible single-die movements for the player to move.
+ *
+ * @param game Game instance
+ * @param list output list, overwritten
+ * @return unsigned number of movements found
+ */
+unsigned game_scan_movements(const Game *game, MoveList *list) {
+	int i, d, cdir, destiny, value, dice_value;
+	bool in_territory;
+
+	cdir = game->direction;
+	list->count = 0;
+
+	// If there are pieces in prison ...
+	if (game->prison[PRISON_OF(cdir)])
+		return scan_prison_movements(game, list);
+
+	in_territory = game_all_pieces_in_territory(game);
+
+	for (i = 0; i < 24; i++) {
+		// Check if there are pieces and if they belong to the player to move
+		if (game->places[i] * cdir <= 0) continue;
+
+		for (d = 0; d < GAME_DICE_COUNT(game); d++) {
+			if (game->consumed_dice[d]) continue;
+
+			dice_value = game->dice[d % 2];
+			destiny = i + dice_value * cdir;
+
+			// Check goal selection: all pieces must be in the current territory
+			if (in_territory) scan_goal_movement(game, list, i, dice_value);
+
+			if (destiny < 0 || destiny > 23) continue;
+
+			// If the destination has opponent's pieces
+			if (game->places[destiny] * cdir < 0) {
+				value = game->places[destiny];
+				value *= value < 0 ? -1 : 1;
+
+				// If there are two or more opponent's pieces
+				if (value != 1) continue;
+			}
+
+			list->moves[list->count++] = MOVEMENT(i, destiny, dice_value);
+		}
+	}
+
+	return list->count;
+}
+
+/**
+ * @brief Moves a piece of the player to move and consumes the die.
+ * There must be pieces at the source position (from the player to move).
+ * Removes one piece from the source and adds it to the destination.
+ * If the destination has an opponent's piece, the opponent's prison captures it.
+ *
+ * @param game Game instance
+ * @param m the registered movement
+ */
+void game_move_piece(Game *game, Movement m) {
+	int cdir, src, dest, side;
+	cdir = game->direction;
+	side = SIDE_OF(cdir);
+
+	// Deactivate the die according to the distance
+	consume_die(game, MOVEMENT_DICE(m));
+
+	// Remove from source
+	if (MOVEMENT_PRISON_SRC(m)) {
+		game->hash ^= zobrist_bar[side][game->prison[PRISON_OF(cdir)] * cdir];
+		game->prison[PRISON_OF(cdir)] -= cdir;
+		game->hash ^= zobrist_bar[side][game->prison[PRISON_OF(cdir)] * cdir];
+		game->steps[side] -= 24;
+		game->outside[side] --;
+	} else {
+		src = MOVEMENT_SRC(m);
+		game->hash ^= ZOBRIST_POINT(src, game->places[src]);
+		game->places[src] -= cdir;
+		game->hash ^= ZOBRIST_POINT(src, game->places[src]);
+		game->steps[side] -= PLACE_STEPS(cdir, src);
+		game->outside[side] -= PLACE_OUTSIDE(cdir, src);
+	}
+
+	// If the destiny is a goal
+	if (MOVEMENT_GOAL_DEST(m)) {
+		game->hash ^= zobrist_off[side][game->goal[GOAL_OF(cdir)] * cdir];
+		game->goal[GOAL_OF(cdir)] += cdir;
+		game->hash ^= zobrist_off[side][game->goal[GOAL_OF(cdir)] * cdir];
+		return;
+	}
+
+	dest = MOVEMENT_DEST(m);
+	game->steps[side] += PLACE_STEPS(cdir, dest);
+	game->outside[side] += PLACE_OUTSIDE(cdir, dest);
+	game->hash ^= ZOBRIST_POINT(dest, game->places[dest]);
+
+	// If the destination is not an enemy
+	if (game->places[dest] * cdir >= 0) {
+		game->places[dest] += cdir;
+	} else {
+		// If it's an enemy...
+
+		// Put the piece in prison
+		game->hash ^= zobrist_bar[!side][game->prison[PRISON_OF(-cdir)] * -cdir];
+		game->prison[PRISON_OF(-cdir)] -= cdir;
+		game->hash ^= zobrist_bar[!side][game->prison[PRISON_OF(-cdir)] * -cdir];
+		game->steps[!side] += 24 - PLACE_STEPS(-cdir, dest);
+		game->outside[!side] += 1 - PLACE_OUTSIDE(-cdir, dest);
+
+		// Replace the current piece
+		game->places[dest] *= -1;
+	}
+
+	game->hash ^= ZOBRIST_POINT(dest, game->places[dest]);
+}
+
+/**
+ * @brief Returns the number of steps a player needs to win
+ *
+ * @param game Game instance
+ * @param direction direction of the target player
+ * @return unsigned number of remaining steps
+ */
+unsigned game_count_steps(const Game *game, int direction) {
+	return game->steps[SIDE_OF(direction)];
+}
+
+/**
+ * @brief Returns the number of pieces of a player outside their territory,
+ * prisoners included.
+ *
+ * @param game Game instance
+ * @param direction direction of the target player
+ * @return unsigned number of pieces outside the territory
+ */
+unsigned game_pieces_outside(const Game *game, int direction) {
+	return game->outside[SIDE_OF(direction)];
+}
+
+/**
+ * @brief Returns the number of pieces of a player in prison.
+ *
+ * @param game Game instance
+ * @param direction direction of the target player
+ * @return unsigned number of prisoners
+ */
+unsigned game_prisoners(const Game *game, int direction) {
+	return game->prison[PRISON_OF(direction)] * direction;
+}
+
+/**
+ * @brief Zobrist key of the game: the pieces and the player to move.
+ * Equal to the key of the Position built from the game.
+ *
+ * @param game Game instance
+ * @return uint64_t key of the game
+ */
+uint64_t game_hash(const Game *game) {
+	return game->direction == 1 ? game->hash ^ zobrist_turn : game->hash;
+}
+
+/**
+ * @brief Returns the direction of the player who removed all 15 pieces.
+ *
+ * @param game Game instance
+ * @return int direction of the winner, 0 while the game is in progress
+ */
+int game_winner(const Game *game) {
+	if (game->goal[GOAL_OF(-1)] == -15) return -1;
+	if (game->goal[GOAL_OF(1)] == 15) return 1;
+	return 0;
+}
+
+/**
+ * @brief Determines the points earned by the winner.
+ * 1: When the opponent has removed some pieces from the board.
+ * 2: (Gammon) When the opponent has not removed any pieces.
+ * 3: (Backgammon) When the opponent still has pieces in the winner's territory or in the winner's prison.
+ *
+ * @param game Game instance
+ * @param win_dir Direction of the winner
+ * @return unsigned The points earned by the winner
+ */
+unsigned game_winner_points(const Game *game, int win_dir) {
+	int i, start;
+
+	// Check Gammon
+	if (game->goal[GOAL_OF(-win_dir)]) return 1;
+
+	// Check backgammon
+	if (game->prison[PRISON_OF(-win_dir)]) return 3;
+
+	start = win_dir == -1 ? 0 : 18;
+	for (i = start; i < start + 6; i ++) {
+		if (game->places[i] * win_dir < 0) return 3;
+	}
+
+	return 2;
+}
@@ -0,0 +1,804 @@
+/**
+ * @file mcts.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/mcts.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/mcts.h>
+#include <core/rng.h>
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Values are summed as multiples of 1/MCTS_ONE, so that threads
+ * add them with one atomic operation.
+ */
+#define MCTS_ONE				1048576.0
+
+/**
+ * @brief Weight of the static evaluation of a play, in visits.
+ */
+#define MCTS_PRIOR_VISITS		1.0f
+
+/**
+ * @brief Value of a virtual visit: a loss, so that the threads spread
+ * over the plays instead of following each other.
+ */
+#define MCTS_VIRTUAL_LOSS		-1.0f
+
+/**
+ * @brief Pointer of a child that a thread is creating right now.
+ */
+#define MCTS_BUSY				((void *) 1)
+
+/**
+ * @brief Levels of plays below the root searched for the next root: the
+ * play of the search and the reply of the opponent.
+ */
+#define MCTS_REUSE_LEVELS		2
+
+/**
+ * @brief Longest path of a simulation, in plays.
+ */
+#define MCTS_MAX_DEPTH			256
+
+typedef struct mcts_node_t MctsNode;
+
+/**
+ * @brief Position after a play, before the roll of the opponent: the
+ * decision nodes of the 21 rolls, created on the first visit of each.
+ *
+ */
+typedef struct mcts_chance_t {
+	Position pos;
+	_Atomic(MctsNode *) rolls[21];
+} MctsChance;
+
+/**
+ * @brief A play of a decision node. prior is the static value of the
+ * position after it, exact when the play ends the game; sum adds the
+ * values of the visits, both for the player who makes the play. Threads
+ * on their way down count a virtual visit.
+ *
+ */
+typedef struct mcts_edge_t {
+	Play play;
+	float prior;
+	bool terminal;
+	_Atomic uint32_t visits, virtual_visits;
+	_Atomic int64_t sum;
+	_Atomic(MctsChance *) chance;
+} MctsEdge;
+
+/**
+ * @brief A decision node: a position with the dice rolled and its plays,
+ * best first. value is the best prior of the plays.
+ *
+ */
+struct mcts_node_t {
+	Position pos;
+	unsigned char dice[2];
+	float value;
+	_Atomic uint32_t visits;
+	unsigned count;
+	MctsEdge edges[];
+};
+
+/**
+ * @brief A tree. Nodes are allocated from pools[current] by moving its
+ * used mark; the other pool receives the subtree kept for the next
+ * search, and then they swap.
+ *
+ */
+struct mcts_t {
+	unsigned char *pools[2];
+	size_t size;
+	unsigned current;
+	_Atomic size_t used;
+	atomic_bool full;
+
+	MctsNode *root;
+	Evaluator evaluate;
+	uint64_t key;
+
+	const MctsOptions *opts;
+	double deadline;
+	_Atomic uint64_t simulations;
+};
+
+/**
+ * @brief A thread of a search.
+ *
+ */
+typedef struct mcts_worker_t {
+	Mcts *mcts;
+	Rng rng;
+} MctsWorker;
+
+/**
+ * @brief The 21 distinct rolls, doubles first.
+ */
+static const unsigned char rolls[21][2] = {
+	{1, 1}, {2, 2}, {3, 3}, {4, 4}, {5, 5}, {6, 6},
+	{1, 2}, {1, 3}, {1, 4}, {1, 5}, {1, 6}, {2, 3}, {2, 4},
+	{2, 5}, {2, 6}, {3, 4}, {3, 5}, {3, 6}, {4, 5}, {4, 6}, {5, 6}
+};
+
+/**
+ * @brief Monotonic clock in seconds.
+ *
+ * @return double seconds
+ */
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Index of a roll in rolls.
+ *
+ * @param d0 value of a die
+ * @param d1 value of the other die
+ * @return unsigned the index
+ */
+static unsigned roll_index(unsigned d0, unsigned d1) {
+	unsigned lo = d0 < d1 ? d0 : d1, hi = d0 < d1 ? d1 : d0, r;
+
+	if (lo == hi) return lo - 1;
+	for (r = 6; rolls[r][0] != lo || rolls[r][1] != hi; r ++);
+
+	return r;
+}
+
+/**
+ * @brief Value of an evaluation for the player to move, between -1 and 1
+ * for a match (twice the match winning chance, minus 1), so that the
+ * value for the opponent is its opposite.
+ *
+ * @param opts settings
+ * @param pos the position, with the player the evaluation belongs to on turn
+ * @param ev the evaluation
+ * @return float the value
+ */
+static float value_of(const MctsOptions *opts, const Position *pos, const Eval *ev) {
+	const Match *match = opts->match;
+	int side = SIDE_OF(pos->turn);
+
+	if (!match) return eval_equity(ev);
+
+	return 2.0f * met_equity(match->met, ev, match->away[side], match->away[1 - side],
+			match->cube) - 1.0f;
+}
+
+/**
+ * @brief Bytes of pool taken by an allocation.
+ *
+ * @param size bytes asked
+ * @return size_t bytes taken
+ */
+static size_t pool_round(size_t size) {
+	return (size + 15) & ~(size_t) 15;
+}
+
+/**
+ * @brief Takes memory from the current pool. When it runs out, the tree
+ * is marked full.
+ *
+ * @param mcts the tree
+ * @param size bytes
+ * @return void* the memory, NULL if the pool is full
+ */
+static void *pool_alloc(Mcts *mcts, size_t size) {
+	size_t offset;
+
+	size = pool_round(size);
+	offset = atomic_fetch_add(&mcts->used, size);
+	if (offset + size > mcts->size) {
+		atomic_store(&mcts->full, true);
+		return NULL;
+	}
+
+	return mcts->pools[mcts->current] + offset;
+}
+
+/**
+ * @brief Creates a decision node: its plays are evaluated in one batch
+ * and the best max of them are kept, sorted.
+ *
+ * @param mcts the tree
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param max most plays kept
+ * @return MctsNode* the node, NULL if the pool is full
+ */
+static MctsNode *node_create(Mcts *mcts, const Position *pos, unsigned d0, unsigned d1,
+		unsigned max) {
+	Play plays[MOVEGEN_MAX_PLAYS];
+	Position next[MOVEGEN_MAX_PLAYS];
+	Eval evals[MOVEGEN_MAX_PLAYS];
+	unsigned order[MOVEGEN_MAX_PLAYS];
+	float values[MOVEGEN_MAX_PLAYS];
+	unsigned i, j, k, count;
+	MctsNode *node;
+	MctsEdge *e;
+
+	count = movegen_plays(pos, d0, d1, plays);
+	movegen_children(pos, plays, count, next);
+	eval_batch(mcts->opts->evaluate, next, count, evals);
+
+	// Best max plays by value for the player who makes them
+	k = 0;
+	for (i = 0; i < count; i ++) {
+		values[i] = -value_of(mcts->opts, &next[i], &evals[i]);
+		if (k == max && values[i] <= values[order[k - 1]]) continue;
+		if (k < max) k ++;
+		for (j = k - 1; j > 0 && values[order[j - 1]] < values[i]; j --) order[j] = order[j - 1];
+		order[j] = i;
+	}
+
+	node = pool_alloc(mcts, sizeof(MctsNode) + k * sizeof(MctsEdge));
+	if (!node) return NULL;
+
+	node->pos = *pos;
+	node->dice[0] = d0;
+	node->dice[1] = d1;
+	node->value = values[order[0]];
+	atomic_init(&node->visits, 0);
+	node->count = k;
+
+	for (i = 0; i < k; i ++) {
+		e = &node->edges[i];
+		e->play = plays[order[i]];
+		e->prior = values[order[i]];
+		e->terminal = position_winner(&next[order[i]]) != 0;
+		atomic_init(&e->visits, 0);
+		atomic_init(&e->virtual_visits, 0);
+		atomic_init(&e->sum, 0);
+		atomic_init(&e->chance, NULL);
+	}
+
+	return node;
+}
+
+/**
+ * @brief Chance node after a play, created on its first visit.
+ *
+ * @param mcts the tree
+ * @param node the decision node
+ * @param e the play
+ * @return MctsChance* the chance node, NULL if another thread is creating
+ * it or the pool is full
+ */
+static MctsChance *chance_get(Mcts *mcts, const MctsNode *node, MctsEdge *e) {
+	MctsChance *chance = atomic_load_explicit(&e->chance, memory_order_acquire), *expected = NULL;
+	unsigned r;
+
+	if (chance) return chance == MCTS_BUSY ? NULL : chance;
+	if (!atomic_compare_exchange_strong(&e->chance, &expected, MCTS_BUSY))
+		return expected == MCTS_BUSY ? NULL : expected;
+
+	chance = pool_alloc(mcts, sizeof(MctsChance));
+	if (chance) {
+		chance->pos = node->pos;
+		movegen_apply_position(&chance->pos, &e->play);
+		position_switch_turn(&chance->pos);
+		for (r = 0; r < 21; r ++) atomic_init(&chance->rolls[r], NULL);
+	}
+
+	atomic_store_explicit(&e->chance, chance, memory_order_release);
+	return chance;
+}
+
+/**
+ * @brief Decision node of a roll of a chance node, created on its first
+ * visit.
+ *
+ * @param mcts the tree
+ * @param chance the chance node
+ * @param r index of the roll
+ * @param created output, true if this call created it
+ * @return MctsNode* the node, NULL if another thread is creating it or
+ * the pool is full
+ */
+static MctsNode *roll_get(Mcts *mcts, MctsChance *chance, unsigned r, bool *created) {
+	MctsNode *node = atomic_load_explicit(&chance->rolls[r], memory_order_acquire), *expected = NULL;
+
+	*created = false;
+	if (node) return node == MCTS_BUSY ? NULL : node;
+	if (!atomic_compare_exchange_strong(&chance->rolls[r], &expected, MCTS_BUSY))
+		return expected == MCTS_BUSY ? NULL : expected;
+
+	node = node_create(mcts, &chance->pos, rolls[r][0], rolls[r][1], MCTS_MAX_EDGES);
+	*created = node != NULL;
+
+	atomic_store_explicit(&chance->rolls[r], node, memory_order_release);
+	return node;
+}
+
+/**
+ * @brief Chooses the play to visit: the best mean value (the prior
+ * counts as visits, the virtual visits as losses) plus the exploration
+ * bonus of the plays visited least.
+ *
+ * @param mcts the tree
+ * @param node the decision node
+ * @return MctsEdge* the play
+ */
+static MctsEdge *select_edge(const Mcts *mcts, MctsNode *node) {
+	float bonus = mcts->opts->exploration * sqrtf((float) atomic_load(&node->visits) + 1.0f);
+	float score, best_score = -INFINITY;
+	uint32_t visits, virtual_visits;
+	MctsEdge *e, *best = &node->edges[0];
+	unsigned i;
+
+	for (i = 0; i < node->count; i ++) {
+		e = &node->edges[i];
+		visits = atomic_load_explicit(&e->visits, memory_order_relaxed);
+		virtual_visits = atomic_load_explicit(&e->virtual_visits, memory_order_relaxed);
+
+		score = (atomic_load_explicit(&e->sum, memory_order_relaxed) / MCTS_ONE
+				+ e->prior * MCTS_PRIOR_VISITS + virtual_visits * MCTS_VIRTUAL_LOSS)
+				/ (visits + virtual_visits + MCTS_PRIOR_VISITS)
+				+ bonus / (1.0f + visits + virtual_visits);
+
+		if (score > best_score) {
+			best_score = score;
+			best = e;
+		}
+	}
+
+	return best;
+}
+
+/**
+ * @brief One simulation from the root: a play is chosen, the dice of
+ * the opponent are rolled, and the simulation goes on in the node of the
+ * roll. A node created on the way ends it with its value, which is
+ * backed up along the path with the sign of each player.
+ *
+ * @param w the worker
+ */
+static void simulate(MctsWorker *w) {
+	MctsEdge *path[MCTS_MAX_DEPTH], *e;
+	MctsNode *node = w->mcts->root, *child;
+	MctsChance *chance;
+	unsigned depth = 0;
+	bool created;
+	float value;
+
+	for (;;) {
+		e = select_edge(w->mcts, node);
+		atomic_fetch_add(&e->virtual_visits, 1);
+		atomic_fetch_add(&node->visits, 1);
+		path[depth ++] = e;
+
+		child = NULL;
+		created = false;
+		if (!e->terminal && depth < MCTS_MAX_DEPTH && (chance = chance_get(w->mcts, node, e)))
+			child = roll_get(w->mcts, chance, roll_index(rng_die(&w->rng), rng_die(&w->rng)),
+					&created);
+
+		// Ends of the game, and children busy or out of memory, give the prior
+		if (!child) {
+			value = e->prior;
+			break;
+		}
+		if (created) {
+			value = -child->value;
+			break;
+		}
+		node = child;
+	}
+
+	while (depth --) {
+		e = path[depth];
+		atomic_fetch_add(&e->sum, (int64_t) llround(value * MCTS_ONE));
+		atomic_fetch_add(&e->visits, 1);
+		atomic_fetch_sub(&e->virtual_visits, 1);
+		value = -value;
+	}
+}
+
+/**
+ * @brief Worker of a search: simulates until the search is over.
+ *
+ * @param data the worker
+ * @return void* NULL
+ */
+static void *worker_run(void *data) {
+	MctsWorker *w = (MctsWorker *) data;
+	Mcts *mcts = w->mcts;
+	const MctsOptions *opts = mcts->opts;
+	uint64_t done = 0;
+
+	for (;;) {
+		if (opts->stop && atomic_load_explicit(opts->stop, memory_order_relaxed)) break;
+		if (atomic_load_explicit(&mcts->full, memory_order_relaxed)) break;
+		if (opts->simulations && atomic_load(&mcts->simulations) >= opts->simulations) break;
+
+		// The clock is read once every 16 simulations of the worker
+		if (mcts->deadline > 0.0 && !(done & 15) && now() >= mcts->deadline) break;
+
+		simulate(w);
+		atomic_fetch_add(&mcts->simulations, 1);
+		done ++;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Tells whether two positions are the same.
+ *
+ * @param a first position
+ * @param b second position
+ * @return bool true if they are
+ */
+static bool same_position(const Position *a, const Position *b) {
+	return a->hash == b->hash && a->turn == b->turn
+			&& !memcmp(a->points, b->points, sizeof(a->points))
+			&& !memcmp(a->bar, b->bar, sizeof(a->bar));
+}
+
+/**
+ * @brief Tells whether a node is a position with some dice.
+ *
+ * @param node the node
+ * @param pos the position
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @return bool true if it is
+ */
+static bool node_is(const MctsNode *node, const Position *pos, unsigned d0, unsigned d1) {
+	return same_position(&node->pos, pos)
+			&& roll_index(node->dice[0], node->dice[1]) == roll_index(d0, d1);
+}
+
+/**
+ * @brief Looks for a position with some dice in the subtree of a node.
+ *
+ * @param node the node
+ * @param pos the position
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param levels levels of plays to go down
+ * @return MctsNode* the node found, NULL if none
+ */
+static MctsNode *node_find(MctsNode *node, const Position *pos, unsigned d0, unsigned d1,
+		unsigned levels) {
+	MctsChance *chance;
+	MctsNode *child, *found;
+	unsigned i, r;
+
+	if (node_is(node, pos, d0, d1)) return node;
+	if (!levels) return NULL;
+
+	for (i = 0; i < node->count; i ++) {
+		chance = atomic_load(&node->edges[i].chance);
+		if (!chance || chance == MCTS_BUSY) continue;
+
+		for (r = 0; r < 21; r ++) {
+			child = atomic_load(&chance->rolls[r]);
+			if (!child || child == MCTS_BUSY) continue;
+			if ((found = node_find(child, pos, d0, d1, levels - 1))) return found;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Bytes of pool taken by a subtree.
+ *
+ * @param node root of the subtree
+ * @return size_t bytes
+ */
+static size_t node_size(const MctsNode *node) {
+	size_t size = pool_round(sizeof(MctsNode) + node->count * sizeof(MctsEdge));
+	MctsChance *chance;
+	MctsNode *child;
+	unsigned i, r;
+
+	for (i = 0; i < node->count; i ++) {
+		chance = atomic_load(&node->edges[i].chance);
+		if (!chance || chance == MCTS_BUSY) continue;
+
+		size += pool_round(sizeof(MctsChance));
+		for (r = 0; r < 21; r ++) {
+			child = atomic_load(&chance->rolls[r]);
+			if (child && child != MCTS_BUSY) size += node_size(child);
+		}
+	}
+
+	return size;
+}
+
+static MctsNode *node_copy(Mcts *mcts, const MctsNode *src, uint64_t *nodes);
+
+/**
+ * @brief Copies the visits of a play and the subtree after it to the
+ * current pool.
+ *
+ * @param mcts the tree
+ * @param s the play
+ * @param d the copy, with its play already set
+ * @param nodes count of the nodes copied, incremented
+ */
+static void edge_copy(Mcts *mcts, const MctsEdge *s, MctsEdge *d, uint64_t *nodes) {
+	MctsChance *chance, *copy;
+	MctsNode *child;
+	unsigned r;
+
+	atomic_init(&d->visits, atomic_load(&s->visits));
+	atomic_init(&d->virtual_visits, 0);
+	atomic_init(&d->sum, atomic_load(&s->sum));
+	atomic_init(&d->chance, NULL);
+
+	chance = atomic_load(&s->chance);
+	if (!chance || chance == MCTS_BUSY) return;
+
+	copy = pool_alloc(mcts, sizeof(MctsChance));
+	copy->pos = chance->pos;
+	for (r = 0; r < 21; r ++) {
+		child = atomic_load(&chance->rolls[r]);
+		if (child == MCTS_BUSY) child = NULL;
+		atomic_init(&copy->rolls[r], child ? node_copy(mcts, child, nodes) : NULL);
+	}
+	atomic_init(&d->chance, copy);
+}
+
+/**
+ * @brief Copies a subtree to the current pool, which has room for it:
+ * it came from the other pool, of the same size.
+ *
+ * @param mcts the tree
+ * @param src root of the subtree
+ * @param nodes count of the nodes copied, incremented
+ * @return MctsNode* the copy
+ */
+static MctsNode *node_copy(Mcts *mcts, const MctsNode *src, uint64_t *nodes) {
+	MctsNode *dst;
+	unsigned i;
+
+	dst = pool_alloc(mcts, sizeof(MctsNode) + src->count * sizeof(MctsEdge));
+	dst->pos = src->pos;
+	dst->dice[0] = src->dice[0];
+	dst->dice[1] = src->dice[1];
+	dst->value = src->value;
+	atomic_init(&dst->visits, atomic_load(&src->visits));
+	dst->count = src->count;
+	(*nodes) ++;
+
+	for (i = 0; i < src->count; i ++) {
+		dst->edges[i].play = src->edges[i].play;
+		dst->edges[i].prior = src->edges[i].prior;
+		dst->edges[i].terminal = src->edges[i].terminal;
+		edge_copy(mcts, &src->edges[i], &dst->edges[i], nodes);
+	}
+
+	return dst;
+}
+
+/**
+ * @brief Copies the subtree of the next root to the current pool. A node
+ * below the old root kept only its best plays, so the root is created
+ * again with all of them, and those it had bring their visits and
+ * subtrees along.
+ *
+ * @param mcts the tree
+ * @param src the node found for the next root
+ * @param nodes count of the nodes copied, incremented
+ * @return MctsNode* the root, NULL if the whole root does not fit with
+ * the subtree
+ */
+static MctsNode *root_copy(Mcts *mcts, const MctsNode *src, uint64_t *nodes) {
+	Play plays[MOVEGEN_MAX_PLAYS];
+	Position after[MCTS_MAX_EDGES], next;
+	unsigned i, j, count;
+	MctsNode *dst;
+
+	count = movegen_plays(&src->pos, src->dice[0], src->dice[1], plays);
+	if (src->count == count) return node_copy(mcts, src, nodes);
+
+	if (node_size(src) - pool_round(sizeof(MctsNode) + src->count * sizeof(MctsEdge))
+			+ pool_round(sizeof(MctsNode) + count * sizeof(MctsEdge)) > mcts->size)
+		return NULL;
+
+	dst = node_create(mcts, &src->pos, src->dice[0], src->dice[1], MOVEGEN_MAX_PLAYS);
+	atomic_store(&dst->visits, atomic_load(&src->visits));
+	(*nodes) ++;
+
+	// Plays are matched by the position they lead to
+	for (j = 0; j < src->count; j ++) {
+		after[j] = src->pos;
+		movegen_apply_position(&after[j], &src->edges[j].play);
+	}
+
+	for (i = 0; i < dst->count; i ++) {
+		next = src->pos;
+		movegen_apply_position(&next, &dst->edges[i].play);
+		for (j = 0; j < src->count && !same_position(&next, &after[j]); j ++);
+		if (j < src->count) edge_copy(mcts, &src->edges[j], &dst->edges[i], nodes);
+	}
+
+	return dst;
+}
+
+/**
+ * @brief Default settings: heuristic evaluator, money play, one thread
+ * per core, 1 second, exploration 1, seed 1.
+ *
+ * @param opts output settings
+ */
+void mcts_options_init(MctsOptions *opts) {
+	opts->evaluate = eval_heuristic;
+	opts->match = NULL;
+	opts->threads = 0;
+	opts->budget = 1.0;
+	opts->simulations = 0;
+	opts->exploration = 1.0f;
+	opts->seed = 1;
+	opts->stop = NULL;
+}
+
+/**
+ * @brief Creates an empty tree. Its memory is split in two pools: the
+ * nodes grow in one, and the subtree kept for the next search is copied
+ * to the other.
+ *
+ * @param memory bytes of both pools
+ * @return Mcts* the tree, NULL on error
+ */
+Mcts *mcts_new(size_t memory) {
+	Mcts *mcts;
+
+	// The root alone may take all the plays of a roll
+	if (memory < 2 * MOVEGEN_MAX_PLAYS * sizeof(MctsEdge) + 2 * sizeof(MctsNode)) return NULL;
+
+	mcts = malloc(sizeof(Mcts));
+	if (!mcts) return NULL;
+
+	mcts->size = memory / 2;
+	mcts->pools[0] = malloc(mcts->size);
+	mcts->pools[1] = malloc(mcts->size);
+	if (!mcts->pools[0] || !mcts->pools[1]) {
+		free(mcts->pools[0]);
+		free(mcts->pools[1]);
+		free(mcts);
+		return NULL;
+	}
+
+	mcts->current = 0;
+	atomic_init(&mcts->used, 0);
+	atomic_init(&mcts->full, false);
+	atomic_init(&mcts->simulations, 0);
+	mcts->root = NULL;
+	mcts->evaluate = NULL;
+	mcts->key = 0;
+	mcts->opts = NULL;
+
+	return mcts;
+}
+
+/**
+ * @brief Frees a tree.
+ *
+ * @param mcts the tree, may be NULL
+ */
+void mcts_free(Mcts *mcts) {
+	if (!mcts) return;
+
+	free(mcts->pools[0]);
+	free(mcts->pools[1]);
+	free(mcts);
+}
+
+/**
+ * @brief Forgets the tree.
+ *
+ * @param mcts the tree
+ */
+void mcts_clear(Mcts *mcts) {
+	mcts->root = NULL;
+	atomic_store(&mcts->used, 0);
+	atomic_store(&mcts->full, false);
+}
+
+/**
+ * @brief Searches the play of a roll. If the tree of the previous search
+ * reached the position (the same one, or one after a play and a reply),
+ * its subtree is kept and the search goes on from it.
+ *
+ * @param mcts the tree
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param opts settings
+ * @param res output result
+ */
+void mcts_search(Mcts *mcts, const Position *pos, unsigned d0, unsigned d1,
+		const MctsOptions *opts, MctsResult *res) {
+	pthread_t threads[MCTS_MAX_THREADS];
+	MctsWorker workers[MCTS_MAX_THREADS];
+	unsigned i, count = opts->threads;
+	MctsNode *root = NULL;
+	MctsEdge *e, *best;
+	double start = now();
+	long cores;
+
+	mcts->opts = opts;
+	res->reused = 0;
+
+	// Values depend on the evaluator and on the score
+	if (mcts->root && mcts->evaluate == opts->evaluate && mcts->key == met_match_key(opts->match))
+		root = node_find(mcts->root, pos, d0, d1, MCTS_REUSE_LEVELS);
+
+	if (root) {
+		// Keep the subtree: copy it to the other pool
+		mcts->current = 1 - mcts->current;
+		atomic_store(&mcts->used, 0);
+		atomic_store(&mcts->full, false);
+		mcts->root = root_copy(mcts, root, &res->reused);
+	} else mcts->root = NULL;
+
+	if (!mcts->root) {
+		mcts_clear(mcts);
+		mcts->root = node_create(mcts, pos, d0, d1, MOVEGEN_MAX_PLAYS);
+	}
+	mcts->evaluate = opts->evaluate;
+	mcts->key = met_match_key(opts->match);
+
+	atomic_store(&mcts->simulations, 0);
+	mcts->deadline = opts->budget > 0.0 ? start + opts->budget : 0.0;
+
+	if (!count) {
+		cores = sysconf(_SC_NPROCESSORS_ONLN);
+		count = cores > 0 ? (unsigned) cores : 1;
+	}
+	if (count > MCTS_MAX_THREADS) count = MCTS_MAX_THREADS;
+
+	// A single play needs no search
+	if (mcts->root->count > 1) {
+		for (i = 0; i < count; i ++) {
+			workers[i].mcts = mcts;
+			rng_seed(&workers[i].rng, opts->seed, i);
+		}
+
+		for (i = 1; i < count; i ++)
+			if (pthread_create(&threads[i], NULL, worker_run, &workers[i])) break;
+		count = i;
+
+		worker_run(&workers[0]);
+
+		for (i = 1; i < count; i ++) pthread_join(threads[i], NULL);
+	}
+
+	// The most visited play; the static value breaks ties
+	best = &mcts->root->edges[0];
+	for (i = 1; i < mcts->root->count; i ++) {
+		e = &mcts->root->edges[i];
+		if (atomic_load(&e->visits) > atomic_load(&best->visits)) best = e;
+	}
+
+	res->play = best->play;
+	res->visits = atomic_load(&best->visits);
+	res->equity = res->visits ? atomic_load(&best->sum) / MCTS_ONE / res->visits : best->prior;
+	res->plays = mcts->root->count;
+	res->simulations = atomic_load(&mcts->simulations);
+	res->seconds = now() - start;
+	res->memory = atomic_load(&mcts->used);
+	if (res->memory > mcts->size) res->memory = mcts->size;
+	res->full = atomic_load(&mcts->full);
+
+	mcts->opts = NULL;
+}
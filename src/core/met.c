@@ -0,0 +1,316 @@
+/**
+ * @file met.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/met.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/met.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Header of a table file, followed by the Met structure.
+ *
+ */
+typedef struct met_header_t {
+	char magic[4];
+	uint32_t version;
+	uint32_t max_score;
+	uint32_t cube_levels;
+	float gammon_rate;
+} MetHeader;
+
+/**
+ * @brief Level of a cube value: log2, limited to the table.
+ *
+ * @param cube value of the cube
+ * @return unsigned the level
+ */
+static unsigned cube_level(unsigned cube) {
+	unsigned level = 0;
+
+	while (cube > 1 && level < MET_CUBE_LEVELS - 1) {
+		cube >>= 1;
+		level ++;
+	}
+
+	return level;
+}
+
+/**
+ * @brief Match winning chance of a player who wins a game worth the
+ * cube value, with gammons at MET_GAMMON_RATE.
+ *
+ * @param met the table
+ * @param away points the winner needs
+ * @param opp_away points the loser needs
+ * @param cube value of the cube
+ * @return float match winning chance of the winner
+ */
+static float win_value(const Met *met, int away, int opp_away, int cube) {
+	return (1.0f - MET_GAMMON_RATE) * met_mwc(met, away - cube, opp_away)
+		+ MET_GAMMON_RATE * met_mwc(met, away - 2 * cube, opp_away);
+}
+
+/**
+ * @brief Value for the owner of the cube when the game reaches their
+ * cash point: the opponent passes, or the game is won when the owner
+ * never needs to double.
+ *
+ * @param met the table
+ * @param away points the owner needs
+ * @param opp_away points the opponent needs
+ * @param level level of the cube
+ * @return float match winning chance of the owner
+ */
+static float cash_value(const Met *met, int away, int opp_away, unsigned level) {
+	if (met->cash[level][away][opp_away] < 1.0f)
+		return met_mwc(met, away - (1 << level), opp_away);
+
+	return win_value(met, away, opp_away, 1 << level);
+}
+
+/**
+ * @brief Computes the cash point of the owner of a cube: the take point
+ * of the opponent, who takes when owning the doubled cube is worth what
+ * passing is. Needs the cash points of the doubled cube at the same score
+ * and the chances of the scores after the game.
+ *
+ * @param met the table being computed
+ * @param a points the owner needs
+ * @param b points the opponent needs
+ * @param level level of the cube
+ */
+static void compute_cash(Met *met, int a, int b, unsigned level) {
+	int cube = 1 << level;
+	float lose, top, pass, take;
+
+	// Doubling is useless when a win already takes the match
+	if (cube >= a || level + 1 >= MET_CUBE_LEVELS) {
+		met->cash[level][a][b] = 1.0f;
+		return;
+	}
+
+	// The opponent's chances with the doubled cube are linear in their
+	// win chance q, from losing it at q = 0 to their cash point
+	lose = 1.0f - win_value(met, a, b, 2 * cube);
+	top = cash_value(met, b, a, level + 1);
+	pass = met_mwc(met, b, a - cube);
+
+	take = top > lose ? met->cash[level + 1][b][a] * (pass - lose) / (top - lose) : 0.0f;
+	if (take < 0.0f) take = 0.0f;
+	if (take > 1.0f) take = 1.0f;
+
+	met->cash[level][a][b] = 1.0f - take;
+}
+
+/**
+ * @brief Match winning chance at the start of a game with the cube
+ * centered: linear between the cash points of both players.
+ *
+ * @param met the table being computed
+ * @param a points the player needs
+ * @param b points the opponent needs
+ */
+static void compute_mwc(Met *met, int a, int b) {
+	float high, low, x, y;
+
+	x = met->cash[0][a][b];
+	y = 1.0f - met->cash[0][b][a];
+	high = cash_value(met, a, b, 0);
+	low = 1.0f - cash_value(met, b, a, 0);
+
+	if (0.5f <= y) met->mwc[a][b] = low;
+	else if (0.5f >= x) met->mwc[a][b] = high;
+	else met->mwc[a][b] = low + (high - low) * (0.5f - y) / (x - y);
+}
+
+/**
+ * @brief Computes the table. The cube is fully live: players double at
+ * the opponent's take point, which in turn depends on the scores after
+ * the double.
+ *
+ * @return Met* the table, NULL if out of memory
+ */
+Met *met_new(void) {
+	Met *met = malloc(sizeof(Met));
+	int a, b, sum, level;
+
+	if (!met) return NULL;
+
+	// Every score depends only on scores with fewer points left
+	for (sum = 2; sum <= 2 * MET_MAX_SCORE; sum ++) {
+		for (a = sum - MET_MAX_SCORE > 1 ? sum - MET_MAX_SCORE : 1;
+				a <= MET_MAX_SCORE && a < sum; a ++) {
+			b = sum - a;
+			for (level = MET_CUBE_LEVELS - 1; level >= 0; level --) {
+				compute_cash(met, a, b, level);
+				compute_cash(met, b, a, level);
+			}
+		}
+		for (a = sum - MET_MAX_SCORE > 1 ? sum - MET_MAX_SCORE : 1;
+				a <= MET_MAX_SCORE && a < sum; a ++)
+			compute_mwc(met, a, sum - a);
+	}
+
+	return met;
+}
+
+/**
+ * @brief Loads the table from a file. When the file is missing or
+ * invalid the table is computed and saved to it.
+ *
+ * @param path file name, NULL to compute the table without saving it
+ * @return Met* the table, NULL if out of memory
+ */
+Met *met_open(const char *path) {
+	MetHeader header;
+	FILE *file;
+	Met *met;
+	bool ok = false;
+
+	met = malloc(sizeof(Met));
+	if (!met) return NULL;
+
+	file = path ? fopen(path, "rb") : NULL;
+	if (file) {
+		ok = fread(&header, sizeof(header), 1, file) == 1
+			&& !memcmp(header.magic, MET_MAGIC, 4) && header.version == MET_VERSION
+			&& header.max_score == MET_MAX_SCORE && header.cube_levels == MET_CUBE_LEVELS
+			&& header.gammon_rate == MET_GAMMON_RATE
+			&& fread(met, sizeof(Met), 1, file) == 1;
+		fclose(file);
+	}
+	if (ok) return met;
+
+	free(met);
+	met = met_new();
+	if (met && path) met_save(met, path);
+
+	return met;
+}
+
+/**
+ * @brief Writes the table to a file.
+ *
+ * @param met the table
+ * @param path file name
+ * @return bool false on error
+ */
+bool met_save(const Met *met, const char *path) {
+	MetHeader header;
+	FILE *file;
+	bool ok;
+
+	file = fopen(path, "wb");
+	if (!file) return false;
+
+	memcpy(header.magic, MET_MAGIC, 4);
+	header.version = MET_VERSION;
+	header.max_score = MET_MAX_SCORE;
+	header.cube_levels = MET_CUBE_LEVELS;
+	header.gammon_rate = MET_GAMMON_RATE;
+
+	ok = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(met, sizeof(Met), 1, file) == 1;
+
+	if (fclose(file)) ok = false;
+	return ok;
+}
+
+/**
+ * @brief Frees the table.
+ *
+ * @param met the table
+ */
+void met_free(Met *met) {
+	free(met);
+}
+
+/**
+ * @brief Match winning chance at the start of a game.
+ *
+ * @param met the table
+ * @param away points the player needs (0 or less: match won)
+ * @param opp_away points the opponent needs (0 or less: match lost)
+ * @return float the match winning chance
+ */
+float met_mwc(const Met *met, int away, int opp_away) {
+	if (away <= 0) return 1.0f;
+	if (opp_away <= 0) return 0.0f;
+
+	if (away > MET_MAX_SCORE) away = MET_MAX_SCORE;
+	if (opp_away > MET_MAX_SCORE) opp_away = MET_MAX_SCORE;
+
+	return met->mwc[away][opp_away];
+}
+
+/**
+ * @brief Win chance of the game at which the owner of the cube doubles
+ * the opponent out.
+ *
+ * @param met the table
+ * @param away points the owner needs
+ * @param opp_away points the opponent needs
+ * @param cube value of the cube
+ * @return float the cash point, 1 if doubling is never needed
+ */
+float met_cash_point(const Met *met, int away, int opp_away, unsigned cube) {
+	if (away <= 0 || opp_away <= 0) return 1.0f;
+
+	if (away > MET_MAX_SCORE) away = MET_MAX_SCORE;
+	if (opp_away > MET_MAX_SCORE) opp_away = MET_MAX_SCORE;
+
+	return met->cash[cube_level(cube)][away][opp_away];
+}
+
+/**
+ * @brief Match winning chance of an evaluation with a dead cube: each
+ * result of the game moves the score by its points times the cube.
+ *
+ * @param met the table
+ * @param ev evaluation, from the point of view of the player to move
+ * @param away points the player to move needs
+ * @param opp_away points the opponent needs
+ * @param cube value of the cube
+ * @return float the match winning chance
+ */
+float met_equity(const Met *met, const Eval *ev, int away, int opp_away, unsigned cube) {
+	const float *out = ev->out;
+	int c = cube;
+
+	// Backgammons are included in gammons, and gammons in wins
+	return (out[EVAL_WIN] - out[EVAL_WIN_GAMMON]) * met_mwc(met, away - c, opp_away)
+		+ (out[EVAL_WIN_GAMMON] - out[EVAL_WIN_BACKGAMMON]) * met_mwc(met, away - 2 * c, opp_away)
+		+ out[EVAL_WIN_BACKGAMMON] * met_mwc(met, away - 3 * c, opp_away)
+		+ (1.0f - out[EVAL_WIN] - out[EVAL_LOSE_GAMMON]) * met_mwc(met, away, opp_away - c)
+		+ (out[EVAL_LOSE_GAMMON] - out[EVAL_LOSE_BACKGAMMON]) * met_mwc(met, away, opp_away - 2 * c)
+		+ out[EVAL_LOSE_BACKGAMMON] * met_mwc(met, away, opp_away - 3 * c);
+}
+
+/**
+ * @brief Key of a score, mixed into the Zobrist keys of the positions
+ * cached by a search: the best plays, and so the evaluations, depend on
+ * the score.
+ *
+ * @param match the score, may be NULL
+ * @return uint64_t the key, 0 for money play
+ */
+uint64_t met_match_key(const Match *match) {
+	uint64_t key;
+
+	if (!match) return 0;
+
+	// splitmix64 finalizer of the score
+	key = match->away[0] | (uint64_t) match->away[1] << 16 | (uint64_t) match->cube << 32;
+	key += 0x9e3779b97f4a7c15ULL;
+	key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+
+	return key ^ (key >> 31);
+}
@@ -0,0 +1,515 @@
+/**
+ * @file movegen.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/movegen.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/movegen.h>
+
+#include <stdint.h>
+
+/**
+ * @brief Slots of the table of final positions used to collapse transpositions.
+ * Power of two, at least twice MOVEGEN_MAX_PLAYS.
+ */
+#define SEEN_SIZE		8192
+
+/**
+ * @brief Dice left to play: up to two distinct values and how many times
+ * each one can still be used.
+ *
+ */
+typedef struct dice_left_t {
+	unsigned value[2];
+	unsigned count[2];
+	unsigned total;
+} DiceLeft;
+
+/**
+ * @brief State of one generation: output buffer and longest play found.
+ *
+ */
+typedef struct movegen_t {
+	Play *plays;
+	unsigned count, max_len;
+	bool doubles;
+} MoveGen;
+
+/**
+ * @brief Final positions already reported, per thread. Only the used slots
+ * are cleared after each generation, so the table is never scanned.
+ */
+static _Thread_local uint64_t seen_keys[SEEN_SIZE];
+static _Thread_local uint16_t seen_slots[MOVEGEN_MAX_PLAYS];
+static _Thread_local unsigned seen_count;
+
+/**
+ * @brief Forgets every final position stored in the table.
+ */
+static void seen_clear(void) {
+	unsigned i;
+	for (i = 0; i < seen_count; i ++) seen_keys[seen_slots[i]] = 0;
+	seen_count = 0;
+}
+
+/**
+ * @brief Stores a final position in the table.
+ *
+ * @param key key of the position
+ * @return bool false if the position was already stored
+ */
+static bool seen_insert(uint64_t key) {
+	unsigned slot = (unsigned) key & (SEEN_SIZE - 1);
+
+	while (seen_keys[slot]) {
+		if (seen_keys[slot] == key) return false;
+		slot = (slot + 1) & (SEEN_SIZE - 1);
+	}
+
+	seen_keys[slot] = key;
+	seen_slots[seen_count++] = slot;
+	return true;
+}
+
+/**
+ * @brief Dice of a fresh roll.
+ *
+ * @param dice output dice
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ */
+static void dice_from_roll(DiceLeft *dice, unsigned d0, unsigned d1) {
+	dice->value[0] = d0;
+	dice->value[1] = d1;
+
+	if (d0 == d1) {
+		dice->count[0] = 4;
+		dice->count[1] = 0;
+	} else {
+		dice->count[0] = 1;
+		dice->count[1] = 1;
+	}
+	dice->total = dice->count[0] + dice->count[1];
+}
+
+/**
+ * @brief Dice of a game that were not consumed yet.
+ *
+ * @param dice output dice
+ * @param game Game instance
+ */
+static void dice_from_game(DiceLeft *dice, const Game *game) {
+	int i;
+
+	dice_from_roll(dice, game->dice[0], game->dice[1]);
+
+	for (i = 0; i < GAME_DICE_COUNT(game); i ++) {
+		if (!game->consumed_dice[i]) continue;
+		dice->count[game->dice[0] == game->dice[1] ? 0 : i] --;
+		dice->total --;
+	}
+}
+
+/**
+ * @brief Index in DiceLeft of a die value.
+ *
+ * @param dice the dice
+ * @param value value of the die
+ * @return unsigned index of the value
+ */
+static unsigned dice_index(const DiceLeft *dice, unsigned value) {
+	return dice->value[0] == value ? 0 : 1;
+}
+
+/**
+ * @brief Distance to the goal of the source of a movement, for the mover.
+ * The prison is the farthest source.
+ *
+ * @param pos the position
+ * @param m the movement
+ * @return unsigned steps from the source to the goal
+ */
+static unsigned source_pips(const Position *pos, Movement m) {
+	if (MOVEMENT_PRISON_SRC(m)) return 25;
+	return PLACE_STEPS(pos->turn, MOVEMENT_SRC(m));
+}
+
+/**
+ * @brief Searches for the single-die movements of the player to move.
+ * Each (source, die value) pair is listed once, even with doubles.
+ *
+ * @param pos the position
+ * @param dice dice left to play
+ * @param list output list, overwritten
+ * @return unsigned number of movements found
+ */
+static unsigned scan(const Position *pos, const DiceLeft *dice, MoveList *list) {
+	int i, k, dir, side, dest;
+	unsigned d, pips, last = 0;
+	bool bearing;
+
+	dir = pos->turn;
+	side = SIDE_OF(dir);
+	list->count = 0;
+
+	// Pieces in prison must enter first
+	if (pos->bar[side]) {
+		for (k = 0; k < 2; k ++) {
+			if (!dice->count[k]) continue;
+			d = dice->value[k];
+			dest = dir == -1 ? 24 - (int) d : (int) d - 1;
+
+			if (pos->points[dest] * dir >= -1)
+				list->moves[list->count++] = MOVEMENT(-1, dest, d);
+		}
+		return list->count;
+	}
+
+	// Bearing off: an overshooting die is allowed for the farthest piece only
+	bearing = pos->outside[side] == 0;
+	if (bearing) {
+		for (i = 0; i < 24; i ++)
+			if (pos->points[i] * dir > 0 && PLACE_STEPS(dir, i) > (int) last)
+				last = PLACE_STEPS(dir, i);
+	}
+
+	for (i = 0; i < 24; i ++) {
+		if (pos->points[i] * dir <= 0) continue;
+		pips = PLACE_STEPS(dir, i);
+
+		for (k = 0; k < 2; k ++) {
+			if (!dice->count[k]) continue;
+			d = dice->value[k];
+
+			if (bearing && (d == pips || (d > pips && pips == last)))
+				list->moves[list->count++] = MOVEMENT(i, -1, d);
+
+			dest = i + (int) d * dir;
+			if (dest < 0 || dest > 23) continue;
+
+			// Two or more opponent's pieces block the destination
+			if (pos->points[dest] * dir < -1) continue;
+
+			list->moves[list->count++] = MOVEMENT(i, dest, d);
+		}
+	}
+
+	return list->count;
+}
+
+/**
+ * @brief Reports a finished play. Shorter plays than the longest one found
+ * are illegal; a longer one discards everything found so far.
+ *
+ * @param mg generation state
+ * @param pos final position of the play
+ * @param play the play
+ * @param depth number of movements of the play
+ */
+static void record(MoveGen *mg, const Position *pos, const Play *play, unsigned depth) {
+	if (depth < mg->max_len) return;
+
+	if (depth > mg->max_len) {
+		seen_clear();
+		mg->count = 0;
+		mg->max_len = depth;
+	}
+
+	if (!seen_insert(pos->hash ? pos->hash : 1)) return;
+
+	mg->plays[mg->count] = *play;
+	mg->plays[mg->count].count = depth;
+	mg->count ++;
+}
+
+/**
+ * @brief Depth-first expansion of the movements of the turn, applying and
+ * reverting each movement on a single position.
+ * With doubles the movements are expanded from the farthest source to the
+ * nearest one, which reaches every final position while skipping permutations.
+ *
+ * @param mg generation state
+ * @param pos current position
+ * @param dice dice left to play
+ * @param play play being built
+ * @param depth movements already in the play
+ * @param last_pips source distance of the previous movement (doubles only)
+ */
+static void generate(MoveGen *mg, Position *pos, DiceLeft *dice, Play *play,
+		unsigned depth, unsigned last_pips) {
+	MoveList list;
+	unsigned i, k, pips = 25;
+	bool moved = false;
+	Movement m;
+	int hit;
+
+	if (dice->total) {
+		scan(pos, dice, &list);
+
+		for (i = 0; i < list.count; i ++) {
+			m = list.moves[i];
+
+			if (mg->doubles) {
+				pips = source_pips(pos, m);
+				if (pips > last_pips) continue;
+			}
+
+			k = dice_index(dice, MOVEMENT_DICE(m));
+			dice->count[k] --;
+			dice->total --;
+			hit = position_make_move(pos, m);
+			play->moves[depth] = m;
+			moved = true;
+
+			generate(mg, pos, dice, play, depth + 1, pips);
+
+			position_unmake_move(pos, m, hit);
+			dice->count[k] ++;
+			dice->total ++;
+		}
+	}
+
+	if (!moved) record(mg, pos, play, depth);
+}
+
+/**
+ * @brief Longest sequence of movements that can still be played.
+ *
+ * @param pos current position
+ * @param dice dice left to play
+ * @param depth movements already played
+ * @param limit dice available at the start
+ * @param last_pips source distance of the previous movement (doubles only)
+ * @return unsigned length of the longest sequence, counting depth
+ */
+static unsigned max_length(Position *pos, DiceLeft *dice, unsigned depth,
+		unsigned limit, unsigned last_pips) {
+	MoveList list;
+	unsigned i, k, len, best = depth, pips = 25;
+	bool doubles;
+	Movement m;
+	int hit;
+
+	if (depth == limit) return depth;
+
+	doubles = dice->value[0] == dice->value[1];
+	scan(pos, dice, &list);
+
+	for (i = 0; i < list.count; i ++) {
+		m = list.moves[i];
+
+		if (doubles) {
+			pips = source_pips(pos, m);
+			if (pips > last_pips) continue;
+		}
+
+		k = dice_index(dice, MOVEMENT_DICE(m));
+		dice->count[k] --;
+		dice->total --;
+		hit = position_make_move(pos, m);
+
+		len = max_length(pos, dice, depth + 1, limit, pips);
+
+		position_unmake_move(pos, m, hit);
+		dice->count[k] ++;
+		dice->total ++;
+
+		if (len > best) best = len;
+		if (best == limit) break;
+	}
+
+	return best;
+}
+
+/**
+ * @brief Enumerates the legal full plays for some dice left to play.
+ *
+ * @param pos the position, restored on return
+ * @param dice dice left to play, restored on return
+ * @param plays output buffer of at least MOVEGEN_MAX_PLAYS entries
+ * @return unsigned number of plays
+ */
+static unsigned plays_for(Position *pos, DiceLeft *dice, Play plays[]) {
+	MoveGen mg;
+	Play play;
+	unsigned i, n, larger;
+	bool found;
+
+	mg.plays = plays;
+	mg.count = 0;
+	mg.max_len = 0;
+	mg.doubles = dice->value[0] == dice->value[1];
+
+	generate(&mg, pos, dice, &play, 0, 25);
+	seen_clear();
+
+	// Only one die of a non-double can be used: the larger one if possible
+	if (!mg.doubles && mg.max_len == 1 && dice->total == 2) {
+		larger = dice->value[0] > dice->value[1] ? dice->value[0] : dice->value[1];
+
+		found = false;
+		for (i = 0; i < mg.count; i ++)
+			if (MOVEMENT_DICE(plays[i].moves[0]) == larger) found = true;
+
+		if (found) {
+			n = 0;
+			for (i = 0; i < mg.count; i ++)
+				if (MOVEMENT_DICE(plays[i].moves[0]) == larger) plays[n++] = plays[i];
+			mg.count = n;
+		}
+	}
+
+	return mg.count;
+}
+
+/**
+ * @brief Enumerates every legal full play for the dice of the game.
+ * A play uses as many dice as possible; when only one die of a non-double
+ * can be used, the larger one is required if it can be played.
+ * Plays reaching the same final position are reported once.
+ *
+ * @param game Game instance with the dice to play
+ * @param plays output buffer of at least MOVEGEN_MAX_PLAYS entries
+ * @return unsigned number of plays. A single empty play when no die can be used.
+ */
+unsigned movegen_generate(const Game *game, Play plays[]) {
+	Position pos;
+	DiceLeft dice;
+
+	position_from_game(&pos, game);
+	dice_from_game(&dice, game);
+
+	return plays_for(&pos, &dice, plays);
+}
+
+/**
+ * @brief Enumerates every legal full play of a roll for the player to move
+ * of a position. Same rules as movegen_generate.
+ *
+ * @param pos the position
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param plays output buffer of at least MOVEGEN_MAX_PLAYS entries
+ * @return unsigned number of plays. A single empty play when no die can be used.
+ */
+unsigned movegen_plays(const Position *pos, unsigned d0, unsigned d1, Play plays[]) {
+	Position work = *pos;
+	DiceLeft dice;
+
+	dice_from_roll(&dice, d0, d1);
+
+	return plays_for(&work, &dice, plays);
+}
+
+/**
+ * @brief Applies every movement of a play to the game.
+ *
+ * @param game Game instance
+ * @param play the play
+ */
+void movegen_apply(Game *game, const Play *play) {
+	unsigned i;
+	for (i = 0; i < play->count; i ++) game_move_piece(game, play->moves[i]);
+}
+
+/**
+ * @brief Applies every movement of a play to a position. The turn is not
+ * switched.
+ *
+ * @param pos the position
+ * @param play the play
+ */
+void movegen_apply_position(Position *pos, const Play *play) {
+	unsigned i;
+	for (i = 0; i < play->count; i ++) position_make_move(pos, play->moves[i]);
+}
+
+/**
+ * @brief Positions after each play of a roll, with the turn passed to the
+ * opponent: the children of a position in a search.
+ *
+ * @param pos the position, with the player to move on roll
+ * @param plays the plays
+ * @param count number of plays
+ * @param next output positions, one per play
+ */
+void movegen_children(const Position *pos, const Play plays[], unsigned count,
+		Position next[]) {
+	unsigned i;
+
+	for (i = 0; i < count; i ++) {
+		next[i] = *pos;
+		movegen_apply_position(&next[i], &plays[i]);
+		position_switch_turn(&next[i]);
+	}
+}
+
+/**
+ * @brief Filters the single-die movements of the game to those that begin a
+ * legal full play, so a die-by-die player obeys the same rules.
+ *
+ * @param game Game instance with the dice to play
+ * @param list output list, overwritten
+ * @return unsigned number of legal movements
+ */
+unsigned movegen_legal_movements(const Game *game, MoveList *list) {
+	MoveList all;
+	unsigned lengths[GAME_MAX_MOVEMENTS];
+	unsigned i, k, limit, best, larger;
+	bool larger_found;
+	Position pos;
+	DiceLeft dice;
+	Movement m;
+	int hit;
+
+	list->count = 0;
+
+	position_from_game(&pos, game);
+	dice_from_game(&dice, game);
+
+	limit = dice.total;
+	if (!limit) return 0;
+
+	scan(&pos, &dice, &all);
+
+	// Length of the longest play starting with each movement
+	best = 0;
+	for (i = 0; i < all.count; i ++) {
+		m = all.moves[i];
+
+		k = dice_index(&dice, MOVEMENT_DICE(m));
+		dice.count[k] --;
+		dice.total --;
+		hit = position_make_move(&pos, m);
+
+		lengths[i] = max_length(&pos, &dice, 1, limit, 25);
+
+		position_unmake_move(&pos, m, hit);
+		dice.count[k] ++;
+		dice.total ++;
+
+		if (lengths[i] > best) best = lengths[i];
+	}
+
+	// Only one die of a non-double can be used: the larger one if possible
+	larger = 0;
+	if (best == 1 && limit == 2 && dice.value[0] != dice.value[1]) {
+		larger = dice.value[0] > dice.value[1] ? dice.value[0] : dice.value[1];
+
+		larger_found = false;
+		for (i = 0; i < all.count; i ++)
+			if (MOVEMENT_DICE(all.moves[i]) == larger) larger_found = true;
+		if (!larger_found) larger = 0;
+	}
+
+	for (i = 0; i < all.count; i ++) {
+		if (lengths[i] != best) continue;
+		if (larger && MOVEMENT_DICE(all.moves[i]) != larger) continue;
+		list->moves[list->count++] = all.moves[i];
+	}
+
+	return list->count;
+}
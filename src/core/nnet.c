@@ -0,0 +1,898 @@
+/**
+ * @file nnet.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/nnet.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/nnet.h>
+#include <core/rng.h>
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+/**
+ * @brief AVX2 kernels are built for every x86 target and chosen at run
+ * time by the CPU, so one binary is fast everywhere.
+ */
+#define NNET_AVX2			1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Positions whose outputs are computed together by
+ * nnet_evaluate_batch.
+ */
+#define NNET_BLOCK			8
+
+/**
+ * @brief Most changed inputs for which nnet_evaluate_batch computes the first
+ * layer of a position from the one before it (a position has about 27
+ * active inputs).
+ */
+#define NNET_MAX_CHANGES	16
+
+/**
+ * @brief Header of a weight file.
+ *
+ */
+typedef struct nnet_header_t {
+	char magic[4];
+	uint32_t version, inputs, hidden, outputs;
+} NNetHeader;
+
+/**
+ * @brief Network used by eval_nnet.
+ */
+static _Atomic(const NNet *) current;
+
+#ifdef NNET_AVX2
+/**
+ * @brief Tells whether the CPU runs the AVX2 kernels (AVX2 and FMA).
+ *
+ * @return bool true if it does
+ */
+static bool cpu_avx2(void) {
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+/**
+ * @brief kernel_first_layer with AVX2 and FMA.
+ *
+ * @param h output pre-activations (n floats, aligned)
+ * @param w1 weights, input-major
+ * @param b1 biases
+ * @param in active inputs
+ * @param n size of the hidden layer, multiple of NNET_ALIGN
+ */
+__attribute__((target("avx2,fma")))
+static void kernel_first_layer_avx2(float *h, const float *w1, const float *b1,
+		const NNetInput *in, unsigned n) {
+	unsigned i, k;
+	const float *row;
+	__m256 a0, a1, a2, a3, v;
+
+	for (i = 0; i + 32 <= n; i += 32) {
+		a0 = _mm256_load_ps(b1 + i);
+		a1 = _mm256_load_ps(b1 + i + 8);
+		a2 = _mm256_load_ps(b1 + i + 16);
+		a3 = _mm256_load_ps(b1 + i + 24);
+		for (k = 0; k < in->count; k ++) {
+			row = w1 + (size_t) in->index[k] * n + i;
+			v = _mm256_set1_ps(in->value[k]);
+			a0 = _mm256_fmadd_ps(v, _mm256_load_ps(row), a0);
+			a1 = _mm256_fmadd_ps(v, _mm256_load_ps(row + 8), a1);
+			a2 = _mm256_fmadd_ps(v, _mm256_load_ps(row + 16), a2);
+			a3 = _mm256_fmadd_ps(v, _mm256_load_ps(row + 24), a3);
+		}
+		_mm256_store_ps(h + i, a0);
+		_mm256_store_ps(h + i + 8, a1);
+		_mm256_store_ps(h + i + 16, a2);
+		_mm256_store_ps(h + i + 24, a3);
+	}
+	for (; i < n; i += 8) {
+		a0 = _mm256_load_ps(b1 + i);
+		for (k = 0; k < in->count; k ++) {
+			row = w1 + (size_t) in->index[k] * n + i;
+			a0 = _mm256_fmadd_ps(_mm256_set1_ps(in->value[k]), _mm256_load_ps(row), a0);
+		}
+		_mm256_store_ps(h + i, a0);
+	}
+}
+
+/**
+ * @brief kernel_activate with AVX2 and FMA.
+ *
+ * @param h values, activated in place
+ * @param n number of floats
+ */
+__attribute__((target("avx2,fma")))
+static void kernel_activate_avx2(float *h, unsigned n) {
+	__m256 half = _mm256_set1_ps(0.5f), one = _mm256_set1_ps(1.0f);
+	__m256 sign = _mm256_set1_ps(-0.0f), x, ax;
+	unsigned i;
+
+	for (i = 0; i < n; i += 8) {
+		x = _mm256_load_ps(h + i);
+		ax = _mm256_andnot_ps(sign, x);
+		x = _mm256_div_ps(x, _mm256_add_ps(one, ax));
+		_mm256_store_ps(h + i, _mm256_fmadd_ps(half, x, half));
+	}
+}
+
+/**
+ * @brief kernel_dot with AVX2 and FMA.
+ *
+ * @param a first vector
+ * @param b second vector
+ * @param n number of floats
+ * @return float the dot product
+ */
+__attribute__((target("avx2,fma")))
+static float kernel_dot_avx2(const float *a, const float *b, unsigned n) {
+	__m256 acc = _mm256_setzero_ps();
+	__m128 lo;
+	unsigned i;
+
+	for (i = 0; i < n; i += 8)
+		acc = _mm256_fmadd_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i), acc);
+	lo = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+	lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+	lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+	return _mm_cvtss_f32(lo);
+}
+
+/**
+ * @brief kernel_dot4 with AVX2 and FMA.
+ *
+ * @param w the shared vector
+ * @param x four vectors of n floats, one after the other
+ * @param n number of floats of each vector
+ * @param sums output dot products (4 floats)
+ */
+__attribute__((target("avx2,fma")))
+static void kernel_dot4_avx2(const float *w, const float *x, unsigned n, float sums[]) {
+	__m256 a0 = _mm256_setzero_ps(), a1 = a0, a2 = a0, a3 = a0;
+	__m256 b0 = a0, b1 = a0, b2 = a0, b3 = a0, v;
+	unsigned i = 0;
+
+	// Two blocks per step, so eight sums are in flight
+	for (; i + 16 <= n; i += 16) {
+		v = _mm256_load_ps(w + i);
+		a0 = _mm256_fmadd_ps(v, _mm256_load_ps(x + i), a0);
+		a1 = _mm256_fmadd_ps(v, _mm256_load_ps(x + n + i), a1);
+		a2 = _mm256_fmadd_ps(v, _mm256_load_ps(x + 2 * n + i), a2);
+		a3 = _mm256_fmadd_ps(v, _mm256_load_ps(x + 3 * n + i), a3);
+		v = _mm256_load_ps(w + i + 8);
+		b0 = _mm256_fmadd_ps(v, _mm256_load_ps(x + i + 8), b0);
+		b1 = _mm256_fmadd_ps(v, _mm256_load_ps(x + n + i + 8), b1);
+		b2 = _mm256_fmadd_ps(v, _mm256_load_ps(x + 2 * n + i + 8), b2);
+		b3 = _mm256_fmadd_ps(v, _mm256_load_ps(x + 3 * n + i + 8), b3);
+	}
+	if (i < n) {
+		v = _mm256_load_ps(w + i);
+		a0 = _mm256_fmadd_ps(v, _mm256_load_ps(x + i), a0);
+		a1 = _mm256_fmadd_ps(v, _mm256_load_ps(x + n + i), a1);
+		a2 = _mm256_fmadd_ps(v, _mm256_load_ps(x + 2 * n + i), a2);
+		a3 = _mm256_fmadd_ps(v, _mm256_load_ps(x + 3 * n + i), a3);
+	}
+
+	// Horizontal sums of the four vectors at once
+	a0 = _mm256_hadd_ps(_mm256_add_ps(a0, b0), _mm256_add_ps(a1, b1));
+	a2 = _mm256_hadd_ps(_mm256_add_ps(a2, b2), _mm256_add_ps(a3, b3));
+	a0 = _mm256_hadd_ps(a0, a2);
+	_mm_storeu_ps(sums, _mm_add_ps(_mm256_castps256_ps128(a0), _mm256_extractf128_ps(a0, 1)));
+}
+#endif
+
+/**
+ * @brief First layer: h = b1 + sum of value * row of w1 for every active
+ * input. The hidden layer is walked in blocks kept in registers, so each
+ * block is stored once instead of once per input.
+ *
+ * @param h output pre-activations (n floats, aligned)
+ * @param w1 weights, input-major
+ * @param b1 biases
+ * @param in active inputs
+ * @param n size of the hidden layer, multiple of NNET_ALIGN
+ */
+static void kernel_first_layer(float *h, const float *w1, const float *b1,
+		const NNetInput *in, unsigned n) {
+	unsigned i, k;
+	const float *row;
+#ifdef NNET_AVX2
+	if (cpu_avx2()) {
+		kernel_first_layer_avx2(h, w1, b1, in, n);
+		return;
+	}
+#endif
+#if defined(__SSE2__)
+	__m128 a0, a1, a2, a3, v;
+	for (i = 0; i + 16 <= n; i += 16) {
+		a0 = _mm_load_ps(b1 + i);
+		a1 = _mm_load_ps(b1 + i + 4);
+		a2 = _mm_load_ps(b1 + i + 8);
+		a3 = _mm_load_ps(b1 + i + 12);
+		for (k = 0; k < in->count; k ++) {
+			row = w1 + (size_t) in->index[k] * n + i;
+			v = _mm_set1_ps(in->value[k]);
+			a0 = _mm_add_ps(a0, _mm_mul_ps(v, _mm_load_ps(row)));
+			a1 = _mm_add_ps(a1, _mm_mul_ps(v, _mm_load_ps(row + 4)));
+			a2 = _mm_add_ps(a2, _mm_mul_ps(v, _mm_load_ps(row + 8)));
+			a3 = _mm_add_ps(a3, _mm_mul_ps(v, _mm_load_ps(row + 12)));
+		}
+		_mm_store_ps(h + i, a0);
+		_mm_store_ps(h + i + 4, a1);
+		_mm_store_ps(h + i + 8, a2);
+		_mm_store_ps(h + i + 12, a3);
+	}
+	for (; i < n; i += 4) {
+		a0 = _mm_load_ps(b1 + i);
+		for (k = 0; k < in->count; k ++) {
+			row = w1 + (size_t) in->index[k] * n + i;
+			a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_set1_ps(in->value[k]), _mm_load_ps(row)));
+		}
+		_mm_store_ps(h + i, a0);
+	}
+#else
+	memcpy(h, b1, sizeof(float) * n);
+	for (k = 0; k < in->count; k ++) {
+		row = w1 + (size_t) in->index[k] * n;
+		for (i = 0; i < n; i ++) h[i] += in->value[k] * row[i];
+	}
+#endif
+}
+
+/**
+ * @brief Hidden activation in place: 0.5 + 0.5 * x / (1 + |x|).
+ * A sigmoid-shaped curve without exp, so it vectorizes.
+ *
+ * @param h values, activated in place
+ * @param n number of floats
+ */
+static void kernel_activate(float *h, unsigned n) {
+	unsigned i;
+#ifdef NNET_AVX2
+	if (cpu_avx2()) {
+		kernel_activate_avx2(h, n);
+		return;
+	}
+#endif
+#if defined(__SSE2__)
+	__m128 half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f);
+	__m128 sign = _mm_set1_ps(-0.0f), x, ax;
+	for (i = 0; i < n; i += 4) {
+		x = _mm_load_ps(h + i);
+		ax = _mm_andnot_ps(sign, x);
+		x = _mm_div_ps(x, _mm_add_ps(one, ax));
+		_mm_store_ps(h + i, _mm_add_ps(half, _mm_mul_ps(half, x)));
+	}
+#else
+	for (i = 0; i < n; i ++) h[i] = 0.5f + 0.5f * h[i] / (1.0f + fabsf(h[i]));
+#endif
+}
+
+/**
+ * @brief Dot product of n floats (n multiple of NNET_ALIGN, aligned).
+ *
+ * @param a first vector
+ * @param b second vector
+ * @param n number of floats
+ * @return float the dot product
+ */
+static float kernel_dot(const float *a, const float *b, unsigned n) {
+	unsigned i;
+#ifdef NNET_AVX2
+	if (cpu_avx2()) return kernel_dot_avx2(a, b, n);
+#endif
+#if defined(__SSE2__)
+	__m128 acc = _mm_setzero_ps();
+	for (i = 0; i < n; i += 4)
+		acc = _mm_add_ps(acc, _mm_mul_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+	acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+	return _mm_cvtss_f32(acc);
+#else
+	float sum = 0.0f;
+	for (i = 0; i < n; i ++) sum += a[i] * b[i];
+	return sum;
+#endif
+}
+
+/**
+ * @brief Dot products of one vector with four others (n multiple of
+ * NNET_ALIGN, aligned). The shared vector is read once for the four, and
+ * the four sums are independent, so they do not wait on each other.
+ *
+ * @param w the shared vector
+ * @param x four vectors of n floats, one after the other
+ * @param n number of floats of each vector
+ * @param sums output dot products (4 floats)
+ */
+static void kernel_dot4(const float *w, const float *x, unsigned n, float sums[]) {
+	unsigned i;
+#ifdef NNET_AVX2
+	if (cpu_avx2()) {
+		kernel_dot4_avx2(w, x, n, sums);
+		return;
+	}
+#endif
+#if defined(__SSE2__)
+	__m128 a0 = _mm_setzero_ps(), a1 = a0, a2 = a0, a3 = a0, v;
+	for (i = 0; i < n; i += 4) {
+		v = _mm_load_ps(w + i);
+		a0 = _mm_add_ps(a0, _mm_mul_ps(v, _mm_load_ps(x + i)));
+		a1 = _mm_add_ps(a1, _mm_mul_ps(v, _mm_load_ps(x + n + i)));
+		a2 = _mm_add_ps(a2, _mm_mul_ps(v, _mm_load_ps(x + 2 * n + i)));
+		a3 = _mm_add_ps(a3, _mm_mul_ps(v, _mm_load_ps(x + 3 * n + i)));
+	}
+	_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+	_mm_storeu_ps(sums, _mm_add_ps(_mm_add_ps(a0, a1), _mm_add_ps(a2, a3)));
+#else
+	sums[0] = sums[1] = sums[2] = sums[3] = 0.0f;
+	for (i = 0; i < n; i ++) {
+		sums[0] += w[i] * x[i];
+		sums[1] += w[i] * x[n + i];
+		sums[2] += w[i] * x[2 * n + i];
+		sums[3] += w[i] * x[3 * n + i];
+	}
+#endif
+}
+
+/**
+ * @brief Allocates the weights of a network.
+ *
+ * @param hidden size of the hidden layer, multiple of NNET_ALIGN
+ * @return NNet* the network with uninitialized weights, NULL if out of memory
+ */
+static NNet *nnet_alloc(unsigned hidden) {
+	NNet *net;
+	size_t row = sizeof(float) * hidden;
+
+	net = calloc(1, sizeof(NNet));
+	if (!net) return NULL;
+
+	net->hidden = hidden;
+	net->w1 = aligned_alloc(32, row * NNET_INPUTS);
+	net->b1 = aligned_alloc(32, row);
+	net->w2 = aligned_alloc(32, row * EVAL_OUTPUTS);
+	net->b2 = aligned_alloc(32, 32);
+
+	if (!net->w1 || !net->b1 || !net->w2 || !net->b2) {
+		nnet_free(net);
+		return NULL;
+	}
+
+	return net;
+}
+
+/**
+ * @brief Creates a network with small random weights.
+ *
+ * @param hidden size of the hidden layer, rounded up to NNET_ALIGN
+ * @param seed random seed
+ * @return NNet* the network, NULL if out of memory
+ */
+NNet *nnet_new(unsigned hidden, uint64_t seed) {
+	NNet *net;
+	Rng rng;
+	unsigned i;
+
+	hidden = (hidden + NNET_ALIGN - 1) / NNET_ALIGN * NNET_ALIGN;
+	if (!hidden || hidden > NNET_MAX_HIDDEN) return NULL;
+
+	net = nnet_alloc(hidden);
+	if (!net) return NULL;
+
+	rng_seed(&rng, seed, 0);
+
+	// Uniform in [-0.1, 0.1)
+	for (i = 0; i < hidden * NNET_INPUTS; i ++)
+		net->w1[i] = ((rng_next(&rng) >> 40) / 16777216.0f - 0.5f) * 0.2f;
+	for (i = 0; i < hidden * EVAL_OUTPUTS; i ++)
+		net->w2[i] = ((rng_next(&rng) >> 40) / 16777216.0f - 0.5f) * 0.2f;
+
+	memset(net->b1, 0, sizeof(float) * hidden);
+	memset(net->b2, 0, 32);
+
+	return net;
+}
+
+/**
+ * @brief Destroys a network.
+ *
+ * @param net the network
+ */
+void nnet_free(NNet *net) {
+	if (!net) return;
+	free(net->w1);
+	free(net->b1);
+	free(net->w2);
+	free(net->b2);
+	free(net);
+}
+
+/**
+ * @brief Loads a network from a weight file.
+ *
+ * @param path file name
+ * @return NNet* the network, NULL if the file is missing or invalid
+ */
+NNet *nnet_load(const char *path) {
+	NNetHeader header;
+	NNet *net;
+	FILE *file;
+	size_t h;
+	bool ok;
+
+	file = fopen(path, "rb");
+	if (!file) return NULL;
+
+	if (fread(&header, sizeof(header), 1, file) != 1 ||
+			memcmp(header.magic, NNET_MAGIC, 4) ||
+			header.version != NNET_VERSION ||
+			header.inputs != NNET_INPUTS ||
+			header.outputs != EVAL_OUTPUTS ||
+			!header.hidden || header.hidden % NNET_ALIGN ||
+			header.hidden > NNET_MAX_HIDDEN) {
+		fclose(file);
+		return NULL;
+	}
+
+	net = nnet_alloc(header.hidden);
+	if (!net) {
+		fclose(file);
+		return NULL;
+	}
+
+	h = header.hidden;
+	memset(net->b2, 0, 32);
+	ok = fread(net->w1, sizeof(float), h * NNET_INPUTS, file) == h * NNET_INPUTS &&
+		fread(net->b1, sizeof(float), h, file) == h &&
+		fread(net->w2, sizeof(float), h * EVAL_OUTPUTS, file) == h * EVAL_OUTPUTS &&
+		fread(net->b2, sizeof(float), EVAL_OUTPUTS, file) == EVAL_OUTPUTS;
+	fclose(file);
+
+	if (!ok) {
+		nnet_free(net);
+		return NULL;
+	}
+
+	return net;
+}
+
+/**
+ * @brief Saves a network to a weight file.
+ *
+ * @param net the network
+ * @param path file name
+ * @return bool false on error
+ */
+bool nnet_save(const NNet *net, const char *path) {
+	NNetHeader header;
+	FILE *file;
+	size_t h = net->hidden;
+	bool ok;
+
+	memcpy(header.magic, NNET_MAGIC, 4);
+	header.version = NNET_VERSION;
+	header.inputs = NNET_INPUTS;
+	header.hidden = net->hidden;
+	header.outputs = EVAL_OUTPUTS;
+
+	file = fopen(path, "wb");
+	if (!file) return false;
+
+	ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		fwrite(net->w1, sizeof(float), h * NNET_INPUTS, file) == h * NNET_INPUTS &&
+		fwrite(net->b1, sizeof(float), h, file) == h &&
+		fwrite(net->w2, sizeof(float), h * EVAL_OUTPUTS, file) == h * EVAL_OUTPUTS &&
+		fwrite(net->b2, sizeof(float), EVAL_OUTPUTS, file) == EVAL_OUTPUTS;
+
+	return fclose(file) == 0 && ok;
+}
+
+/**
+ * @brief Units of a place for each piece count: the values of its 4 inputs
+ * and how many of them are not 0.
+ */
+static float place_units[16][4];
+static unsigned place_active[16];
+
+/**
+ * @brief Fills the tables of place units before main runs.
+ */
+__attribute__((constructor)) static void nnet_init(void) {
+	int n, k;
+
+	for (n = 0; n < 16; n ++) {
+		for (k = 0; k < 3; k ++) place_units[n][k] = n > k ? 1.0f : 0.0f;
+		place_units[n][3] = n > 3 ? (n - 3) / 2.0f : 0.0f;
+		place_active[n] = (n < 3 ? n : 3) + (n > 3);
+	}
+}
+
+/**
+ * @brief First input of a place.
+ *
+ * @param turn player to move
+ * @param i index of the place
+ * @param player 0 for the player to move, 1 for the opponent
+ * @return unsigned index of the first of its 4 inputs
+ */
+static inline unsigned place_input(int turn, int i, int player) {
+	return player * 96 + (PLACE_STEPS(player ? -turn : turn, i) - 1) * 4;
+}
+
+/**
+ * @brief Computes the non-zero inputs of a position.
+ *
+ * @param pos the position
+ * @param in output inputs
+ */
+void nnet_encode(const Position *pos, NNetInput *in) {
+	int i, n, k, turn, player, side;
+	unsigned base, count = 0;
+
+	turn = pos->turn;
+
+	// Player 0 is the player to move, places numbered from their goal
+	for (i = 0; i < 24; i ++) {
+		n = pos->points[i] * turn;
+		if (!n) continue;
+
+		player = n < 0;
+		if (player) n = -n;
+
+		// All 4 units are written; only the non-zero ones are counted
+		base = place_input(turn, i, player);
+		for (k = 0; k < 4; k ++) {
+			in->index[count + k] = base + k;
+			in->value[count + k] = place_units[n][k];
+		}
+		count += place_active[n];
+	}
+
+	for (player = 0; player < 2; player ++) {
+		side = SIDE_OF(player ? -turn : turn);
+
+		if (pos->bar[side]) {
+			in->index[count] = 192 + player;
+			in->value[count++] = pos->bar[side] / 2.0f;
+		}
+
+		if (pos->off[side]) {
+			in->index[count] = 194 + player;
+			in->value[count++] = pos->off[side] / 15.0f;
+		}
+	}
+
+	in->count = count;
+}
+
+/**
+ * @brief Adds the change of the inputs of a place to a list of inputs.
+ *
+ * @param in the list
+ * @param turn player to move
+ * @param i index of the place
+ * @param from pieces before, negative for the opponent's
+ * @param to pieces after, negative for the opponent's
+ */
+static void encode_place_change(NNetInput *in, int turn, int i, int from, int to) {
+	unsigned base, k;
+	float value;
+
+	// A hit changes the owner: one place is left and another taken
+	if (from && to && (from < 0) != (to < 0)) {
+		encode_place_change(in, turn, i, from, 0);
+		encode_place_change(in, turn, i, 0, to);
+		return;
+	}
+
+	base = place_input(turn, i, from < 0 || to < 0);
+	for (k = 0; k < 4; k ++) {
+		value = place_units[abs(to)][k] - place_units[abs(from)][k];
+		if (value == 0.0f) continue;
+		in->index[in->count] = base + k;
+		in->value[in->count ++] = value;
+	}
+}
+
+/**
+ * @brief Computes the inputs that change from one position to another, with
+ * the change of their values. Positions after the plays of one roll differ
+ * in a few places.
+ *
+ * @param from the first position
+ * @param to the second position
+ * @param in output changes
+ * @return bool false if the positions have different players to move
+ */
+static bool encode_change(const Position *from, const Position *to, NNetInput *in) {
+	int i, turn = to->turn, player, side;
+
+	if (from->turn != turn) return false;
+
+	in->count = 0;
+	for (i = 0; i < 24; i ++) {
+		if (from->points[i] != to->points[i])
+			encode_place_change(in, turn, i, from->points[i] * turn, to->points[i] * turn);
+	}
+
+	for (player = 0; player < 2; player ++) {
+		side = SIDE_OF(player ? -turn : turn);
+
+		if (from->bar[side] != to->bar[side]) {
+			in->index[in->count] = 192 + player;
+			in->value[in->count ++] = (to->bar[side] - from->bar[side]) / 2.0f;
+		}
+
+		if (from->off[side] != to->off[side]) {
+			in->index[in->count] = 194 + player;
+			in->value[in->count ++] = (to->off[side] - from->off[side]) / 15.0f;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Activates the hidden layer in place and computes the outputs.
+ *
+ * @param net the network
+ * @param hidden pre-activations of the hidden layer, activated in place
+ * @param out output values (EVAL_OUTPUTS floats)
+ */
+static void output_layer(const NNet *net, float hidden[], float out[]) {
+	unsigned i, h = net->hidden;
+
+	kernel_activate(hidden, h);
+
+	for (i = 0; i < EVAL_OUTPUTS; i ++)
+		out[i] = 1.0f / (1.0f + expf(-(kernel_dot(net->w2 + i * h, hidden, h) + net->b2[i])));
+}
+
+/**
+ * @brief Makes raw outputs consistent: gammons never exceed wins, nor
+ * backgammons gammons.
+ *
+ * @param o the outputs
+ */
+static void make_consistent(float o[]) {
+	if (o[EVAL_WIN_GAMMON] > o[EVAL_WIN]) o[EVAL_WIN_GAMMON] = o[EVAL_WIN];
+	if (o[EVAL_WIN_BACKGAMMON] > o[EVAL_WIN_GAMMON]) o[EVAL_WIN_BACKGAMMON] = o[EVAL_WIN_GAMMON];
+	if (o[EVAL_LOSE_GAMMON] > 1.0f - o[EVAL_WIN]) o[EVAL_LOSE_GAMMON] = 1.0f - o[EVAL_WIN];
+	if (o[EVAL_LOSE_BACKGAMMON] > o[EVAL_LOSE_GAMMON]) o[EVAL_LOSE_BACKGAMMON] = o[EVAL_LOSE_GAMMON];
+}
+
+/**
+ * @brief Activates the hidden layers of a block of positions in place and
+ * computes their outputs, made consistent. Each row of w2 is read once for
+ * every four positions.
+ *
+ * @param net the network
+ * @param hidden pre-activations of the hidden layers, one after the other
+ * @param count number of positions, at most NNET_BLOCK
+ * @param out output values of each position (EVAL_OUTPUTS floats)
+ */
+static void output_block(const NNet *net, float hidden[], unsigned count, float *out[]) {
+	float sums[NNET_BLOCK];
+	unsigned i, k, h = net->hidden;
+
+	kernel_activate(hidden, count * h);
+
+	for (i = 0; i < EVAL_OUTPUTS; i ++) {
+		for (k = 0; k + 4 <= count; k += 4) kernel_dot4(net->w2 + i * h, hidden + k * h, h, sums + k);
+		for (; k < count; k ++) sums[k] = kernel_dot(net->w2 + i * h, hidden + k * h, h);
+
+		for (k = 0; k < count; k ++) out[k][i] = 1.0f / (1.0f + expf(-(sums[k] + net->b2[i])));
+	}
+
+	for (k = 0; k < count; k ++) make_consistent(out[k]);
+}
+
+/**
+ * @brief Forward pass. Outputs are the raw sigmoids, not made consistent.
+ *
+ * @param net the network
+ * @param in inputs of the position
+ * @param hidden output activations of the hidden layer (net->hidden floats,
+ * aligned to 32 bytes)
+ * @param out output values (EVAL_OUTPUTS floats)
+ */
+void nnet_forward(const NNet *net, const NNetInput *in, float hidden[], float out[]) {
+	// First layer: bias plus the rows of the active inputs
+	kernel_first_layer(hidden, net->w1, net->b1, in, net->hidden);
+	output_layer(net, hidden, out);
+}
+
+/**
+ * @brief Derivative of the hidden activation, from its output value.
+ *
+ * @param h output of the activation
+ * @return float derivative
+ */
+float nnet_activation_derivative(float h) {
+	float s = 1.0f - fabsf(2.0f * h - 1.0f);
+	return 0.5f * s * s;
+}
+
+/**
+ * @brief One gradient step of the squared error towards a target, for a
+ * single position. Several threads may train the same network at once
+ * (Hogwild): the updates are not synchronized and some may be lost.
+ *
+ * @param net the network
+ * @param in inputs of the position
+ * @param target target outputs (EVAL_OUTPUTS floats)
+ * @param rate learning rate
+ * @return float squared error of the outputs before the step
+ */
+float nnet_train(NNet *net, const NNetInput *in, const float target[], float rate) {
+	_Alignas(32) float hidden[NNET_MAX_HIDDEN], delta[NNET_MAX_HIDDEN];
+	float out[EVAL_OUTPUTS], grad[EVAL_OUTPUTS];
+	float error = 0.0f, *row;
+	unsigned h = net->hidden, i, j, k;
+
+	nnet_forward(net, in, hidden, out);
+
+	// Output layer: sigmoid derivative times the error
+	for (i = 0; i < EVAL_OUTPUTS; i ++) {
+		error += (target[i] - out[i]) * (target[i] - out[i]);
+		grad[i] = rate * (target[i] - out[i]) * out[i] * (1.0f - out[i]);
+	}
+
+	// Hidden layer deltas, with the output weights before the step
+	for (j = 0; j < h; j ++) {
+		delta[j] = 0.0f;
+		for (i = 0; i < EVAL_OUTPUTS; i ++) delta[j] += grad[i] * net->w2[i * h + j];
+		delta[j] *= nnet_activation_derivative(hidden[j]);
+	}
+
+	for (i = 0; i < EVAL_OUTPUTS; i ++) {
+		row = net->w2 + i * h;
+		for (j = 0; j < h; j ++) row[j] += grad[i] * hidden[j];
+		net->b2[i] += grad[i];
+	}
+
+	// First layer: only the rows of the active inputs change
+	for (k = 0; k < in->count; k ++) {
+		row = net->w1 + (size_t) in->index[k] * h;
+		for (j = 0; j < h; j ++) row[j] += delta[j] * in->value[k];
+	}
+	for (j = 0; j < h; j ++) net->b1[j] += delta[j];
+
+	return error;
+}
+
+/**
+ * @brief Evaluates a position with a network.
+ * The outputs are made consistent: gammons never exceed wins.
+ *
+ * @param net the network
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ */
+void nnet_evaluate(const NNet *net, const Position *pos, Eval *ev) {
+	_Alignas(32) float hidden[NNET_MAX_HIDDEN];
+	NNetInput in;
+	float *o = ev->out;
+
+	if (position_winner(pos)) {
+		eval_terminal(pos, ev);
+		return;
+	}
+
+	nnet_encode(pos, &in);
+	nnet_forward(net, &in, hidden, o);
+	make_consistent(o);
+}
+
+/**
+ * @brief Evaluates positions with a network in one call. Each position
+ * starts from the first layer of the one before it and adds the rows of
+ * the inputs that differ, which are few when the positions come from the
+ * plays of one roll; unrelated positions are computed in full. The outputs
+ * are computed by blocks of NNET_BLOCK positions.
+ *
+ * @param net the network
+ * @param positions the positions
+ * @param count number of positions
+ * @param evals output evaluations, from the point of view of the player
+ * to move of each position
+ */
+void nnet_evaluate_batch(const NNet *net, const Position positions[], unsigned count,
+		Eval evals[]) {
+	_Alignas(32) float base[NNET_MAX_HIDDEN], hidden[NNET_BLOCK * NNET_MAX_HIDDEN];
+	float *out[NNET_BLOCK];
+	const Position *prev = NULL;
+	NNetInput in;
+	unsigned i, n = 0, h = net->hidden;
+
+	for (i = 0; i < count; i ++) {
+		if (position_winner(&positions[i])) {
+			eval_terminal(&positions[i], &evals[i]);
+			continue;
+		}
+
+		if (prev && encode_change(prev, &positions[i], &in) && in.count <= NNET_MAX_CHANGES) {
+			kernel_first_layer(base, net->w1, base, &in, h);
+		} else {
+			nnet_encode(&positions[i], &in);
+			kernel_first_layer(base, net->w1, net->b1, &in, h);
+		}
+		prev = &positions[i];
+
+		memcpy(hidden + n * h, base, sizeof(float) * h);
+		out[n ++] = evals[i].out;
+
+		if (n == NNET_BLOCK) {
+			output_block(net, hidden, n, out);
+			n = 0;
+		}
+	}
+
+	if (n) output_block(net, hidden, n, out);
+}
+
+/**
+ * @brief Sets the network used by eval_nnet. The network must not be freed
+ * or modified while searches use it.
+ *
+ * @param net the network, NULL to fall back to eval_heuristic
+ */
+void nnet_set_current(const NNet *net) {
+	atomic_store(&current, net);
+}
+
+/**
+ * @brief Evaluator that uses the current network (see nnet_set_current),
+ * or the current bearoff databases when both players are bearing off.
+ *
+ * @param pos the position
+ * @param ev output evaluation, from the point of view of the player to move
+ */
+void eval_nnet(const Position *pos, Eval *ev) {
+	const NNet *net = atomic_load_explicit(&current, memory_order_acquire);
+
+	if (eval_exact(pos, ev)) return;
+
+	if (net) nnet_evaluate(net, pos, ev);
+	else eval_heuristic(pos, ev);
+}
+
+/**
+ * @brief Batch version of eval_nnet: positions covered by the bearoff
+ * databases are read from them, and each run of the others is evaluated
+ * with nnet_evaluate_batch.
+ *
+ * @param positions the positions
+ * @param count number of positions
+ * @param evals output evaluations, from the point of view of the player
+ * to move of each position
+ */
+void eval_nnet_batch(const Position positions[], unsigned count, Eval evals[]) {
+	const NNet *net = atomic_load_explicit(&current, memory_order_acquire);
+	unsigned i, j;
+
+	if (!net) {
+		for (i = 0; i < count; i ++) eval_heuristic(&positions[i], &evals[i]);
+		return;
+	}
+
+	for (i = 0; i < count; i = j + 1) {
+		for (j = i; j < count && !eval_exact(&positions[j], &evals[j]); j ++);
+
+		// Positions i to j - 1 need the network; j, if any, is done
+		if (j > i) nnet_evaluate_batch(net, positions + i, j - i, evals + i);
+	}
+}
@@ -0,0 +1,160 @@
+/**
+ * @file ponder.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/ponder.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/ponder.h>
+
+#include <stdlib.h>
+
+/**
+ * @brief The 21 distinct rolls, the likeliest (non-doubles) first.
+ */
+static const unsigned char rolls[21][2] = {
+	{2, 1}, {3, 1}, {4, 1}, {5, 1}, {6, 1}, {3, 2}, {4, 2}, {5, 2},
+	{6, 2}, {4, 3}, {5, 3}, {6, 3}, {5, 4}, {6, 4}, {6, 5},
+	{1, 1}, {2, 2}, {3, 3}, {4, 4}, {5, 5}, {6, 6}
+};
+
+/**
+ * @brief Ranks the replies of each roll with the static evaluation and
+ * lists the positions after them: the best reply of every roll, then the
+ * second ones, and so on.
+ *
+ * @param ponder the ponder
+ * @return bool false if stopped meanwhile
+ */
+static bool list_replies(Ponder *ponder) {
+	Play plays[21][PONDER_PLAYS];
+	Eval evals[PONDER_PLAYS];
+	unsigned counts[21], count, r, k;
+	SearchOptions rank = ponder->opts;
+	Position next;
+
+	rank.depth = 1;
+	count = ponder->dice[0] ? 1 : 21;
+
+	for (r = 0; r < count; r ++) {
+		if (ponder->dice[0])
+			counts[r] = search_rank_plays(&ponder->pos, ponder->dice[0], ponder->dice[1],
+					&rank, plays[r], evals, PONDER_PLAYS);
+		else
+			counts[r] = search_rank_plays(&ponder->pos, rolls[r][0], rolls[r][1],
+					&rank, plays[r], evals, PONDER_PLAYS);
+
+		if (atomic_load(&ponder->stop)) return false;
+	}
+
+	for (k = 0; k < PONDER_PLAYS; k ++) {
+		for (r = 0; r < count; r ++) {
+			if (k >= counts[r]) continue;
+
+			next = ponder->pos;
+			movegen_apply_position(&next, &plays[r][k]);
+			position_switch_turn(&next);
+			ponder->replies[ponder->count ++] = next;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Worker thread: evaluates the position after each reply with the
+ * depth of the engine, which leaves in the cache what its search will ask.
+ *
+ * @param data the ponder
+ * @return void* NULL
+ */
+static void *worker(void *data) {
+	Ponder *ponder = (Ponder *) data;
+	unsigned i;
+	Eval ev;
+
+	if (!list_replies(ponder)) return NULL;
+
+	for (i = 0; i < ponder->count && !atomic_load(&ponder->stop); i ++) {
+		atomic_fetch_add(&ponder->nodes,
+				search_evaluate(&ponder->replies[i], ponder->opts.depth, &ponder->opts, &ev));
+
+		if (!atomic_load(&ponder->stop)) atomic_fetch_add(&ponder->done, 1);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Starts pondering a position on a background thread.
+ *
+ * @param pos the position, with the player to move (the one that thinks
+ * now) before or after the roll
+ * @param d0 value of the first die, 0 if the dice are not rolled yet
+ * @param d1 value of the second die, 0 if the dice are not rolled yet
+ * @param opts settings of the engine that answers: depth, evaluator,
+ * cache (required), match and threads
+ * @return Ponder* the ponder, NULL on error
+ */
+Ponder *ponder_start(const Position *pos, unsigned d0, unsigned d1,
+		const SearchOptions *opts) {
+	Ponder *ponder;
+
+	if (!opts->cache || position_winner(pos)) return NULL;
+
+	ponder = malloc(sizeof(Ponder));
+	if (!ponder) return NULL;
+
+	ponder->pos = *pos;
+	ponder->dice[0] = d0;
+	ponder->dice[1] = d1;
+	ponder->count = 0;
+
+	// Own copies of the settings: the caller's may go away
+	ponder->opts = *opts;
+	if (!ponder->opts.depth) ponder->opts.depth = 1;
+	if (opts->match) {
+		ponder->match = *opts->match;
+		ponder->opts.match = &ponder->match;
+	}
+	ponder->opts.stop = &ponder->stop;
+	ponder->opts.deadline = 0.0;
+
+	atomic_init(&ponder->stop, false);
+	atomic_init(&ponder->done, 0);
+	atomic_init(&ponder->nodes, 0);
+
+	if (pthread_create(&ponder->thread, NULL, worker, ponder)) {
+		free(ponder);
+		return NULL;
+	}
+
+	return ponder;
+}
+
+/**
+ * @brief Number of replies analyzed so far.
+ *
+ * @param ponder the ponder
+ * @return unsigned replies done
+ */
+unsigned ponder_done(Ponder *ponder) {
+	return atomic_load(&ponder->done);
+}
+
+/**
+ * @brief Stops the ponder as soon as possible and frees it. Returns
+ * when its threads are finished.
+ *
+ * @param ponder the ponder, may be NULL
+ */
+void ponder_free(Ponder *ponder) {
+	if (!ponder) return;
+
+	atomic_store(&ponder->stop, true);
+	pthread_join(ponder->thread, NULL);
+
+	free(ponder);
+}
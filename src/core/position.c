@@ -0,0 +1,214 @@
+/**
+ * @file position.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/position.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/position.h>
+#include <core/zobrist.h>
+
+#include <string.h>
+
+_Static_assert(sizeof(Position) <= 64, "Position must fit in a cache line");
+
+/**
+ * @brief Builds the position of a game. The player to move is game->direction.
+ *
+ * @param pos output position
+ * @param game Game instance
+ */
+void position_from_game(Position *pos, const Game *game) {
+	int i, dir;
+
+	memset(pos, 0, sizeof(Position));
+
+	for (i = 0; i < 24; i ++) pos->points[i] = game->places[i];
+
+	for (dir = -1; dir <= 1; dir += 2) {
+		pos->bar[SIDE_OF(dir)] = game->prison[PRISON_OF(dir)] * dir;
+		pos->off[SIDE_OF(dir)] = game->goal[GOAL_OF(dir)] * dir;
+		pos->steps[SIDE_OF(dir)] = game->steps[SIDE_OF(dir)];
+		pos->outside[SIDE_OF(dir)] = game->outside[SIDE_OF(dir)];
+	}
+
+	pos->turn = game->direction;
+	pos->hash = game_hash(game);
+}
+
+/**
+ * @brief Writes the pieces and the player to move of a position into a game.
+ * The dice of the game are not modified.
+ *
+ * @param pos the position
+ * @param game Game instance
+ */
+void position_to_game(const Position *pos, Game *game) {
+	int i, dir;
+
+	for (i = 0; i < 24; i ++) game->places[i] = pos->points[i];
+
+	for (dir = -1; dir <= 1; dir += 2) {
+		game->prison[PRISON_OF(dir)] = pos->bar[SIDE_OF(dir)] * dir;
+		game->goal[GOAL_OF(dir)] = pos->off[SIDE_OF(dir)] * dir;
+		game->steps[SIDE_OF(dir)] = pos->steps[SIDE_OF(dir)];
+		game->outside[SIDE_OF(dir)] = pos->outside[SIDE_OF(dir)];
+	}
+
+	game->direction = pos->turn;
+	game->hash = pos->turn == 1 ? pos->hash ^ zobrist_turn : pos->hash;
+}
+
+/**
+ * @brief Applies a single movement of the player to move.
+ * The movement must be legal; no checks are done.
+ *
+ * @param pos the position
+ * @param m the movement
+ * @return int 1 if an opponent's piece was sent to prison, 0 otherwise.
+ * Must be passed back to position_unmake_move.
+ */
+int position_make_move(Position *pos, Movement m) {
+	int dir, side, src, dest;
+
+	dir = pos->turn;
+	side = SIDE_OF(dir);
+
+	// Remove from source
+	if (MOVEMENT_PRISON_SRC(m)) {
+		pos->hash ^= zobrist_bar[side][pos->bar[side]] ^ zobrist_bar[side][pos->bar[side] - 1];
+		pos->bar[side] --;
+		pos->steps[side] -= 24;
+		pos->outside[side] --;
+	} else {
+		src = MOVEMENT_SRC(m);
+		pos->hash ^= ZOBRIST_POINT(src, pos->points[src]) ^ ZOBRIST_POINT(src, pos->points[src] - dir);
+		pos->points[src] -= dir;
+		pos->steps[side] -= PLACE_STEPS(dir, src);
+		pos->outside[side] -= PLACE_OUTSIDE(dir, src);
+	}
+
+	// Bear off
+	if (MOVEMENT_GOAL_DEST(m)) {
+		pos->hash ^= zobrist_off[side][pos->off[side]] ^ zobrist_off[side][pos->off[side] + 1];
+		pos->off[side] ++;
+		return 0;
+	}
+
+	dest = MOVEMENT_DEST(m);
+	pos->steps[side] += PLACE_STEPS(dir, dest);
+	pos->outside[side] += PLACE_OUTSIDE(dir, dest);
+
+	// Single opponent's piece: send it to prison
+	if (pos->points[dest] * dir < 0) {
+		pos->hash ^= ZOBRIST_POINT(dest, -dir) ^ ZOBRIST_POINT(dest, dir);
+		pos->hash ^= zobrist_bar[!side][pos->bar[!side]] ^ zobrist_bar[!side][pos->bar[!side] + 1];
+		pos->points[dest] = dir;
+		pos->bar[!side] ++;
+		pos->steps[!side] += 24 - PLACE_STEPS(-dir, dest);
+		pos->outside[!side] += 1 - PLACE_OUTSIDE(-dir, dest);
+		return 1;
+	}
+
+	pos->hash ^= ZOBRIST_POINT(dest, pos->points[dest]) ^ ZOBRIST_POINT(dest, pos->points[dest] + dir);
+	pos->points[dest] += dir;
+	return 0;
+}
+
+/**
+ * @brief Reverts a movement applied by position_make_move.
+ *
+ * @param pos the position
+ * @param m the movement
+ * @param hit value returned by position_make_move
+ */
+void position_unmake_move(Position *pos, Movement m, int hit) {
+	int dir, side, src, dest;
+
+	dir = pos->turn;
+	side = SIDE_OF(dir);
+
+	if (MOVEMENT_GOAL_DEST(m)) {
+		pos->hash ^= zobrist_off[side][pos->off[side]] ^ zobrist_off[side][pos->off[side] - 1];
+		pos->off[side] --;
+	} else {
+		dest = MOVEMENT_DEST(m);
+		pos->steps[side] -= PLACE_STEPS(dir, dest);
+		pos->outside[side] -= PLACE_OUTSIDE(dir, dest);
+
+		if (hit) {
+			pos->hash ^= ZOBRIST_POINT(dest, dir) ^ ZOBRIST_POINT(dest, -dir);
+			pos->hash ^= zobrist_bar[!side][pos->bar[!side]] ^ zobrist_bar[!side][pos->bar[!side] - 1];
+			pos->points[dest] = -dir;
+			pos->bar[!side] --;
+			pos->steps[!side] -= 24 - PLACE_STEPS(-dir, dest);
+			pos->outside[!side] -= 1 - PLACE_OUTSIDE(-dir, dest);
+		} else {
+			pos->hash ^= ZOBRIST_POINT(dest, pos->points[dest]) ^ ZOBRIST_POINT(dest, pos->points[dest] - dir);
+			pos->points[dest] -= dir;
+		}
+	}
+
+	if (MOVEMENT_PRISON_SRC(m)) {
+		pos->hash ^= zobrist_bar[side][pos->bar[side]] ^ zobrist_bar[side][pos->bar[side] + 1];
+		pos->bar[side] ++;
+		pos->steps[side] += 24;
+		pos->outside[side] ++;
+	} else {
+		src = MOVEMENT_SRC(m);
+		pos->hash ^= ZOBRIST_POINT(src, pos->points[src]) ^ ZOBRIST_POINT(src, pos->points[src] + dir);
+		pos->points[src] += dir;
+		pos->steps[side] += PLACE_STEPS(dir, src);
+		pos->outside[side] += PLACE_OUTSIDE(dir, src);
+	}
+}
+
+/**
+ * @brief Passes the turn to the opponent.
+ *
+ * @param pos the position
+ */
+void position_switch_turn(Position *pos) {
+	pos->turn = -pos->turn;
+	pos->hash ^= zobrist_turn;
+}
+
+/**
+ * @brief Returns the direction of the player who bore off all 15 pieces.
+ *
+ * @param pos the position
+ * @return int direction of the winner, 0 while the game is in progress
+ */
+int position_winner(const Position *pos) {
+	if (pos->off[SIDE_OF(-1)] == 15) return -1;
+	if (pos->off[SIDE_OF(1)] == 15) return 1;
+	return 0;
+}
+
+/**
+ * @brief Points earned by the winner: 1, 2 (gammon) or 3 (backgammon).
+ *
+ * @param pos the position
+ * @param win_dir direction of the winner
+ * @return unsigned the points earned by the winner
+ */
+unsigned position_winner_points(const Position *pos, int win_dir) {
+	int i, start, loser;
+
+	loser = SIDE_OF(-win_dir);
+
+	// Check Gammon
+	if (pos->off[loser]) return 1;
+
+	// Check backgammon
+	if (pos->bar[loser]) return 3;
+
+	start = win_dir == -1 ? 0 : 18;
+	for (i = start; i < start + 6; i ++) {
+		if (pos->points[i] * win_dir < 0) return 3;
+	}
+
+	return 2;
+}
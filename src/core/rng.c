@@ -0,0 +1,89 @@
+/**
+ * @file rng.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/rng.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/rng.h>
+
+/**
+ * @brief splitmix64 step, used to spread seeds and streams.
+ *
+ * @param x input
+ * @return uint64_t mixed value
+ */
+static uint64_t mix(uint64_t x) {
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+/**
+ * @brief Rotates the bits of a word to the left.
+ *
+ * @param x the word
+ * @param k bits to rotate, 1 to 63
+ * @return uint64_t rotated word
+ */
+static inline uint64_t rotl(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Seeds a generator. Different streams of the same seed give
+ * unrelated sequences.
+ *
+ * @param rng the generator
+ * @param seed seed
+ * @param stream stream number, for example the thread index
+ */
+void rng_seed(Rng *rng, uint64_t seed, uint64_t stream) {
+	uint64_t x = mix(seed) ^ stream;
+	unsigned i;
+
+	// splitmix64 fills the state; it is never all 0
+	for (i = 0; i < 4; i ++) {
+		rng->s[i] = mix(x);
+		x += 0x9E3779B97F4A7C15ULL;
+	}
+}
+
+/**
+ * @brief Next 64 random bits.
+ *
+ * @param rng the generator
+ * @return uint64_t random number
+ */
+uint64_t rng_next(Rng *rng) {
+	uint64_t *s = rng->s, r = rotl(s[1] * 5, 7) * 9, t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+
+	return r;
+}
+
+/**
+ * @brief Rolls a die. The 6 values have exactly the same chance.
+ *
+ * @param rng the generator
+ * @return unsigned value between 1 and 6
+ */
+unsigned rng_die(Rng *rng) {
+	uint64_t m;
+
+	// Multiply-shift of 32 bits, rejecting the 4 low products that would
+	// favour some values (2^32 mod 6 = 4)
+	do m = (rng_next(rng) >> 32) * 6;
+	while ((uint32_t) m < 4);
+
+	return (unsigned) (m >> 32) + 1;
+}
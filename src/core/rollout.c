@@ -0,0 +1,425 @@
+/**
+ * @file rollout.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/rollout.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/rollout.h>
+#include <core/rng.h>
+#include <core/search.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Chooses the best play of a roll and measures the luck of the
+ * roll: its equity minus the mean equity of the best plays of the 36
+ * rolls, for the player to move.
+ *
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param opts settings of the search
+ * @param res output result of the roll
+ * @return float luck of the roll
+ */
+static float roll_luck(const Position *pos, unsigned d0, unsigned d1,
+		const SearchOptions *opts, SearchResult *res) {
+	SearchResult r;
+	unsigned a, b, lo = d0 < d1 ? d0 : d1, hi = d0 < d1 ? d1 : d0;
+	float mean = 0.0f;
+
+	for (a = 1; a <= 6; a ++) {
+		for (b = a; b <= 6; b ++) {
+			search_best_play(pos, a, b, opts, &r);
+			mean += (a == b ? 1.0f : 2.0f) * r.equity;
+			if (a == lo && b == hi) *res = r;
+		}
+	}
+
+	return res->equity - mean / 36.0f;
+}
+
+/**
+ * @brief Plays a game to the end from a candidate position.
+ *
+ * @param start the candidate
+ * @param opts settings of the rollout
+ * @param game number of the game among those of the candidate
+ * @param rng random generator of the thread
+ * @param ev output outcome, from the point of view of the candidate's
+ * player to move
+ * @param luck output luck of the candidate's player, 0 when not measured
+ * @param stratum output index of the first roll
+ * @return float points won (negative when lost)
+ */
+static float play_trial(const Position *start, const RolloutOptions *opts, uint64_t game,
+		Rng *rng, Eval *ev, float *luck, unsigned *stratum) {
+	SearchOptions search;
+	SearchResult res;
+	Position pos = *start;
+	unsigned d0, d1, points, ply, r;
+	int winner;
+
+	search_options_init(&search);
+	search.evaluate = opts->evaluate;
+	*luck = 0.0f;
+	*stratum = 0;
+
+	for (ply = 0; !(winner = position_winner(&pos)); ply ++) {
+		// Stratified: game k rolls first k % 36 and second (k % 36 + k / 36)
+		// % 36, a Latin square, so every 36 games hold all the first rolls
+		// and all the second rolls, and each first roll meets a new second
+		// roll in each of its games of a block
+		if (opts->stratify && ply < 2) {
+			r = (unsigned) (game % ROLLOUT_STRATA);
+			if (ply) r = (unsigned) ((r + game / ROLLOUT_STRATA) % ROLLOUT_STRATA);
+			d0 = r / 6 + 1;
+			d1 = r % 6 + 1;
+		} else {
+			d0 = rng_die(rng);
+			d1 = rng_die(rng);
+		}
+		if (!ply) *stratum = (d0 - 1) * 6 + d1 - 1;
+
+		// Luck of the roll, for the candidate's player
+		if (opts->luck) {
+			if (pos.turn == start->turn) *luck += roll_luck(&pos, d0, d1, &search, &res);
+			else *luck -= roll_luck(&pos, d0, d1, &search, &res);
+		} else search_best_play(&pos, d0, d1, &search, &res);
+
+		movegen_apply_position(&pos, &res.play);
+		position_switch_turn(&pos);
+	}
+
+	// Outcome seen from the candidate's player
+	pos.turn = start->turn;
+	eval_terminal(&pos, ev);
+
+	points = position_winner_points(&pos, winner);
+	return winner == start->turn ? (float) points : -(float) points;
+}
+
+/**
+ * @brief Results of one candidate from its sums.
+ * The equity is the mean over the strata (the first rolls when they are
+ * stratified, else all the games as one) of their mean points, minus
+ * beta times their mean luck, whose expectation is 0. beta is fitted by
+ * least squares within the strata, so it is 0 without luck, and the error
+ * comes from the residuals. Until every first roll has 2 games, the
+ * games are taken as one stratum.
+ *
+ * @param sums sums of the candidate
+ * @param stratify whether the first rolls are stratified
+ * @param res output results
+ */
+static void sums_result(const RolloutSums *sums, bool stratify, RolloutResult *res) {
+	RolloutStratum all;
+	const RolloutStratum *strata = sums->strata, *st;
+	double n, p, var, syy = 0.0, syl = 0.0, sll = 0.0, beta, dof, sum = 0.0, inv = 0.0;
+	unsigned i, count = ROLLOUT_STRATA;
+
+	memset(res, 0, sizeof(RolloutResult));
+	res->trials = sums->trials;
+	if (!sums->trials) return;
+
+	n = (double) sums->trials;
+
+	// Every output is a 0/1 outcome: binomial standard error
+	for (i = 0; i < EVAL_OUTPUTS; i ++) {
+		p = sums->out[i] / n;
+		res->eval.out[i] = (float) p;
+		res->std_error.out[i] = (float) sqrt(p * (1.0 - p) / n);
+	}
+
+	memset(&all, 0, sizeof(RolloutStratum));
+	for (i = 0; i < ROLLOUT_STRATA; i ++) {
+		st = &sums->strata[i];
+		all.games += st->games;
+		all.points += st->points;
+		all.points2 += st->points2;
+		all.luck += st->luck;
+		all.luck2 += st->luck2;
+		all.points_luck += st->points_luck;
+		if (st->games < 2.0) stratify = false;
+	}
+
+	// What the same games would give by plain simulation
+	var = n > 1.0 ? (all.points2 - all.points * all.points / n) / (n - 1.0) : 0.0;
+	res->plain_error = (float) (var > 0.0 ? sqrt(var / n) : 0.0);
+
+	if (!stratify) {
+		strata = &all;
+		count = 1;
+	}
+
+	// Sums of squares and products within the strata
+	for (i = 0; i < count; i ++) {
+		st = &strata[i];
+		syy += st->points2 - st->points * st->points / st->games;
+		syl += st->points_luck - st->points * st->luck / st->games;
+		sll += st->luck2 - st->luck * st->luck / st->games;
+	}
+
+	beta = sll > 1e-9 ? syl / sll : 0.0;
+	dof = n - count - (beta != 0.0 ? 1.0 : 0.0);
+	var = dof > 0.0 ? (syy - beta * syl) / dof : 0.0;
+
+	for (i = 0; i < count; i ++) {
+		st = &strata[i];
+		sum += (st->points - beta * st->luck) / st->games;
+		inv += 1.0 / st->games;
+	}
+
+	res->equity = (float) (sum / count);
+	res->equity_error = (float) (var > 0.0 ? sqrt(var * inv) / count : 0.0);
+}
+
+/**
+ * @brief Checks if every candidate has reached the precision. Called
+ * with the lock held. A stratified candidate is checked once it has a
+ * whole block of games, before which its second rolls are not balanced.
+ * An error of 0 only counts when all the games ended with the same points.
+ *
+ * @param rollout the rollout
+ * @return bool true when precise enough
+ */
+static bool rollout_precise(const Rollout *rollout) {
+	RolloutResult res;
+	unsigned c, least = rollout->opts.stratify ? ROLLOUT_BLOCK : 2 * ROLLOUT_STRATA;
+
+	for (c = 0; c < rollout->count; c ++) {
+		if (rollout->sums[c].trials < least) return false;
+
+		sums_result(&rollout->sums[c], rollout->opts.stratify, &res);
+		if (res.equity_error > rollout->opts.precision) return false;
+		if (res.equity_error <= 0.0f && res.plain_error > 0.0f) return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Worker thread: plays games until the trials are done or the
+ * rollout is stopped.
+ *
+ * @param data the rollout
+ * @return void* NULL
+ */
+static void *worker(void *data) {
+	Rollout *rollout = (Rollout *) data;
+	RolloutSums *sums;
+	uint64_t trial, total;
+	RolloutStratum *st;
+	unsigned c, stratum;
+	float points, luck;
+	Eval ev;
+	Rng rng;
+	int i;
+
+	// Own random stream
+	rng_seed(&rng, rollout->opts.seed, atomic_fetch_add(&rollout->streams, 1));
+
+	total = (uint64_t) rollout->opts.trials * rollout->count;
+
+	while (!atomic_load_explicit(&rollout->stop, memory_order_relaxed)) {
+		trial = atomic_fetch_add(&rollout->next, 1);
+		if (total && trial >= total) break;
+
+		c = trial % rollout->count;
+		points = play_trial(&rollout->candidates[c], &rollout->opts, trial / rollout->count,
+				&rng, &ev, &luck, &stratum);
+
+		pthread_mutex_lock(&rollout->lock);
+		sums = &rollout->sums[c];
+		sums->trials ++;
+		for (i = 0; i < EVAL_OUTPUTS; i ++) sums->out[i] += ev.out[i];
+		st = &sums->strata[stratum];
+		st->games += 1.0;
+		st->points += points;
+		st->points2 += points * points;
+		st->luck += luck;
+		st->luck2 += luck * luck;
+		st->points_luck += points * luck;
+
+		// Precise enough: the others stop after their game
+		if (rollout->opts.precision > 0.0f && rollout_precise(rollout))
+			atomic_store(&rollout->stop, true);
+		pthread_mutex_unlock(&rollout->lock);
+	}
+
+	atomic_fetch_sub(&rollout->running, 1);
+	return NULL;
+}
+
+/**
+ * @brief Default settings: 1296 games per candidate, one thread per core,
+ * heuristic evaluator, seed 1, stratified first rolls, no luck
+ * adjustment, no precision.
+ *
+ * @param opts output settings
+ */
+void rollout_options_init(RolloutOptions *opts) {
+	opts->trials = 1296;
+	opts->threads = 0;
+	opts->evaluate = eval_heuristic;
+	opts->seed = 1;
+	opts->stratify = true;
+	opts->luck = false;
+	opts->precision = 0.0f;
+}
+
+/**
+ * @brief Starts rolling out candidate positions in background threads.
+ * Each candidate is a position before the roll of its player to move.
+ *
+ * @param candidates positions to roll out, copied
+ * @param count number of candidates
+ * @param opts settings
+ * @return Rollout* the running rollout, NULL on error
+ */
+Rollout *rollout_start(const Position candidates[], unsigned count,
+		const RolloutOptions *opts) {
+	Rollout *rollout;
+	unsigned i, threads;
+	long cores;
+
+	if (!count) return NULL;
+
+	threads = opts->threads;
+	if (!threads) {
+		cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (unsigned) cores : 1;
+	}
+
+	rollout = calloc(1, sizeof(Rollout));
+	if (!rollout) return NULL;
+
+	rollout->candidates = malloc(sizeof(Position) * count);
+	rollout->sums = calloc(count, sizeof(RolloutSums));
+	rollout->threads = malloc(sizeof(pthread_t) * threads);
+	if (!rollout->candidates || !rollout->sums || !rollout->threads) {
+		free(rollout->candidates);
+		free(rollout->sums);
+		free(rollout->threads);
+		free(rollout);
+		return NULL;
+	}
+
+	memcpy(rollout->candidates, candidates, sizeof(Position) * count);
+	rollout->count = count;
+	rollout->opts = *opts;
+
+	pthread_mutex_init(&rollout->lock, NULL);
+	atomic_init(&rollout->next, 0);
+	atomic_init(&rollout->stop, false);
+	atomic_init(&rollout->running, threads);
+	atomic_init(&rollout->streams, 0);
+
+	for (i = 0; i < threads; i ++) {
+		if (pthread_create(&rollout->threads[i], NULL, worker, rollout)) {
+			atomic_fetch_sub(&rollout->running, threads - i);
+			break;
+		}
+	}
+	rollout->thread_count = i;
+
+	if (!i) {
+		rollout_free(rollout);
+		return NULL;
+	}
+
+	return rollout;
+}
+
+/**
+ * @brief Reads the results so far. Can be called while the rollout runs.
+ *
+ * @param rollout the rollout
+ * @param results output array, one entry per candidate
+ */
+void rollout_results(Rollout *rollout, RolloutResult results[]) {
+	RolloutSums sums;
+	unsigned c;
+
+	for (c = 0; c < rollout->count; c ++) {
+		pthread_mutex_lock(&rollout->lock);
+		sums = rollout->sums[c];
+		pthread_mutex_unlock(&rollout->lock);
+
+		sums_result(&sums, rollout->opts.stratify, &results[c]);
+	}
+}
+
+/**
+ * @brief Checks if every worker has finished.
+ *
+ * @param rollout the rollout
+ * @return bool true when done or stopped
+ */
+bool rollout_done(Rollout *rollout) {
+	return atomic_load(&rollout->running) == 0;
+}
+
+/**
+ * @brief Asks the workers to stop after their current game.
+ *
+ * @param rollout the rollout
+ */
+void rollout_stop(Rollout *rollout) {
+	atomic_store(&rollout->stop, true);
+}
+
+/**
+ * @brief Stops the rollout, waits for the workers and frees it.
+ *
+ * @param rollout the rollout
+ */
+void rollout_free(Rollout *rollout) {
+	unsigned i;
+
+	if (!rollout) return;
+
+	rollout_stop(rollout);
+	for (i = 0; i < rollout->thread_count; i ++) pthread_join(rollout->threads[i], NULL);
+
+	pthread_mutex_destroy(&rollout->lock);
+	free(rollout->candidates);
+	free(rollout->sums);
+	free(rollout->threads);
+	free(rollout);
+}
+
+/**
+ * @brief Rolls out candidates and waits for the results.
+ *
+ * @param candidates positions to roll out
+ * @param count number of candidates
+ * @param opts settings (trials or precision must be set)
+ * @param results output array, one entry per candidate
+ * @return bool false on error
+ */
+bool rollout_run(const Position candidates[], unsigned count,
+		const RolloutOptions *opts, RolloutResult results[]) {
+	Rollout *rollout;
+	unsigned i;
+
+	if (!opts->trials && opts->precision <= 0.0f) return false;
+
+	rollout = rollout_start(candidates, count, opts);
+	if (!rollout) return false;
+
+	// Workers stop by themselves when the trials are done
+	for (i = 0; i < rollout->thread_count; i ++) pthread_join(rollout->threads[i], NULL);
+	rollout->thread_count = 0;
+
+	rollout_results(rollout, results);
+	rollout_free(rollout);
+
+	return true;
+}
@@ -0,0 +1,698 @@
+/**
+ * @file search.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/search.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/search.h>
+#include <core/book.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief State of one search (of one thread). The plays of each ply and
+ * the children of the last one live in memory taken once per search, not
+ * on the stack of the thread. Cache counters are kept here and added to
+ * the cache when the search ends.
+ *
+ */
+typedef struct search_t {
+	const SearchOptions *opts;
+	uint64_t key;
+	uint64_t nodes, checked;
+	bool aborted;
+	CacheStats counts;
+	Play *plays;
+	Eval *evals;
+	Position *next;
+} Search;
+
+/**
+ * @brief Children of the root shared by the threads of a search: the
+ * positions after the plays of a roll, or the 21 rolls of a position.
+ * Threads take the next child until none is left.
+ *
+ */
+typedef struct parallel_t {
+	const SearchOptions *opts;
+	const Position *pos;
+	const Play *plays;
+	unsigned count;
+	unsigned depth;
+	Eval *evals;
+	_Atomic unsigned next;
+	_Atomic uint64_t nodes;
+	atomic_bool aborted;
+} Parallel;
+
+/**
+ * @brief The 21 distinct rolls, doubles first.
+ */
+static const unsigned char rolls[21][2] = {
+	{1, 1}, {2, 2}, {3, 3}, {4, 4}, {5, 5}, {6, 6},
+	{1, 2}, {1, 3}, {1, 4}, {1, 5}, {1, 6}, {2, 3}, {2, 4},
+	{2, 5}, {2, 6}, {3, 4}, {3, 5}, {3, 6}, {4, 5}, {4, 6}, {5, 6}
+};
+
+static void evaluate(Search *s, const Position *pos, unsigned depth, Eval *ev);
+
+/**
+ * @brief Equity of an evaluation for the player to move: cubeless, or
+ * the match winning chance at the score of the match.
+ *
+ * @param s search state
+ * @param pos the position, with the player the evaluation belongs to on turn
+ * @param ev the evaluation
+ * @return float the equity
+ */
+static float equity_of(const Search *s, const Position *pos, const Eval *ev) {
+	const Match *match = s->opts->match;
+	int side = SIDE_OF(pos->turn);
+
+	if (!match) return eval_equity(ev);
+
+	return met_equity(match->met, ev, match->away[side], match->away[1 - side], match->cube);
+}
+
+/**
+ * @brief Monotonic clock in seconds.
+ *
+ * @return double seconds
+ */
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Starts the state of a search, with the memory of best_play for
+ * some plies. Running out of memory stops the search.
+ *
+ * @param s output search state
+ * @param opts settings
+ * @param depth plies of best_play, 0 for none
+ */
+static void search_init(Search *s, const SearchOptions *opts, unsigned depth) {
+	s->opts = opts;
+	s->key = met_match_key(opts->match);
+	s->nodes = 0;
+	s->checked = 0;
+	s->aborted = false;
+	memset(&s->counts, 0, sizeof(CacheStats));
+	s->plays = NULL;
+	s->evals = NULL;
+	s->next = NULL;
+
+	if (!depth) return;
+
+	s->plays = malloc(sizeof(Play) * MOVEGEN_MAX_PLAYS * depth);
+	s->evals = malloc(sizeof(Eval) * MOVEGEN_MAX_PLAYS);
+	s->next = malloc(sizeof(Position) * MOVEGEN_MAX_PLAYS);
+	if (!s->plays || !s->evals || !s->next) s->aborted = true;
+}
+
+/**
+ * @brief Ends a search: adds its counters to the cache and frees its
+ * memory.
+ *
+ * @param s search state
+ */
+static void search_done(Search *s) {
+	if (s->opts->cache) cache_add_stats(s->opts->cache, &s->counts);
+
+	free(s->plays);
+	free(s->evals);
+	free(s->next);
+}
+
+/**
+ * @brief Looks for an evaluation in the cache of the search, if any.
+ *
+ * @param s search state
+ * @param pos the position
+ * @param depth minimum depth of the evaluation
+ * @param ev output evaluation, written on hit
+ * @return bool true on hit
+ */
+static bool search_lookup(Search *s, const Position *pos, unsigned depth, Eval *ev) {
+	Cache *cache = s->opts->cache;
+
+	if (!cache) return false;
+
+	s->counts.lookups ++;
+	if (!cache_lookup(cache, pos->hash ^ s->key, depth, ev)) return false;
+
+	s->counts.hits ++;
+	return true;
+}
+
+/**
+ * @brief Stores an evaluation in the cache of the search, if any.
+ *
+ * @param s search state
+ * @param pos the position
+ * @param depth depth of the evaluation
+ * @param ev the evaluation
+ */
+static void search_store(Search *s, const Position *pos, unsigned depth, const Eval *ev) {
+	Cache *cache = s->opts->cache;
+
+	if (cache && cache_store(cache, pos->hash ^ s->key, depth, ev)) s->counts.stores ++;
+}
+
+/**
+ * @brief Tells whether the search must stop: it was asked to, or its
+ * deadline passed (the clock is read before the first node, then once
+ * every 64 nodes or more). Once true, it stays true.
+ *
+ * @param s search state
+ * @return bool true to stop
+ */
+static bool stopped(Search *s) {
+	if (s->aborted) return true;
+
+	if (s->opts->stop && atomic_load_explicit(s->opts->stop, memory_order_relaxed))
+		s->aborted = true;
+	else if (s->opts->deadline > 0.0 && (!s->nodes || s->nodes - s->checked >= 64)) {
+		s->checked = s->nodes;
+		if (now() >= s->opts->deadline) s->aborted = true;
+	}
+
+	return s->aborted;
+}
+
+/**
+ * @brief Static evaluations of the positions after the plays of a roll,
+ * in one batch of the evaluator.
+ *
+ * @param s search state
+ * @param pos the position, with the player to move on roll
+ * @param plays the plays
+ * @param count number of plays
+ * @param evals output evaluations, from the point of view of the player
+ * to move
+ */
+static void evaluate_plays(Search *s, const Position *pos, const Play plays[],
+		unsigned count, Eval evals[]) {
+	unsigned i;
+
+	movegen_children(pos, plays, count, s->next);
+	eval_batch(s->opts->evaluate, s->next, count, evals);
+
+	for (i = 0; i < count; i ++) eval_invert(&evals[i]);
+	s->nodes += count;
+}
+
+/**
+ * @brief Finds the best play of a roll for the player to move.
+ *
+ * @param s search state
+ * @param pos the position
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param depth plies, at least 1
+ * @param best output best play, may be NULL
+ * @param ev output evaluation of the best play, from the point of view of
+ * the player to move; if the search stops first, the static evaluation of
+ * the first play
+ * @return unsigned number of plays considered
+ */
+static unsigned best_play(Search *s, const Position *pos, unsigned d0, unsigned d1,
+		unsigned depth, Play *best, Eval *ev) {
+	Play *plays = s->plays + (size_t) (depth - 1) * MOVEGEN_MAX_PLAYS;
+	Eval *evals = s->evals;
+	Position next;
+	Eval e;
+	unsigned i, n, count, best_i = 0;
+	float equity, best_equity = -4.0f;
+
+	n = movegen_plays(pos, d0, d1, plays);
+
+	// Last ply: the static evaluations of all the plays at once
+	if (depth == 1) {
+		count = stopped(s) ? 1 : n;
+
+		evaluate_plays(s, pos, plays, count, evals);
+		for (i = 0; i < count; i ++) {
+			equity = equity_of(s, pos, &evals[i]);
+			if (equity > best_equity) {
+				best_equity = equity;
+				best_i = i;
+			}
+		}
+
+		if (best) *best = plays[best_i];
+		*ev = evals[best_i];
+		return n;
+	}
+
+	for (i = 0; i < n && !stopped(s); i ++) {
+		next = *pos;
+		movegen_apply_position(&next, &plays[i]);
+		position_switch_turn(&next);
+
+		evaluate(s, &next, depth - 1, &e);
+		eval_invert(&e);
+
+		equity = equity_of(s, pos, &e);
+		if (equity > best_equity) {
+			best_equity = equity;
+			best_i = i;
+			*ev = e;
+		}
+	}
+
+	// Stopped before the first play
+	if (!i) {
+		evaluate_plays(s, pos, plays, 1, evals);
+		*ev = evals[0];
+	}
+
+	if (best) *best = plays[best_i];
+	return n;
+}
+
+/**
+ * @brief Evaluates a position before the roll of the player to move.
+ *
+ * @param s search state
+ * @param pos the position
+ * @param depth plies to look ahead
+ * @param ev output evaluation, from the point of view of the player to move
+ */
+static void evaluate(Search *s, const Position *pos, unsigned depth, Eval *ev) {
+	Eval e;
+	unsigned r, i;
+	float weight;
+
+	s->nodes ++;
+
+	if (position_winner(pos)) {
+		eval_terminal(pos, ev);
+		return;
+	}
+
+	if (depth == 0) {
+		s->opts->evaluate(pos, ev);
+		return;
+	}
+
+	if (search_lookup(s, pos, depth, ev)) return;
+
+	for (i = 0; i < EVAL_OUTPUTS; i ++) ev->out[i] = 0.0f;
+
+	// 21 distinct rolls: doubles weigh 1/36, the others 2/36
+	for (r = 0; r < 21; r ++) {
+		weight = r < 6 ? 1.0f / 36.0f : 2.0f / 36.0f;
+		best_play(s, pos, rolls[r][0], rolls[r][1], depth, NULL, &e);
+
+		for (i = 0; i < EVAL_OUTPUTS; i ++) ev->out[i] += weight * e.out[i];
+	}
+
+	// A stopped search leaves partial averages
+	if (!s->aborted) search_store(s, pos, depth, ev);
+}
+
+/**
+ * @brief Worker of a parallel search: evaluates children until none
+ * is left.
+ *
+ * @param data the shared state
+ * @return void* NULL
+ */
+static void *parallel_worker(void *data) {
+	Parallel *p = (Parallel *) data;
+	Position next;
+	Search s;
+	unsigned i;
+
+	search_init(&s, p->opts, p->depth);
+
+	while (!stopped(&s) && (i = atomic_fetch_add(&p->next, 1)) < p->count) {
+		if (p->plays) {
+			next = *p->pos;
+			movegen_apply_position(&next, &p->plays[i]);
+			position_switch_turn(&next);
+
+			evaluate(&s, &next, p->depth, &p->evals[i]);
+			eval_invert(&p->evals[i]);
+		} else best_play(&s, p->pos, rolls[i][0], rolls[i][1], p->depth, NULL, &p->evals[i]);
+	}
+
+	atomic_fetch_add(&p->nodes, s.nodes);
+	if (s.aborted) atomic_store(&p->aborted, true);
+	search_done(&s);
+
+	return NULL;
+}
+
+/**
+ * @brief Evaluates the children of the root on the threads of the search;
+ * the calling thread is one of them.
+ *
+ * @param p the shared state
+ * @return uint64_t number of nodes visited
+ */
+static uint64_t parallel_run(Parallel *p) {
+	pthread_t threads[SEARCH_MAX_THREADS];
+	unsigned i, count = p->opts->threads;
+	long cores;
+	Search s;
+
+	// Static evaluations of plays: one batch, threads would not pay off
+	if (p->plays && p->depth == 0) {
+		search_init(&s, p->opts, 1);
+		if (!stopped(&s)) evaluate_plays(&s, p->pos, p->plays, p->count, p->evals);
+
+		atomic_init(&p->nodes, s.nodes);
+		atomic_init(&p->aborted, s.aborted);
+		search_done(&s);
+		return s.nodes;
+	}
+
+	if (!count) {
+		cores = sysconf(_SC_NPROCESSORS_ONLN);
+		count = cores > 0 ? (unsigned) cores : 1;
+	}
+	if (count > p->count) count = p->count;
+	if (count > SEARCH_MAX_THREADS) count = SEARCH_MAX_THREADS;
+
+	atomic_init(&p->next, 0);
+	atomic_init(&p->nodes, 0);
+	atomic_init(&p->aborted, false);
+
+	for (i = 1; i < count; i ++)
+		if (pthread_create(&threads[i], NULL, parallel_worker, p)) break;
+	count = i;
+
+	parallel_worker(p);
+
+	for (i = 1; i < count; i ++) pthread_join(threads[i], NULL);
+
+	return atomic_load(&p->nodes);
+}
+
+/**
+ * @brief Default settings: depth 1, heuristic evaluator, no cache,
+ * money play, one thread, never stopped, no deadline.
+ *
+ * @param opts output settings
+ */
+void search_options_init(SearchOptions *opts) {
+	opts->depth = 1;
+	opts->evaluate = eval_heuristic;
+	opts->cache = NULL;
+	opts->match = NULL;
+	opts->threads = 1;
+	opts->stop = NULL;
+	opts->deadline = 0.0;
+}
+
+/**
+ * @brief Chooses the play with the highest equity for a roll.
+ * When the search is stopped the result is the first play.
+ *
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param opts settings
+ * @param res output result: best play, its evaluation from the point of view
+ * of the player to move, number of plays, nodes and elapsed time
+ */
+void search_best_play(const Position *pos, unsigned d0, unsigned d1,
+		const SearchOptions *opts, SearchResult *res) {
+	Play plays[MOVEGEN_MAX_PLAYS];
+	Eval evals[MOVEGEN_MAX_PLAYS];
+	Parallel p;
+	Search s;
+	unsigned i, best_i = 0;
+	float equity, best_equity = -4.0f;
+	double start;
+
+	search_init(&s, opts, 0);
+
+	start = now();
+
+	p.opts = opts;
+	p.pos = pos;
+	p.plays = plays;
+	p.count = movegen_plays(pos, d0, d1, plays);
+	p.depth = opts->depth ? opts->depth - 1 : 0;
+	p.evals = evals;
+	res->nodes = parallel_run(&p);
+
+	res->stopped = atomic_load(&p.aborted);
+	if (res->stopped) {
+		for (i = 0; i < EVAL_OUTPUTS; i ++) evals[0].out[i] = 0.0f;
+	} else {
+		for (i = 0; i < p.count; i ++) {
+			equity = equity_of(&s, pos, &evals[i]);
+			if (equity > best_equity) {
+				best_equity = equity;
+				best_i = i;
+			}
+		}
+	}
+
+	res->seconds = now() - start;
+
+	res->play = plays[best_i];
+	res->eval = evals[best_i];
+	res->plays = p.count;
+	res->book = false;
+	res->depth = opts->depth ? opts->depth : 1;
+	res->equity = equity_of(&s, pos, &res->eval);
+}
+
+/**
+ * @brief Evaluates every play of a roll and keeps the best ones, sorted
+ * by equity, best first.
+ *
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param opts settings
+ * @param plays output best plays
+ * @param evals output evaluations of the plays, from the point of view of
+ * the player to move
+ * @param max capacity of plays and evals
+ * @return unsigned number of plays stored, 0 if the search was stopped
+ */
+unsigned search_rank_plays(const Position *pos, unsigned d0, unsigned d1,
+		const SearchOptions *opts, Play plays[], Eval evals[], unsigned max) {
+	Play all[MOVEGEN_MAX_PLAYS];
+	Eval all_evals[MOVEGEN_MAX_PLAYS];
+	Parallel p;
+	Search s;
+	unsigned i, j, count = 0;
+	float equity;
+
+	if (!max) return 0;
+
+	search_init(&s, opts, 0);
+
+	p.opts = opts;
+	p.pos = pos;
+	p.plays = all;
+	p.count = movegen_plays(pos, d0, d1, all);
+	p.depth = opts->depth ? opts->depth - 1 : 0;
+	p.evals = all_evals;
+	parallel_run(&p);
+
+	if (atomic_load(&p.aborted)) return 0;
+
+	for (i = 0; i < p.count; i ++) {
+		equity = equity_of(&s, pos, &all_evals[i]);
+
+		// Insert in order, dropping the worst one when full
+		if (count == max && equity <= equity_of(&s, pos, &evals[max - 1])) continue;
+		if (count < max) count ++;
+
+		for (j = count - 1; j > 0 && equity_of(&s, pos, &evals[j - 1]) < equity; j --) {
+			plays[j] = plays[j - 1];
+			evals[j] = evals[j - 1];
+		}
+		plays[j] = all[i];
+		evals[j] = all_evals[i];
+	}
+
+	return count;
+}
+
+/**
+ * @brief Evaluates a position before the roll of the player to move.
+ * depth 0 is the static evaluation; depth n averages over the 21 rolls
+ * the best play found with a search of depth n.
+ *
+ * @param pos the position
+ * @param depth plies to look ahead
+ * @param opts settings (opts->depth is ignored)
+ * @param ev output evaluation, from the point of view of the player to move
+ * @return uint64_t number of nodes visited
+ */
+uint64_t search_evaluate(const Position *pos, unsigned depth,
+		const SearchOptions *opts, Eval *ev) {
+	Eval evals[21];
+	Parallel p;
+	Search s;
+	uint64_t nodes;
+	unsigned r, i;
+	float weight;
+
+	search_init(&s, opts, 0);
+
+	if (depth == 0 || position_winner(pos)) {
+		evaluate(&s, pos, depth, ev);
+		search_done(&s);
+		return s.nodes;
+	}
+
+	if (search_lookup(&s, pos, depth, ev)) {
+		search_done(&s);
+		return 1;
+	}
+
+	// The 21 rolls of the root are shared by the threads
+	p.opts = opts;
+	p.pos = pos;
+	p.plays = NULL;
+	p.count = 21;
+	p.depth = depth;
+	p.evals = evals;
+	nodes = parallel_run(&p) + 1;
+
+	for (i = 0; i < EVAL_OUTPUTS; i ++) ev->out[i] = 0.0f;
+	if (!atomic_load(&p.aborted)) {
+		for (r = 0; r < 21; r ++) {
+			weight = r < 6 ? 1.0f / 36.0f : 2.0f / 36.0f;
+			for (i = 0; i < EVAL_OUTPUTS; i ++) ev->out[i] += weight * evals[r].out[i];
+		}
+
+		search_store(&s, pos, depth, ev);
+	}
+
+	search_done(&s);
+	return nodes;
+}
+
+/**
+ * @brief Takes the play of a roll from the current opening book: the one
+ * with the highest equity, or match winning chance, among its rolled
+ * out candidates.
+ *
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param opts settings
+ * @param res output result
+ * @return bool false if the roll is not in the book
+ */
+static bool book_play(const Position *pos, unsigned d0, unsigned d1,
+		const SearchOptions *opts, SearchResult *res) {
+	Play plays[BOOK_MAX_CANDIDATES];
+	Eval evals[BOOK_MAX_CANDIDATES];
+	Search s;
+	unsigned i, n;
+	float equity;
+
+	n = book_plays(book_current(), pos, d0, d1, plays, evals, BOOK_MAX_CANDIDATES);
+	if (!n) return false;
+
+	search_init(&s, opts, 0);
+
+	res->equity = -4.0f;
+	for (i = 0; i < n; i ++) {
+		equity = equity_of(&s, pos, &evals[i]);
+		if (equity > res->equity) {
+			res->equity = equity;
+			res->play = plays[i];
+			res->eval = evals[i];
+		}
+	}
+
+	res->plays = n;
+	res->depth = opts->depth ? opts->depth : 1;
+	res->nodes = 0;
+	res->stopped = false;
+	res->book = true;
+
+	return true;
+}
+
+/**
+ * @brief Iterative deepening: searches the roll with depth 1, 2, ... up
+ * to opts->depth while the time budget lasts, and keeps the result of
+ * the deepest search that completed. Depth 1 always completes.
+ * Rolls found in the current opening book are answered from it at once.
+ *
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param opts settings: opts->depth is the deepest search
+ * @param budget seconds, 0 for no limit
+ * @param res output result; depth is the depth reached, nodes and seconds
+ * add up every iteration
+ */
+void search_iterate(const Position *pos, unsigned d0, unsigned d1,
+		const SearchOptions *opts, double budget, SearchResult *res) {
+	SearchOptions iter = *opts;
+	SearchResult next;
+	unsigned depth, max = opts->depth ? opts->depth : 1;
+	uint64_t nodes;
+	double start = now();
+
+	if (book_play(pos, d0, d1, opts, res)) {
+		res->seconds = now() - start;
+		return;
+	}
+
+	iter.depth = 1;
+	iter.deadline = 0.0;
+	search_best_play(pos, d0, d1, &iter, res);
+	nodes = res->nodes;
+
+	iter.deadline = budget > 0.0 ? start + budget : 0.0;
+
+	// A forced play needs no deeper search
+	for (depth = 2; depth <= max && !res->stopped && res->plays > 1; depth ++) {
+		iter.depth = depth;
+		search_best_play(pos, d0, d1, &iter, &next);
+		nodes += next.nodes;
+
+		if (next.stopped) break;
+		*res = next;
+	}
+
+	res->nodes = nodes;
+	res->seconds = now() - start;
+}
+
+/**
+ * @brief Monotonic clock used by the deadlines of the searches.
+ *
+ * @return double seconds
+ */
+double search_clock(void) {
+	return now();
+}
+
+/**
+ * @brief Tells whether searches with some settings are stopped: asked
+ * to stop, or past their deadline.
+ *
+ * @param opts settings
+ * @return bool true if stopped
+ */
+bool search_stopped(const SearchOptions *opts) {
+	if (opts->stop && atomic_load(opts->stop)) return true;
+
+	return opts->deadline > 0.0 && now() >= opts->deadline;
+}
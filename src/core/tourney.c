@@ -0,0 +1,378 @@
+/**
+ * @file tourney.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/tourney.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/tourney.h>
+#include <core/cache.h>
+#include <core/cube.h>
+#include <core/game.h>
+#include <core/mcts.h>
+#include <core/rng.h>
+#include <core/search.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief An engine as played by one thread: its settings, its own cache
+ * and, for MCTS, its own tree.
+ *
+ */
+typedef struct tourney_player_t {
+	const TourneyEngine *engine;
+	Cache *cache;
+	Mcts *mcts;
+} TourneyPlayer;
+
+/**
+ * @brief State shared by the threads of a tournament. Threads take the
+ * next match until none is left.
+ *
+ */
+typedef struct tourney_t {
+	const TourneyOptions *opts;
+	TourneyResult *res;
+	pthread_mutex_t lock;
+	_Atomic unsigned next;
+	bool failed;
+} Tourney;
+
+/**
+ * @brief State of the match being played.
+ *
+ */
+typedef struct tourney_match_t {
+	const TourneyOptions *opts;
+	TourneyPlayer *players;
+	unsigned score[2];
+	Rng rng;
+} TourneyMatch;
+
+/**
+ * @brief Index of the engine that moves in a direction.
+ *
+ * @param dir the direction
+ * @return unsigned 0 or 1
+ */
+static unsigned engine_of(int dir) {
+	return dir == -1 ? 0 : 1;
+}
+
+/**
+ * @brief Score of the match, for the searches.
+ *
+ * @param m the match
+ * @param cube value of the cube
+ * @param match output score
+ * @return const Match* match, NULL for money equity
+ */
+static const Match *match_score(const TourneyMatch *m, unsigned cube, Match *match) {
+	if (!m->opts->met) return NULL;
+
+	match->met = m->opts->met;
+	match->cube = cube;
+	match->away[SIDE_OF(-1)] = m->opts->length - m->score[0];
+	match->away[SIDE_OF(1)] = m->opts->length - m->score[1];
+
+	return match;
+}
+
+/**
+ * @brief Search settings of an engine.
+ *
+ * @param player the engine
+ * @param match score of the match, may be NULL
+ * @param opts output settings
+ */
+static void player_options(const TourneyPlayer *player, const Match *match, SearchOptions *opts) {
+	search_options_init(opts);
+	opts->depth = player->engine->depth ? player->engine->depth : 1;
+	opts->evaluate = player->engine->evaluate;
+	opts->cache = player->cache;
+	opts->match = match;
+	opts->threads = 1;
+}
+
+/**
+ * @brief Cube decision of an engine for the player to move, as in the
+ * GUI: a search one ply shallower than the plays.
+ *
+ * @param m the match
+ * @param player the engine that decides: the doubler, or the taker
+ * @param pos the position, with the doubler to move before the roll
+ * @param value value of the cube
+ * @param owner owner of the cube, seen from the doubler
+ * @param d output decision
+ */
+static void player_cube(TourneyMatch *m, const TourneyPlayer *player, const Position *pos,
+		unsigned value, int owner, CubeDecision *d) {
+	SearchOptions opts;
+	Match match;
+	Cube cube;
+	unsigned mover = engine_of(pos->turn);
+
+	player_options(player, match_score(m, value, &match), &opts);
+
+	cube.value = value;
+	cube.owner = owner;
+	cube.met = m->opts->met;
+	cube.away[0] = m->opts->length - m->score[mover];
+	cube.away[1] = m->opts->length - m->score[1 - mover];
+
+	cube_iterate(pos, &cube, opts.depth - 1, &opts, 0.0, d);
+}
+
+/**
+ * @brief Play of an engine for a roll.
+ *
+ * @param m the match
+ * @param player the engine to move
+ * @param pos the position, with the player to move on roll
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param value value of the cube
+ * @param play output play
+ */
+static void player_play(TourneyMatch *m, TourneyPlayer *player, const Position *pos,
+		unsigned d0, unsigned d1, unsigned value, Play *play) {
+	SearchOptions opts;
+	SearchResult res;
+	MctsOptions mopts;
+	MctsResult mres;
+	Match match;
+
+	if (player->mcts) {
+		mcts_options_init(&mopts);
+		mopts.evaluate = player->engine->evaluate;
+		mopts.match = match_score(m, value, &match);
+		mopts.threads = 1;
+		mopts.budget = 0.0;
+		mopts.simulations = player->engine->simulations;
+		mopts.seed = rng_next(&m->rng);
+		mcts_search(player->mcts, pos, d0, d1, &mopts, &mres);
+		*play = mres.play;
+		return;
+	}
+
+	player_options(player, match_score(m, value, &match), &opts);
+	search_iterate(pos, d0, d1, &opts, 0.0, &res);
+	*play = res.play;
+}
+
+/**
+ * @brief Plays one game of a match and adds it to the score.
+ *
+ * @param m the match
+ * @param starter index of the engine that starts
+ * @param t the tournament, whose results are updated under its lock
+ */
+static void play_game(TourneyMatch *m, unsigned starter, Tourney *t) {
+	TourneyPlayer *mover, *taker;
+	CubeDecision d;
+	Position pos;
+	Game game;
+	unsigned value = 1, winner, points, d0, d1;
+	int owner_dir = 0, owner;
+	bool gammon = false;
+	Play play;
+
+	game_reset(&game);
+	game_init(&game);
+	game.direction = starter ? 1 : -1;
+	position_from_game(&pos, &game);
+
+	for (;;) {
+		mover = &m->players[engine_of(pos.turn)];
+		taker = &m->players[engine_of(-pos.turn)];
+
+		// Who may double: both with the cube centered, else its owner
+		if (!owner_dir) owner = CUBE_CENTERED;
+		else owner = owner_dir == pos.turn ? CUBE_MINE : CUBE_THEIRS;
+
+		if (mover->engine->cube && owner != CUBE_THEIRS && value * 2 <= CUBE_MAX) {
+			player_cube(m, mover, &pos, value, owner, &d);
+
+			if (d.double_) {
+				if (taker->engine->cube) player_cube(m, taker, &pos, value, owner, &d);
+				else d.take = true;
+
+				// Pass: the doubler wins the value of the cube
+				if (!d.take) {
+					winner = engine_of(pos.turn);
+					points = value;
+					break;
+				}
+
+				value *= 2;
+				owner_dir = -pos.turn;
+			}
+		}
+
+		d0 = rng_die(&m->rng);
+		d1 = rng_die(&m->rng);
+		player_play(m, mover, &pos, d0, d1, value, &play);
+		movegen_apply_position(&pos, &play);
+
+		if (position_winner(&pos)) {
+			winner = engine_of(position_winner(&pos));
+			points = position_winner_points(&pos, position_winner(&pos));
+			gammon = points > 1;
+			points *= value;
+			break;
+		}
+
+		position_switch_turn(&pos);
+	}
+
+	m->score[winner] += points;
+
+	pthread_mutex_lock(&t->lock);
+	t->res->games ++;
+	t->res->game_wins[winner] ++;
+	if (gammon) t->res->gammons[winner] ++;
+	t->res->points[winner] += points;
+	t->res->net += winner ? -(double) points : (double) points;
+	t->res->net2 += (double) points * points;
+	pthread_mutex_unlock(&t->lock);
+}
+
+/**
+ * @brief Worker of a tournament: plays matches until none is left.
+ *
+ * @param data the tournament
+ * @return void* NULL
+ */
+static void *worker(void *data) {
+	Tourney *t = (Tourney *) data;
+	const TourneyOptions *opts = t->opts;
+	TourneyPlayer players[2];
+	TourneyMatch m;
+	unsigned i, n, games;
+	bool ok = true;
+
+	for (i = 0; i < 2; i ++) {
+		players[i].engine = &opts->engines[i];
+		players[i].cache = cache_new(TOURNEY_CACHE_SIZE);
+		players[i].mcts = opts->engines[i].simulations ? mcts_new(TOURNEY_MCTS_MEMORY) : NULL;
+		if (!players[i].cache || (opts->engines[i].simulations && !players[i].mcts)) ok = false;
+	}
+
+	while (ok && (n = atomic_fetch_add(&t->next, 1)) < opts->matches) {
+		m.opts = opts;
+		m.players = players;
+		m.score[0] = m.score[1] = 0;
+		rng_seed(&m.rng, opts->seed, n);
+
+		// Nothing kept from the match the thread played before
+		for (i = 0; i < 2; i ++)
+			if (players[i].mcts) mcts_clear(players[i].mcts);
+
+		// The engines take turns to start, from match to match too
+		for (games = 0; m.score[0] < opts->length && m.score[1] < opts->length; games ++)
+			play_game(&m, (n + games) % 2, t);
+
+		pthread_mutex_lock(&t->lock);
+		t->res->matches ++;
+		t->res->wins[m.score[0] >= opts->length ? 0 : 1] ++;
+		i = t->res->matches;
+		pthread_mutex_unlock(&t->lock);
+
+		if (opts->progress) opts->progress(i, opts->matches);
+	}
+
+	for (i = 0; i < 2; i ++) {
+		cache_free(players[i].cache);
+		mcts_free(players[i].mcts);
+	}
+
+	if (!ok) {
+		pthread_mutex_lock(&t->lock);
+		t->failed = true;
+		pthread_mutex_unlock(&t->lock);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Default settings: 2-ply engines with the cube and the heuristic
+ * evaluator, 100 matches of 7 points, one thread per core, seed 1,
+ * money equity, no progress report.
+ *
+ * @param opts output settings
+ */
+void tourney_options_init(TourneyOptions *opts) {
+	unsigned i;
+
+	for (i = 0; i < 2; i ++) {
+		opts->engines[i].depth = 2;
+		opts->engines[i].simulations = 0;
+		opts->engines[i].evaluate = eval_heuristic;
+		opts->engines[i].cube = true;
+	}
+
+	opts->matches = 100;
+	opts->length = 7;
+	opts->threads = 0;
+	opts->seed = 1;
+	opts->met = NULL;
+	opts->progress = NULL;
+}
+
+/**
+ * @brief Plays the matches and waits for the results.
+ *
+ * @param opts settings
+ * @param res output results
+ * @return bool false on error
+ */
+bool tourney_run(const TourneyOptions *opts, TourneyResult *res) {
+	pthread_t threads[TOURNEY_MAX_THREADS];
+	unsigned i, count = opts->threads;
+	long cores;
+	Tourney t;
+
+	if (!opts->length || (opts->met && opts->length > MET_MAX_SCORE)) return false;
+
+	res->matches = 0;
+	res->games = 0;
+	res->net = res->net2 = 0.0;
+	for (i = 0; i < 2; i ++) {
+		res->wins[i] = 0;
+		res->game_wins[i] = 0;
+		res->gammons[i] = 0;
+		res->points[i] = 0;
+	}
+
+	t.opts = opts;
+	t.res = res;
+	t.failed = false;
+	atomic_init(&t.next, 0);
+	pthread_mutex_init(&t.lock, NULL);
+
+	if (!count) {
+		cores = sysconf(_SC_NPROCESSORS_ONLN);
+		count = cores > 0 ? (unsigned) cores : 1;
+	}
+	if (count > opts->matches) count = opts->matches;
+	if (count > TOURNEY_MAX_THREADS) count = TOURNEY_MAX_THREADS;
+
+	for (i = 1; i < count; i ++)
+		if (pthread_create(&threads[i], NULL, worker, &t)) break;
+	count = i;
+
+	worker(&t);
+
+	for (i = 1; i < count; i ++) pthread_join(threads[i], NULL);
+
+	pthread_mutex_destroy(&t.lock);
+
+	return !t.failed;
+}
@@ -0,0 +1,255 @@
+/**
+ * @file train.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/train.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/train.h>
+#include <core/movegen.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Chooses the play with the best 0-ply equity for the network.
+ *
+ * @param net the network
+ * @param pos the position, replaced by the position after the play,
+ * with the turn switched
+ * @param d0 value of the first die
+ * @param d1 value of the second die
+ * @param ev output evaluation of the new position, from the point of view
+ * of its player to move
+ */
+static void play_best(const NNet *net, Position *pos, unsigned d0, unsigned d1, Eval *ev) {
+	Play plays[MOVEGEN_MAX_PLAYS];
+	Position next, best;
+	Eval e;
+	unsigned i, n;
+	float equity, best_equity = 4.0f;
+
+	n = movegen_plays(pos, d0, d1, plays);
+
+	for (i = 0; i < n; i ++) {
+		next = *pos;
+		movegen_apply_position(&next, &plays[i]);
+		position_switch_turn(&next);
+		nnet_evaluate(net, &next, &e);
+
+		// The best play leaves the opponent with the lowest equity
+		equity = eval_equity(&e);
+		if (equity < best_equity) {
+			best_equity = equity;
+			best = next;
+			*ev = e;
+		}
+	}
+
+	*pos = best;
+}
+
+/**
+ * @brief Default settings: until stopped, one thread per core,
+ * rate 0.1, lambda 0.7, seed 1.
+ *
+ * @param opts output settings
+ */
+void train_options_init(TrainOptions *opts) {
+	opts->games = 0;
+	opts->threads = 0;
+	opts->rate = 0.1f;
+	opts->lambda = 0.7f;
+	opts->seed = 1;
+}
+
+/**
+ * @brief Plays one game of the network against itself and trains it on
+ * the lambda-returns of the game.
+ *
+ * @param net the network
+ * @param opts settings (rate and lambda)
+ * @param rng random generator of the thread
+ * @param stats totals to update
+ */
+void train_game(NNet *net, const TrainOptions *opts, Rng *rng, TrainStats *stats) {
+	Position record[TRAIN_MAX_PLIES], pos;
+	Eval value[TRAIN_MAX_PLIES + 1], target;
+	NNetInput in;
+	Game game;
+	unsigned n = 0, d0, d1;
+	int t, i;
+
+	game_reset(&game);
+	game_init(&game);
+	game.direction = rng_next(rng) & 1 ? 1 : -1;
+	position_from_game(&pos, &game);
+
+	// value[t] is the evaluation of the position of ply t, from its player
+	// to move, taken when it was chosen. The last one is the outcome.
+	while (n < TRAIN_MAX_PLIES) {
+		record[n] = pos;
+
+		d0 = rng_die(rng);
+		d1 = rng_die(rng);
+
+		play_best(net, &pos, d0, d1, &value[n + 1]);
+		n ++;
+
+		if (position_winner(&pos)) break;
+	}
+
+	// Lambda-returns, from the end: each ply blends the next evaluation
+	// with the return of the next ply, seen from the other side
+	target = value[n];
+	for (t = n - 1; t >= 0; t --) {
+		for (i = 0; i < EVAL_OUTPUTS; i ++)
+			target.out[i] = (1.0f - opts->lambda) * value[t + 1].out[i]
+					+ opts->lambda * target.out[i];
+		eval_invert(&target);
+
+		nnet_encode(&record[t], &in);
+		stats->error += nnet_train(net, &in, target.out, opts->rate);
+	}
+
+	stats->games ++;
+	stats->positions += n;
+}
+
+/**
+ * @brief Worker thread: plays games until they are done or the training
+ * is stopped.
+ *
+ * @param data the training
+ * @return void* NULL
+ */
+static void *worker(void *data) {
+	Train *train = (Train *) data;
+	TrainStats stats;
+	Rng rng;
+
+	// Own random stream
+	rng_seed(&rng, train->opts.seed, atomic_fetch_add(&train->streams, 1));
+
+	while (!atomic_load_explicit(&train->stop, memory_order_relaxed)) {
+		if (train->opts.games && atomic_fetch_add(&train->next, 1) >= train->opts.games) break;
+
+		memset(&stats, 0, sizeof(TrainStats));
+		train_game(train->net, &train->opts, &rng, &stats);
+
+		pthread_mutex_lock(&train->lock);
+		train->stats.games += stats.games;
+		train->stats.positions += stats.positions;
+		train->stats.error += stats.error;
+		pthread_mutex_unlock(&train->lock);
+	}
+
+	atomic_fetch_sub(&train->running, 1);
+	return NULL;
+}
+
+/**
+ * @brief Starts training a network in background threads.
+ * The network must not be freed before train_free.
+ *
+ * @param net the network
+ * @param opts settings
+ * @return Train* the running training, NULL on error
+ */
+Train *train_start(NNet *net, const TrainOptions *opts) {
+	Train *train;
+	unsigned i, threads;
+	long cores;
+
+	threads = opts->threads;
+	if (!threads) {
+		cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (unsigned) cores : 1;
+	}
+
+	train = calloc(1, sizeof(Train));
+	if (!train) return NULL;
+
+	train->threads = malloc(sizeof(pthread_t) * threads);
+	if (!train->threads) {
+		free(train);
+		return NULL;
+	}
+
+	train->net = net;
+	train->opts = *opts;
+
+	pthread_mutex_init(&train->lock, NULL);
+	atomic_init(&train->next, 0);
+	atomic_init(&train->stop, false);
+	atomic_init(&train->running, threads);
+	atomic_init(&train->streams, 0);
+
+	for (i = 0; i < threads; i ++) {
+		if (pthread_create(&train->threads[i], NULL, worker, train)) {
+			atomic_fetch_sub(&train->running, threads - i);
+			break;
+		}
+	}
+	train->thread_count = i;
+
+	if (!i) {
+		train_free(train);
+		return NULL;
+	}
+
+	return train;
+}
+
+/**
+ * @brief Reads the totals so far. Can be called while the training runs.
+ *
+ * @param train the training
+ * @param stats output totals
+ */
+void train_stats(Train *train, TrainStats *stats) {
+	pthread_mutex_lock(&train->lock);
+	*stats = train->stats;
+	pthread_mutex_unlock(&train->lock);
+}
+
+/**
+ * @brief Checks if every worker has finished.
+ *
+ * @param train the training
+ * @return bool true when done or stopped
+ */
+bool train_done(Train *train) {
+	return atomic_load(&train->running) == 0;
+}
+
+/**
+ * @brief Asks the workers to stop after their current game.
+ *
+ * @param train the training
+ */
+void train_stop(Train *train) {
+	atomic_store(&train->stop, true);
+}
+
+/**
+ * @brief Stops the training, waits for the workers and frees it.
+ * The network is not freed.
+ *
+ * @param train the training
+ */
+void train_free(Train *train) {
+	unsigned i;
+
+	if (!train) return;
+
+	train_stop(train);
+	for (i = 0; i < train->thread_count; i ++) pthread_join(train->threads[i], NULL);
+
+	pthread_mutex_destroy(&train->lock);
+	free(train->threads);
+	free(train);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file zobrist.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of core/zobrist.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/zobrist.h>
+
+uint64_t zobrist_points[24][31];
+uint64_t zobrist_bar[2][16];
+uint64_t zobrist_off[2][16];
+uint64_t zobrist_turn;
+
+/**
+ * @brief splitmix64 generator, used only to fill the tables.
+ *
+ * @param state generator state
+ * @return uint64_t next random number
+ */
+static uint64_t splitmix64(uint64_t *state) {
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * @brief Fills the tables. Runs before main, so they are never seen empty.
+ * An empty point and an empty bar or off count hash to 0, which makes the
+ * key of an empty board 0.
+ */
+__attribute__((constructor)) static void zobrist_init(void) {
+	uint64_t state = 0x6267636F7265ULL;
+	int i, j;
+
+	for (i = 0; i < 24; i ++)
+		for (j = 0; j < 31; j ++)
+			zobrist_points[i][j] = j == 15 ? 0 : splitmix64(&state);
+
+	for (i = 0; i < 2; i ++) {
+		for (j = 0; j < 16; j ++) {
+			zobrist_bar[i][j] = j == 0 ? 0 : splitmix64(&state);
+			zobrist_off[i][j] = j == 0 ? 0 : splitmix64(&state);
+		}
+	}
+
+	zobrist_turn = splitmix64(&state);
+}
+
+/**
+ * @brief Key of the pieces of a game, without the player to move.
+ *
+ * @param game Game instance
+ * @return uint64_t key of places, prisons and goals
+ */
+uint64_t zobrist_game(const Game *game) {
+	uint64_t key = 0;
+	int i, dir;
+
+	for (i = 0; i < 24; i ++) key ^= ZOBRIST_POINT(i, game->places[i]);
+
+	for (dir = -1; dir <= 1; dir += 2) {
+		key ^= zobrist_bar[SIDE_OF(dir)][game->prison[PRISON_OF(dir)] * dir];
+		key ^= zobrist_off[SIDE_OF(dir)][game->goal[GOAL_OF(dir)] * dir];
+	}
+
+	return key;
+}
+
+/**
+ * @brief Key of a position, player to move included.
+ *
+ * @param pos the position
+ * @return uint64_t key of the position
+ */
+uint64_t zobrist_position(const Position *pos) {
+	uint64_t key = 0;
+	int i;
+
+	for (i = 0; i < 24; i ++) key ^= ZOBRIST_POINT(i, pos->points[i]);
+
+	for (i = 0; i < 2; i ++) {
+		key ^= zobrist_bar[i][pos->bar[i]];
+		key ^= zobrist_off[i][pos->off[i]];
+	}
+
+	if (pos->turn == 1) key ^= zobrist_turn;
+
+	return key;
+}
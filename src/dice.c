@@ -10,22 +10,24 @@
 #include <dice.h>
 
 /**
- * @brief Chooses random values for dice[0] and dice[1].
+ * @brief Chooses random values for the dice of the game.
  * Sets all 4 consumed dice flags to False.
  * 
- * @param dice Set of dice
- * @param consumed Dice consumption flags
+ * @param game Rules state holding the dice
+ * @param rng Dice generator of the game
  */
-void dice_roll(guint dice[], gboolean consumed[]) {
-	guint i;
+void dice_roll(Game *game, Rng *rng) {
+	guint i, d0, d1;
 
-	for (i = 0; i < 4; i ++) consumed[i] = FALSE;
-	for (i = 0; i < 2; i ++) dice[i] = g_random_int_range(1, 7);
+	// In this order: arguments are evaluated in any order
+	d0 = rng_die(rng);
+	d1 = rng_die(rng);
+	game_set_dice(game, d0, d1);
 	
 #ifdef BG_DEBUG
 	g_print("Roll: ");
-	for (i = 0; i < (dice[0] == dice[1] ? 4 : 2); i ++) {
-		g_print("%i ", dice[i % 2]);
+	for (i = 0; i < GAME_DICE_COUNT(game); i ++) {
+		g_print("%i ", game->dice[i % 2]);
 	}
 	g_print("\n");
 #endif
@@ -109,18 +111,17 @@ void dice_draw_single(cairo_t *cr, guint value, gdouble x, gdouble y, gint w, gi
  * Draws grayed-out dice when they are consumed.
  * 
  * @param cr Cairo context
- * @param dice Set of dice
- * @param consumed Dice consumption flags
+ * @param game Rules state holding the dice
  * @param w Drawing area width
  * @param h Drawing area height
  */
-void dice_draw(cairo_t *cr, guint dice[], gboolean consumed[], gint w, gint h) {
+void dice_draw(cairo_t *cr, const Game *game, gint w, gint h) {
 	guint i;
 	gdouble x = 0.6;
-	for (i = 0; i < (dice[0] == dice[1] ? 4 : 2); i ++) {
-		dice_draw_single(cr, dice[i % 2], x, 0.47 - DICE_SIZE / 2, w, h);
+	for (i = 0; i < GAME_DICE_COUNT(game); i ++) {
+		dice_draw_single(cr, game->dice[i % 2], x, 0.47 - DICE_SIZE / 2, w, h);
 
-		if (consumed[i]) {
+		if (game->consumed_dice[i]) {
 			COLOR_DICE_DISABLE(cr);
 			draw_rounded_rectangle(cr, x * w, (0.47 - DICE_SIZE / 2) * h, DICE_SIZE * w, DICE_SIZE * w, DICE_SIZE * w * 0.18);
 			cairo_fill(cr);
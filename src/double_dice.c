@@ -38,28 +38,57 @@ void set_double_dice_image(Backgammon *bg, GtkImage *img, guint points) {
 }
 
 /**
- * @brief Doubles the dice for the current player.
+ * @brief Tells whether the current player may double: the last double
+ * was not theirs and the cube is below 64.
+ * 
+ * @param bg Backgammon instance
+ * @return gboolean TRUE if they may
+ */
+gboolean double_allowed(void *bgp) {
+	Backgammon *bg = (Backgammon *) bgp;
+
+	// If the player has already doubled
+	if (bg_current_player(bg)->double_points != 1) return FALSE;
+
+	// Maximum reached. Cannot double anymore
+	return bg_opponent(bg)->double_points * 2 <= 64;
+}
+
+/**
+ * @brief Doubles the dice for the current player: the opponent is asked,
+ * and answers through double_answer, at once or later.
  * 
  * @param bg Backgammon instance
  */
 void double_perform(void *bgp) {
-	Backgammon *bg;
-	guint points;
-	ResultsDialog *dialog;
+	Backgammon *bg = (Backgammon *) bgp;
 
-	bg = (Backgammon *) bgp;
+	if (!double_allowed(bg)) return;
 
-	// If the player has already doubled
-	if (bg_current_player(bg)->double_points != 1) return;
+	// Nothing moves until the opponent answers
+	bg->board->enable_dice = FALSE;
+	gtk_widget_set_sensitive(GTK_WIDGET(bg->double_button), FALSE);
+
+	bg_opponent(bg)->play_func(bg, TRUE);
+}
+
+/**
+ * @brief Answer of the opponent to a double: ends the round, or doubles
+ * the points and resumes the turn of the current player.
+ * 
+ * @param bg Backgammon instance
+ * @param take TRUE if the opponent takes
+ */
+void double_answer(void *bgp, gboolean take) {
+	Backgammon *bg = (Backgammon *) bgp;
+	guint points;
+	ResultsDialog *dialog;
 
 	// Gets the opponent's double and multiplies it by two
 	points = bg_opponent(bg)->double_points;
 	points *= 2;
 
-	// Maximum reached. Cannot double anymore
-	if (points > 64) return;
-
-	if (!bg_opponent(bg)->play_func(bg, TRUE)) {
+	if (!take) {
 		// The opponent reached double request
 		bg->status = S_END_ROUND;
 
@@ -79,9 +108,6 @@ void double_perform(void *bgp) {
 	bg_opponent(bg)->double_points = 1;
 	bg_current_player(bg)->double_points = points;
 
-	// Disables the button
-	gtk_widget_set_sensitive(GTK_WIDGET(bg->double_button), FALSE);
-
 	// Set points
 	if (bg->player[0].direction == -1) {
 		set_double_dice_image(bg, bg->double_image[0], bg->player[0].double_points);
@@ -90,4 +116,7 @@ void double_perform(void *bgp) {
 		set_double_dice_image(bg, bg->double_image[1], bg->player[0].double_points);
 		set_double_dice_image(bg, bg->double_image[0], bg->player[1].double_points);
 	}
+
+	// The turn of the player who doubled goes on
+	bg_current_player(bg)->play_func(bg, FALSE);
 }
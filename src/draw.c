@@ -8,6 +8,7 @@
  * 
  */
 #include <draw.h>
+#include <dice.h>
 
 /**
  * @brief Draws a generic triangle at the specified place.
@@ -87,28 +88,30 @@ void draw_piece(cairo_t *cr, gdouble x, gdouble y, gint color, gint w, gint h) {
  * @brief Draws the set of pieces at the specific place.
  * 
  * @param cr Cairo context
- * @param bg Backgammon instance
+ * @param state state of the board
  * @param place The place where the pieces are located
  * @param w Width of the drawing area
  * @param h Height of the drawing area
  */
-void draw_piece_group(cairo_t *cr, Backgammon *bg, Place place, gint w, gint h) {
+void draw_piece_group(cairo_t *cr, const RenderState *state, Place place, gint w, gint h) {
 	gdouble y;
 	guint count, p;
+	gint data;
 	char text[3];
-	count = place.data < 0 ? place.data * -1 : place.data;
+	data = state->game.places[place.id];
+	count = data < 0 ? data * -1 : data;
 	y = place.id < 12 ? place.y + PIECE_SIZE / 2 : place.y - 0.05;
 	for (p = 0; p < count; p ++) {
 		if (p >= 4) break;
 		draw_piece(cr, place.x + PLACE_SIZE / 2, y,
-			bg_player_by_data(bg, place.data)->piece,
+			DRAW_PIECE_OF(state, data),
 			w, h);
 		if (place.id < 12) y += PIECE_SIZE;
 		else y -= PIECE_SIZE;
 	}
 
 	if (count <= 4) return ;
-	if (bg_player_by_data(bg, place.data)->piece == WHITE) { COLOR_PIECE_BLACK_FACE(cr); }
+	if (DRAW_PIECE_OF(state, data) == WHITE) { COLOR_PIECE_BLACK_FACE(cr); }
 	else COLOR_PIECE_WHITE_FACE(cr);
 
 	cairo_select_font_face(cr, "sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
@@ -151,32 +154,28 @@ void draw_mark(cairo_t *cr, Place place, gint w, gint h) {
  * @brief Draws the pieces in a prison.
  * 
  * @param cr Cairo context
- * @param bg Backgammon instance
+ * @param state state of the board
  * @param prison The prison to be drawn
  * @param w Width of the drawing area
  * @param h Height of the drawing area
  */
-void draw_prison(cairo_t *cr, Backgammon *bg, gint prison, gint w, gint h) {
+void draw_prison(cairo_t *cr, const RenderState *state, gint prison, gint w, gint h) {
 	gdouble y;
 	gint count;
 	gchar text[3];
 
-	Board *board;
-
-	board = bg->board;
-
-	if (!board->prison[prison]) return ;
+	if (!state->game.prison[prison]) return ;
 
 	y = prison ?  0.4 : 0.15;
 	draw_piece(cr, PLACE_SIZE * 7 - PLACE_SIZE / 2, y,
-			bg_player_by_data(bg, board->prison[prison])->piece,
+			DRAW_PIECE_OF(state, state->game.prison[prison]),
 			w, h);
 
-	count = board->prison[prison];
+	count = state->game.prison[prison];
 	count = count < 0 ? count * -1 : count;
 
 	if (count < 2) return ;
-	if (bg_player_by_data(bg, board->prison[prison])->piece == WHITE) { COLOR_PIECE_BLACK_FACE(cr); }
+	if (DRAW_PIECE_OF(state, state->game.prison[prison]) == WHITE) { COLOR_PIECE_BLACK_FACE(cr); }
 	else COLOR_PIECE_WHITE_FACE(cr);
 
 	cairo_select_font_face(cr, "sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
@@ -193,25 +192,23 @@ void draw_prison(cairo_t *cr, Backgammon *bg, gint prison, gint w, gint h) {
  * @brief Draws the pieces in the goal area.
  * 
  * @param cr Cairo context
- * @param bg Backgammon instance
+ * @param state state of the board
  * @param goal The goal area to be drawn
  * @param w Width of the drawing area
  * @param h Height of the drawing area
  */
-void draw_goal(cairo_t *cr, Backgammon *bg, gint goal, gint w, gint h) {
+void draw_goal(cairo_t *cr, const RenderState *state, gint goal, gint w, gint h) {
 	gdouble y, x;
 	gint count;
 	guint piece, i;
 
-	Board *board = bg->board;
-
-	if (!board->goal[goal].data) return ;
+	if (!state->game.goal[goal]) return ;
 
 	y = goal ?  0.535 : 0.0;
 	x = w * PLACE_SIZE * 13 + w * PLACE_SIZE / 2 - w * PIECE_SIZE / 2;
 
-	piece = bg_player_by_data(bg, board->goal[goal].data)->piece;
-	count = board->goal[goal].data;
+	piece = DRAW_PIECE_OF(state, state->game.goal[goal]);
+	count = state->game.goal[goal];
 	if (count < 0) count *= -1;
 
 	for (i = 0; i < count; i ++) {
@@ -234,3 +231,77 @@ void draw_goal(cairo_t *cr, Backgammon *bg, gint goal, gint w, gint h) {
 		cairo_stroke(cr);
 	}
 }
+
+/**
+ * @brief Draws the whole board: the places, the pieces, the marks, the
+ * selection, the dice, the prisons and the goals.
+ *
+ * @param cr Cairo context
+ * @param state state of the board
+ */
+void draw_board(cairo_t *cr, const RenderState *state) {
+	gdouble w, h;
+	gint i;
+
+	w = state->width;
+	h = state->height;
+
+	// Aspect ratio
+	if (h > w * BOARD_RATIO) {
+		h = w * BOARD_RATIO;
+	} else {
+		w = h * (1.0 / BOARD_RATIO);
+	}
+
+	// Background
+	COLOR_BACKGROUND(cr);
+	cairo_paint(cr);
+
+	// Triangles, pieces, and marks
+	for (i = 0; i < 24; i ++) {
+		draw_colored_triangle(cr, state->places[i], i % 2, w, h);
+		draw_piece_group(cr, state, state->places[i], w, h);
+		draw_mark(cr, state->places[i], w, h);
+	}
+
+	// Bars
+	COLOR_BAR(cr);
+	cairo_rectangle(cr, w * 0.0714 * 6, 0, w * 0.0714, h);
+	cairo_rectangle(cr, w * 0.0714 * 13, 0, w * 0.0714, h);
+	cairo_fill(cr);
+
+	// Selection
+	if (state->selected != -1) {
+		COLOR_SELECTION(cr);
+		cairo_rectangle(cr, state->places[state->selected].x * w,
+			state->places[state->selected].y * h,
+			PLACE_SIZE * w, TRIANGLE_HEIGHT * h);
+		cairo_stroke(cr);
+	}
+
+	if (state->prison_sel != -1) {
+		COLOR_SELECTION(cr);
+		if (state->prison_sel == 0)
+			cairo_rectangle(cr, PLACE_SIZE * 6 * w,
+				0.21 * h, PLACE_SIZE * w, PLACE_SIZE * w);
+		else
+			cairo_rectangle(cr, PLACE_SIZE * 6 * w,
+				0.66 * h, PLACE_SIZE * w, PLACE_SIZE * w);
+		cairo_stroke(cr);
+	}
+
+	// Dice
+	dice_draw(cr, &state->game, w, h);
+
+	// Prisons
+	draw_prison(cr, state, 0, w, h);
+	draw_prison(cr, state, 1, w, h);
+
+	// Goal
+	draw_goal(cr, state, 0, w, h);
+	draw_goal(cr, state, 1, w, h);
+
+	// Goal marks
+	draw_mark(cr, state->goal[0], w, h);
+	draw_mark(cr, state->goal[1], w, h);
+}
@@ -127,22 +127,31 @@ static void new_dialog_start_button_clicked(GtkWidget *widget, gpointer data) {
 		gtk_entry_get_text(dialog->pl2_entry)
 	);
 
+	// Player type: human, AI with the index as deepest search, or MCTS
+	// AI, and the thinking time of the AI
+	bg->player[0].think_time = gtk_adjustment_get_value(dialog->pl1_time_adj);
+	bg->player[1].think_time = gtk_adjustment_get_value(dialog->pl2_time_adj);
+
 	index = gtk_combo_box_get_active(GTK_COMBO_BOX(dialog->pl1_combo));
+	bg->player[0].mcts = index == NEW_DIALOG_MCTS;
 	if (index == 0) {
 		bg->player[0].play_func = human_play_func;
 		bg->player[0].ia = FALSE;
 	} else {
 		bg->player[0].play_func = ia_play_func;
 		bg->player[0].ia = TRUE;
+		bg->player[0].search_depth = bg->player[0].mcts ? NEW_DIALOG_MCTS_DEPTH : index;
 	}
 
 	index = gtk_combo_box_get_active(GTK_COMBO_BOX(dialog->pl2_combo));
+	bg->player[1].mcts = index == NEW_DIALOG_MCTS;
 	if (index == 0) {
 		bg->player[1].play_func = human_play_func;
 		bg->player[1].ia = FALSE;
 	} else {
 		bg->player[1].play_func = ia_play_func;
 		bg->player[1].ia = TRUE;
+		bg->player[1].search_depth = bg->player[1].mcts ? NEW_DIALOG_MCTS_DEPTH : index;
 	}
 
 	if (dialog->clockwise) {
@@ -189,6 +198,9 @@ static void new_dialog_start_button_clicked(GtkWidget *widget, gpointer data) {
 		gtk_image_set_from_pixbuf(bg->double_image[index], NULL);
 	}
 
+	// Drop the turn the AI was thinking
+	ia_cancel(bg);
+
 	bg->status = S_NOT_PLAYING;
 	board_init(bg->board);
 	bg_next_step(bg);
@@ -243,6 +255,11 @@ NewDialog *new_dialog_new(Backgammon *bg) {
 	dialog->score_adj = GTK_ADJUSTMENT(gtk_builder_get_object(builder, "score_adj"));
 	gtk_adjustment_set_value(dialog->score_adj, bg->max_score);
 
+	dialog->pl1_time_adj = GTK_ADJUSTMENT(gtk_builder_get_object(builder, "pl1_time_adj"));
+	gtk_adjustment_set_value(dialog->pl1_time_adj, bg->player[0].think_time);
+	dialog->pl2_time_adj = GTK_ADJUSTMENT(gtk_builder_get_object(builder, "pl2_time_adj"));
+	gtk_adjustment_set_value(dialog->pl2_time_adj, bg->player[1].think_time);
+
 	g_signal_connect(
 		GTK_BUTTON(gtk_builder_get_object(builder, "start-button")),
 		"clicked", G_CALLBACK(new_dialog_start_button_clicked), dialog
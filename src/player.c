@@ -15,25 +15,345 @@
 #include <utils.h>
 #include <double_dice.h>
 
+#include <core/cube.h>
+#include <core/mcts.h>
+#include <core/search.h>
+
 #include <libintl.h>
+#include <stdatomic.h>
 
 #define _(str)	gettext(str)
 
 /**
- * @brief Human response to the opponent's request to double points
+ * @brief Human response to the opponent's request to double points,
+ * given to double_answer
  * 
  * @param bg backgammon instance
- * @return gboolean TRUE: Positive response
  */
-gboolean human_double_request(Backgammon *bg);
+void human_double_request(Backgammon *bg);
 
 /**
- * @brief AI response to the opponent's request to double points
+ * @brief AI response to the opponent's request to double points, given
+ * to double_answer when its worker is done
  * 
  * @param bg backgammon instance
- * @return gboolean TRUE: Positive response
  */
-gboolean ia_double_request(Backgammon *bg);
+void ia_double_request(Backgammon *bg);
+
+/**
+ * @brief Thinking of the AI, on a snapshot of the game: the cube decision
+ * before the roll, the answer to a double, or the full play of the dice.
+ * It runs on a worker thread and never touches the game.
+ * 
+ */
+struct ia_job_t {
+	Backgammon *bg;
+	GThread *thread;
+	atomic_bool stop;
+	gboolean cube_job, take_job;
+
+	Position pos;
+	guint dice[2], depth;
+	gdouble budget;
+	gint64 start;
+	SearchOptions opts;
+	Match match;
+	Cube cube;
+
+	SearchResult res;
+	CubeDecision decision;
+	guint reached;
+
+	Mcts *mcts;
+	MctsOptions mcts_opts;
+	MctsResult mcts_res;
+};
+
+/**
+ * @brief Takes the snapshot of the game for a job.
+ * The player who doubled last holds the cube value and cannot double
+ * again, so the cube belongs to the other player.
+ * The cube decision is always seen from the player to move; the AI that
+ * thinks, with its own settings, is the one to move or the one that
+ * answers its double.
+ * 
+ * @param bg backgammon instance
+ * @param job the job
+ * @param cube_job TRUE for the cube decision, FALSE for the play
+ * @param ia the AI player that thinks
+ */
+static void ia_job_init(Backgammon *bg, IaJob *job, gboolean cube_job, Player *ia) {
+	guint i;
+
+	job->bg = bg;
+	job->thread = NULL;
+	atomic_init(&job->stop, false);
+	job->cube_job = cube_job;
+	job->take_job = FALSE;
+
+	position_from_game(&job->pos, &bg->board->game);
+	job->dice[0] = bg->board->game.dice[0];
+	job->dice[1] = bg->board->game.dice[1];
+	job->budget = ia->think_time;
+	job->start = g_get_monotonic_time();
+
+	// Score of the match, for the search
+	job->match.met = bg->met;
+	job->match.cube = bg->player[0].double_points * bg->player[1].double_points;
+	for (i = 0; i < 2; i ++)
+		job->match.away[SIDE_OF(bg->player[i].direction)] = bg->max_score - bg->player[i].score;
+
+	search_options_init(&job->opts);
+	job->opts.depth = ia->search_depth;
+	job->opts.evaluate = bg->evaluate;
+	job->opts.cache = bg->cache;
+	job->opts.match = bg->met ? &job->match : NULL;
+	job->opts.threads = 0;
+	job->opts.stop = &job->stop;
+
+	job->cube.value = job->match.cube;
+	if (bg_current_player(bg)->double_points > 1) job->cube.owner = CUBE_THEIRS;
+	else if (bg_opponent(bg)->double_points > 1) job->cube.owner = CUBE_MINE;
+	else job->cube.owner = CUBE_CENTERED;
+
+	// Decisions by match winning chances at the score
+	job->cube.met = bg->met;
+	job->cube.away[0] = bg->max_score - bg_current_player(bg)->score;
+	job->cube.away[1] = bg->max_score - bg_opponent(bg)->score;
+
+	// One ply less than the move search: every roll is searched
+	job->depth = job->opts.depth > 0 ? job->opts.depth - 1 : 0;
+
+	// The plays of an MCTS player grow its own tree, kept between turns
+	job->mcts = NULL;
+	if (!cube_job && ia->mcts) {
+		i = ia - bg->player;
+		if (!bg->mcts[i]) bg->mcts[i] = mcts_new(IA_MCTS_MEMORY);
+		job->mcts = bg->mcts[i];
+
+		mcts_options_init(&job->mcts_opts);
+		job->mcts_opts.evaluate = bg->evaluate;
+		job->mcts_opts.match = job->opts.match;
+		job->mcts_opts.budget = job->budget;
+		job->mcts_opts.seed = g_random_int();
+		job->mcts_opts.stop = &job->stop;
+	}
+}
+
+/**
+ * @brief Runs the search of a job: iterative deepening until the
+ * thinking time of the player is over.
+ * 
+ * @param job the job
+ */
+static void ia_job_run(IaJob *job) {
+	if (job->cube_job) {
+		job->reached = cube_iterate(&job->pos, &job->cube, job->depth, &job->opts,
+				job->budget, &job->decision);
+	} else if (job->mcts) {
+		mcts_search(job->mcts, &job->pos, job->dice[0], job->dice[1],
+				&job->mcts_opts, &job->mcts_res);
+		job->res.play = job->mcts_res.play;
+		job->res.equity = job->mcts_res.equity;
+		job->res.nodes = job->mcts_res.simulations;
+		job->res.seconds = job->mcts_res.seconds;
+		job->res.book = false;
+		job->reached = 0;
+	} else {
+		search_iterate(&job->pos, job->dice[0], job->dice[1], &job->opts,
+				job->budget, &job->res);
+		job->reached = job->res.depth;
+	}
+
+#ifdef BG_DEBUG
+	if (job->cube_job)
+		g_print("Cube %u (%u-ply): no double %.3f, double/take %.3f, take point %.3f\n",
+				job->cube.value, job->reached, job->decision.no_double,
+				job->decision.double_take, job->decision.take_point);
+	else if (job->mcts)
+		g_print("MCTS: %u plays, %" G_GUINT64_FORMAT " simulations, %.0f simulations/sec, "
+				"%" G_GUINT64_FORMAT " nodes reused, %.1f MB, equity %.3f\n",
+				job->mcts_res.plays, job->mcts_res.simulations,
+				job->mcts_res.seconds > 0.0 ? job->mcts_res.simulations / job->mcts_res.seconds : 0.0,
+				job->mcts_res.reused, job->mcts_res.memory / 1048576.0, job->mcts_res.equity);
+	else
+		g_print("Search %u-ply of %u: %u plays, %" G_GUINT64_FORMAT " nodes, %.0f nodes/sec, equity %.3f\n",
+				job->res.depth, job->opts.depth, job->res.plays, job->res.nodes,
+				job->res.seconds > 0.0 ? job->res.nodes / job->res.seconds : 0.0,
+				job->res.equity);
+#endif
+}
+
+/**
+ * @brief Called on the main loop when the worker is done: hands the result
+ * to the AI player and resumes its turn, or answers the double.
+ * 
+ * @param data the job
+ * @return gboolean G_SOURCE_REMOVE
+ */
+static gboolean ia_job_done(gpointer data) {
+	IaJob *job = (IaJob *) data;
+	Backgammon *bg = job->bg;
+	gboolean take;
+	gint64 elapsed;
+	gchar *text;
+
+	g_thread_join(job->thread);
+	bg->ia_job = NULL;
+
+	// The turn is the doubler's, who goes on from the answer
+	if (job->take_job) {
+		take = job->decision.take;
+		g_free(job);
+		double_answer(bg, take);
+		return G_SOURCE_REMOVE;
+	}
+
+	if (job->cube_job) bg->ia_cube = job->decision;
+	else {
+		bg->ia_play = job->res.play;
+		bg->ia_move = 0;
+
+		// Depth reached and nodes searched in the thinking time
+		if (job->mcts) text = g_strdup_printf(_("Move pieces (MCTS, %.0f simulations/s)"),
+				job->mcts_res.seconds > 0.0 ? job->mcts_res.simulations / job->mcts_res.seconds : 0.0);
+		else if (job->res.book) text = g_strdup(_("Move pieces (book)"));
+		else text = g_strdup_printf(_("Move pieces (%u-ply, %.0f nodes)"),
+				job->res.depth, (double) job->res.nodes);
+		gtk_label_set_text(bg->action_label, text);
+		g_free(text);
+	}
+	bg->ia_ready = TRUE;
+
+	// Quick decisions still wait for the pace of the movements
+	elapsed = (g_get_monotonic_time() - job->start) / 1000;
+	g_free(job);
+
+	if (elapsed < DELAYED_FUNC_TIMEOUT)
+		bg->ia_timer = g_timeout_add(DELAYED_FUNC_TIMEOUT - elapsed, ia_delayed_func, bg);
+	else bg_current_player(bg)->play_func(bg, FALSE);
+
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * @brief Worker thread of a job.
+ * 
+ * @param data the job
+ * @return gpointer NULL
+ */
+static gpointer ia_job_thread(gpointer data) {
+	IaJob *job = (IaJob *) data;
+
+	ia_job_run(job);
+	if (!atomic_load(&job->stop)) g_idle_add(ia_job_done, job);
+
+	return NULL;
+}
+
+/**
+ * @brief Tells whether the AI has not used any die of the roll yet.
+ * 
+ * @param bg backgammon instance
+ * @return gboolean TRUE before the first movement of the turn
+ */
+static gboolean ia_new_turn(Backgammon *bg) {
+	guint i;
+
+	for (i = 0; i < 4; i ++)
+		if (bg->board->game.consumed_dice[i]) return FALSE;
+
+	return TRUE;
+}
+
+/**
+ * @brief Stops pondering, if the AI was.
+ * 
+ * @param bg backgammon instance
+ */
+static void ia_ponder_stop(Backgammon *bg) {
+	ponder_free(bg->ponder);
+	bg->ponder = NULL;
+}
+
+/**
+ * @brief Ponders during the turn of a human player whose opponent is an
+ * AI: the likely replies to the roll (or to every roll, before it) are
+ * analyzed with the settings of the AI, so its next search finds them in
+ * the cache. A ponder running already is replaced.
+ * 
+ * @param bg backgammon instance
+ */
+static void ia_ponder_start(Backgammon *bg) {
+	Player *ia = bg_opponent(bg);
+	SearchOptions opts;
+	Position pos;
+	Match match;
+	guint i;
+
+	ia_ponder_stop(bg);
+
+	// The tree of an MCTS player does not read the cache
+	if (!ia->ia || ia->mcts) return;
+
+	position_from_game(&pos, &bg->board->game);
+
+	// Same score and settings as the search of the AI (ia_job_init)
+	match.met = bg->met;
+	match.cube = bg->player[0].double_points * bg->player[1].double_points;
+	for (i = 0; i < 2; i ++)
+		match.away[SIDE_OF(bg->player[i].direction)] = bg->max_score - bg->player[i].score;
+
+	search_options_init(&opts);
+	opts.depth = ia->search_depth;
+	opts.evaluate = bg->evaluate;
+	opts.cache = bg->cache;
+	opts.match = bg->met ? &match : NULL;
+	opts.threads = 0;
+
+	if (bg->status == S_ROLL_DICE) bg->ponder = ponder_start(&pos, 0, 0, &opts);
+	else bg->ponder = ponder_start(&pos, bg->board->game.dice[0], bg->board->game.dice[1], &opts);
+}
+
+/**
+ * @brief Starts thinking on a worker thread. The turn resumes on the main
+ * loop when the result is ready, so drawing and input go on meanwhile.
+ * 
+ * @param bg backgammon instance
+ * @param cube_job TRUE for the cube decision, FALSE for the play
+ */
+static void ia_think(Backgammon *bg, gboolean cube_job) {
+	IaJob *job = g_new(IaJob, 1);
+
+	// The position changed: what the ponder looks at is out of date
+	ia_ponder_stop(bg);
+
+	ia_job_init(bg, job, cube_job, bg_current_player(bg));
+	bg->ia_job = job;
+	job->thread = g_thread_new("ia", ia_job_thread, job);
+}
+
+/**
+ * @brief Returns the next movement of the play chosen by the AI.
+ * Falls back to the first legal movement if the play does not match
+ * the board.
+ * 
+ * @param bg backgammon instance
+ * @return Movement the movement to make
+ */
+static Movement ia_next_movement(Backgammon *bg) {
+	Movement movement;
+	guint i;
+
+	if (bg->ia_move < bg->ia_play.count) {
+		movement = bg->ia_play.moves[bg->ia_move++];
+
+		for (i = 0; i < bg->board->movements.count; i ++)
+			if (bg->board->movements.moves[i] == movement) return movement;
+	}
+
+	return bg->board->movements.moves[0];
+}
 
 /**
  * @brief Update player information:
@@ -78,57 +398,34 @@ void player_update(void *bgp) {
 }
 
 /**
- * @brief Counts the number of steps the player needs to win
+ * @brief Returns the number of steps the player needs to win.
+ * The count is maintained by the rules core, so this is O(1).
  * 
  * @param bg Instance of Backgammon
  * @param player Target player
  * @return guint number of remaining steps to win
  */
 guint player_count_steps(void *bgp, Player *player) {
-	Backgammon *bg;
-	gint i, j, sum, val;
-	bg = (Backgammon *) bgp;
-
-	sum = 0;
-
-	// Prison
-	val = bg->board->prison[player->direction == -1 ? 1 : 0];
-	if (val < 0) val *= -1;
-	sum += val * 24;
-
-	if (player->direction == -1) {
-		for (i = 0; i < 24; i ++) {
-			val = bg->board->places[i].data;
-			if (val * player->direction < 0) continue;
+	Backgammon *bg = (Backgammon *) bgp;
 
-			if (val < 0) val *= -1;
-			sum += val * (i + 1);
-		}
-	} else {
-		i = 0;
-		for (j = 23; j >= 0; j --) {
-			val = bg->board->places[j].data;
-			if (val * player->direction < 0) { i ++; continue; }
-
-			if (val < 0) val *= -1;
-			sum += val * (i + 1);
-			i ++;
-		}
-	}
-	return sum;
+	return game_count_steps(&bg->board->game, player->direction);
 }
 
 /**
  * @brief Function assigned to a player to configure them as a human player.
  * 
  * @param bg Backgammon instance
- * @param double_request TRUE when the player is asked to double
- * @return boolean FALSE if opponent rejects the double
+ * @param double_request TRUE when the player is asked to answer a double;
+ * the answer goes to double_answer
+ * @return boolean TRUE
  */
 gboolean human_play_func(void *bgp, gboolean double_request) {
 	Backgammon *bg = (Backgammon *) bgp;
 
-	if (double_request) return human_double_request(bg);
+	if (double_request) {
+		human_double_request(bg);
+		return TRUE;
+	}
 
 	if (bg->status == S_ROLL_DICE) {
 		bg->board->enable_dice = TRUE;
@@ -139,18 +436,24 @@ gboolean human_play_func(void *bgp, gboolean double_request) {
 
 		if (bg_current_player(bg)->double_points == 1)
 			gtk_widget_set_sensitive(GTK_WIDGET(bg->double_button), TRUE);
+
+		// The AI opponent thinks about the replies to every roll
+		ia_ponder_start(bg);
 	}
 	if (bg->status == S_MOVE_PIECES) {
 		// Scan possible movements
 		scan_movements(bg);
 
 		// If the player can't move
-		if (bg->board->movements == NULL) {
+		if (bg->board->movements.count == 0) {
 			bg->status = S_END_TURN;
+		} else if (ia_new_turn(bg)) {
+			// Only the replies to the dice rolled are left to ponder
+			ia_ponder_start(bg);
 		}
 
 #ifdef BG_DEBUG
-		g_print("Movements: %u\n\n", g_list_length(bg->board->movements));
+		g_print("Movements: %u\n\n", bg->board->movements.count);
 #endif
 
 		bg->board->enable_dice = FALSE;
@@ -175,18 +478,17 @@ gboolean human_play_func(void *bgp, gboolean double_request) {
  * @brief Function assigned to a player to configure them as an artificial intelligence.
  * 
  * @param bg Backgammon instance
- * @param double_request TRUE when the player is asked to double
- * @return boolean FALSE if opponent rejects the double
+ * @param double_request TRUE when the player is asked to answer a double;
+ * the answer goes to double_answer
+ * @return boolean TRUE
  */
 gboolean ia_play_func(void *bgp, gboolean double_request) {
-	guint choice, i;
-	GList *iter;
-	gint player_steps, opponent_steps, diff;
-	Movement *movement;
-	gboolean chosen;
 	Backgammon *bg = (Backgammon *) bgp;
 
-	if (double_request) return ia_double_request(bg);
+	if (double_request) {
+		ia_double_request(bg);
+		return TRUE;
+	}
 
 	bg->board->enable_dice = FALSE;
 	bg->board->enable_places = FALSE;
@@ -195,25 +497,23 @@ gboolean ia_play_func(void *bgp, gboolean double_request) {
 		gtk_label_set_text(bg->action_label, _("Throw dice"));
 		gtk_widget_set_sensitive(GTK_WIDGET(bg->end_turn_button), FALSE);
 
-		// Double perform
-		player_steps = player_count_steps(bg, bg_current_player(bg));
-		opponent_steps = player_count_steps(bg, bg_opponent(bg));
-
-		if (opponent_steps <= player_steps) {
-
-			diff = player_steps - opponent_steps;
-
-			if (diff <= 5)
-				if (g_random_double_range(0.0, 1.0) < 0.05) double_perform(bg);
-
-			if (diff > 5 && diff <= 30)
-				if (g_random_double_range(0.0, 1.0) < 0.2) double_perform(bg);
-
-			if (g_random_double_range(0.0, 1.0) < 0.3) double_perform(bg);
+		if (double_allowed(bg)) {
+			// Think first; the worker calls back with the cube decision
+			if (!bg->ia_ready) {
+				ia_think(bg, TRUE);
+				return TRUE;
+			}
+			bg->ia_ready = FALSE;
 
+			// Double when doubling is worth more than holding the cube;
+			// the answer of the opponent resumes the turn
+			if (bg->ia_cube.double_) {
+				double_perform(bg);
+				return TRUE;
+			}
 		}
-		
-		dice_roll(bg->board->dice, bg->board->consumed_dice);
+
+		dice_roll(&bg->board->game, &bg->dice);
 
 		bg->status = S_MOVE_PIECES;
 
@@ -226,49 +526,27 @@ gboolean ia_play_func(void *bgp, gboolean double_request) {
 		scan_movements(bg);
 
 		// If the player can't move
-		if (bg->board->movements == NULL) {
+		if (bg->board->movements.count == 0) {
 			bg->status = S_END_TURN;
 		} else {
 
 #ifdef BG_DEBUG
-			g_print("Movements: %u\n\n", g_list_length(bg->board->movements));
+			g_print("Movements: %u\n\n", bg->board->movements.count);
 #endif
 
-			gtk_label_set_text(bg->action_label, _("Move pieces"));
 			gtk_widget_set_sensitive(GTK_WIDGET(bg->end_turn_button), FALSE);
 
-			// TODO: improve ai
-
-			// Check best movement
-			chosen = FALSE;
-			for (iter = bg->board->movements; iter; iter = iter->next) {
-				movement = (Movement *) iter->data;
-				if (movement->goal_dest) {
-					chosen = TRUE;
-					move_piece(bg, (Movement *) iter->data);
-					board_redraw(bg->board);
-					break;
-				} else if (bg_current_player(bg)->direction * bg->board->places[movement->dest].data > 0) {
-					chosen = TRUE;
-					move_piece(bg, (Movement *) iter->data);
-					board_redraw(bg->board);
-					break;
-				}
+			// No die used yet: search the full play of the turn on the
+			// worker, which calls back with the play and its report
+			if (ia_new_turn(bg) && !bg->ia_ready) {
+				gtk_label_set_text(bg->action_label, _("Move pieces"));
+				ia_think(bg, FALSE);
+				return TRUE;
 			}
+			bg->ia_ready = FALSE;
 
-			// Randomize movement
-			if (!chosen) {
-				choice = g_random_int_range(0, g_list_length(bg->board->movements));
-				i = 0;
-				for (iter = bg->board->movements; iter; iter = iter->next) {
-					if (i == choice) {
-						move_piece(bg, (Movement *) iter->data);
-						board_redraw(bg->board);
-						break;
-					}
-					i ++;
-				}
-			}
+			move_piece(bg, ia_next_movement(bg));
+			board_redraw(bg->board);
 		}
 		bg_next_step(bg);
 	} else if (bg->status == S_END_TURN) {
@@ -288,18 +566,66 @@ gboolean ia_play_func(void *bgp, gboolean double_request) {
 gboolean ia_delayed_func(gpointer data) {
 	Backgammon *bg = (Backgammon *) data;
 
+	bg->ia_timer = 0;
 	bg_current_player(bg)->play_func(bg, FALSE);
 
 	return G_SOURCE_REMOVE;
 }
 
 /**
- * @brief Human response to the opponent's request to double points
+ * @brief Delay before the next step of an AI player: none when it has
+ * to think, since thinking takes its time budget; the pace of the
+ * movements otherwise.
+ * 
+ * @param bg Backgammon instance
+ * @return guint delay in milliseconds
+ */
+guint ia_step_delay(void *bgp) {
+	Backgammon *bg = (Backgammon *) bgp;
+
+	if (bg->status == S_ROLL_DICE && double_allowed(bg)) return 0;
+	if (bg->status == S_MOVE_PIECES && ia_new_turn(bg)) return 0;
+
+	return DELAYED_FUNC_TIMEOUT;
+}
+
+/**
+ * @brief Cancels the pending turn of the AI: the delay, the ponder, and
+ * the search running on the worker thread, whose result is dropped.
+ * 
+ * @param bg Backgammon instance
+ */
+void ia_cancel(void *bgp) {
+	Backgammon *bg = (Backgammon *) bgp;
+	IaJob *job = bg->ia_job;
+
+	if (bg->ia_timer) {
+		g_source_remove(bg->ia_timer);
+		bg->ia_timer = 0;
+	}
+
+	ia_ponder_stop(bg);
+
+	if (job) {
+		atomic_store(&job->stop, true);
+		g_thread_join(job->thread);
+
+		// The result may be waiting on the main loop
+		g_idle_remove_by_data(job);
+		g_free(job);
+		bg->ia_job = NULL;
+	}
+
+	bg->ia_ready = FALSE;
+}
+
+/**
+ * @brief Human response to the opponent's request to double points,
+ * given to double_answer
  * 
  * @param bg backgammon instance
- * @return gboolean TRUE: Positive response
  */
-gboolean human_double_request(Backgammon *bg) {
+void human_double_request(Backgammon *bg) {
 	GString *msg;
 	gboolean result;
 
@@ -311,28 +637,24 @@ gboolean human_double_request(Backgammon *bg) {
 
 	g_string_free(msg, TRUE);
 
-	return result;
+	double_answer(bg, result);
 }
 
 /**
- * @brief AI response to the opponent's request to double points
+ * @brief AI response to the opponent's request to double points, given
+ * to double_answer when its worker is done
  * 
  * @param bg backgammon instance
- * @return gboolean TRUE: Positive response
  */
-gboolean ia_double_request(Backgammon *bg) {
-	gint player_steps, opponent_steps, diff;
-	player_steps = player_count_steps(bg, bg_opponent(bg));
-	opponent_steps = player_count_steps(bg, bg_current_player(bg));
-
-	diff = player_steps - opponent_steps;
-
-	if (diff < -20) return g_random_double_range(0.0, 1.0) < 0.1;
-	
-	if (diff >= -20 && diff < 10)
-		return g_random_double_range(0.0, 1.0) < 0.4;
-		
+void ia_double_request(Backgammon *bg) {
+	IaJob *job = g_new(IaJob, 1);
 
-	return g_random_double_range(0.0, 1.0) < 0.9;
+	ia_ponder_stop(bg);
 
+	// The player who doubles is the player to move; the AI answering is
+	// the opponent, and thinks with its own settings on the worker
+	ia_job_init(bg, job, TRUE, bg_opponent(bg));
+	job->take_job = TRUE;
+	bg->ia_job = job;
+	job->thread = g_thread_new("ia", ia_job_thread, job);
 }
@@ -0,0 +1,292 @@
+/**
+ * @file render.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of render.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <render.h>
+#include <draw.h>
+
+#include <string.h>
+
+/**
+ * @brief A renderer. The worker paints into surfaces[1 - front] while the
+ * main thread may copy surfaces[front]; they swap under the mutex when a
+ * frame is done. The mutex also guards the request and the counters.
+ *
+ */
+struct render_t {
+	GtkWidget *area;
+	GThread *thread;
+	GMutex mutex;
+	GCond cond;
+	gboolean pending, quit;
+	guint idle;
+
+	RenderState request;
+	cairo_surface_t *surfaces[2];
+	gint front;
+	gint shown_width, shown_height;
+
+	RenderStats stats;
+};
+
+/**
+ * @brief Adds a time to a counter: count, total and maximum.
+ *
+ * @param count number of samples
+ * @param total sum of the samples
+ * @param max largest sample
+ * @param elapsed the sample (microseconds)
+ */
+static void render_count(guint64 *count, guint64 *total, guint64 *max, gint64 elapsed) {
+	(*count) ++;
+	*total += elapsed;
+	if ((guint64) elapsed > *max) *max = elapsed;
+}
+
+/**
+ * @brief Called on the main loop when a frame is done: redraws the area.
+ *
+ * @param data Render instance
+ * @return gboolean G_SOURCE_REMOVE
+ */
+static gboolean render_frame_done(gpointer data) {
+	Render *render = (Render *) data;
+
+	g_mutex_lock(&render->mutex);
+	render->idle = 0;
+	g_mutex_unlock(&render->mutex);
+
+	gtk_widget_queue_draw(render->area);
+
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * @brief Paints a state into a surface of its size, which is replaced if
+ * it has another one.
+ *
+ * @param surface the surface, may be NULL
+ * @param state state of the board
+ * @return cairo_surface_t* the surface painted
+ */
+static cairo_surface_t *render_paint(cairo_surface_t *surface, const RenderState *state) {
+	gint width = state->width * state->scale, height = state->height * state->scale;
+	cairo_t *cr;
+
+	if (surface && (cairo_image_surface_get_width(surface) != width
+			|| cairo_image_surface_get_height(surface) != height)) {
+		cairo_surface_destroy(surface);
+		surface = NULL;
+	}
+
+	if (!surface) {
+		surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+		cairo_surface_set_device_scale(surface, state->scale, state->scale);
+	}
+
+	cr = cairo_create(surface);
+	draw_board(cr, state);
+	cairo_destroy(cr);
+	cairo_surface_flush(surface);
+
+	return surface;
+}
+
+/**
+ * @brief Worker thread: paints the latest request into the back surface
+ * and swaps it to the front. Requests made meanwhile are merged: only
+ * the last one is painted.
+ *
+ * @param data Render instance
+ * @return gpointer NULL
+ */
+static gpointer render_thread(gpointer data) {
+	Render *render = (Render *) data;
+	RenderState state;
+	cairo_surface_t *back;
+	gint64 start;
+
+	g_mutex_lock(&render->mutex);
+	for (;;) {
+		while (!render->pending && !render->quit)
+			g_cond_wait(&render->cond, &render->mutex);
+		if (render->quit) break;
+
+		state = render->request;
+		render->pending = FALSE;
+		back = render->surfaces[1 - render->front];
+		g_mutex_unlock(&render->mutex);
+
+		// The main thread never touches the back surface
+		start = g_get_monotonic_time();
+		back = render_paint(back, &state);
+
+		g_mutex_lock(&render->mutex);
+		render_count(&render->stats.frames, &render->stats.frame_time,
+				&render->stats.frame_max, g_get_monotonic_time() - start);
+
+		render->front = 1 - render->front;
+		render->surfaces[render->front] = back;
+		render->shown_width = state.width;
+		render->shown_height = state.height;
+
+		if (!render->idle) render->idle = g_idle_add(render_frame_done, render);
+	}
+	g_mutex_unlock(&render->mutex);
+
+	return NULL;
+}
+
+#ifdef BG_DEBUG
+/**
+ * @brief Prints the timing counters.
+ *
+ * @param stats the counters
+ */
+static void render_print_stats(const RenderStats *stats) {
+	if (stats->frames)
+		g_print("Render: %" G_GUINT64_FORMAT " frames, %.2f ms avg, %.2f ms max\n",
+				stats->frames, stats->frame_time / 1000.0 / stats->frames,
+				stats->frame_max / 1000.0);
+	if (stats->draws)
+		g_print("Draw: %" G_GUINT64_FORMAT " blits, %.2f ms avg, %.2f ms max\n",
+				stats->draws, stats->draw_time / 1000.0 / stats->draws,
+				stats->draw_max / 1000.0);
+	if (stats->inputs)
+		g_print("Input: %" G_GUINT64_FORMAT " clicks, %.2f ms avg, %.2f ms max\n",
+				stats->inputs, stats->input_time / 1000.0 / stats->inputs,
+				stats->input_max / 1000.0);
+}
+#endif
+
+/**
+ * @brief Creates a renderer and starts its worker thread.
+ *
+ * @param area DrawingArea that shows the frames
+ * @return Render* New instance of Render
+ */
+Render *render_new(GtkWidget *area) {
+	Render *render = g_new0(Render, 1);
+
+	render->area = area;
+	g_mutex_init(&render->mutex);
+	g_cond_init(&render->cond);
+
+	// No frame yet: the first one is painted into surfaces[0]
+	render->front = 1;
+	render->request.scale = -1;
+
+	render->thread = g_thread_new("render", render_thread, render);
+
+	return render;
+}
+
+/**
+ * @brief Stops the worker thread and frees the renderer.
+ *
+ * @param render Render instance, may be NULL
+ */
+void render_free(Render *render) {
+	if (!render) return;
+
+	g_mutex_lock(&render->mutex);
+	render->quit = TRUE;
+	g_cond_signal(&render->cond);
+	g_mutex_unlock(&render->mutex);
+	g_thread_join(render->thread);
+
+	if (render->idle) g_source_remove(render->idle);
+
+#ifdef BG_DEBUG
+	render_print_stats(&render->stats);
+#endif
+
+	if (render->surfaces[0]) cairo_surface_destroy(render->surfaces[0]);
+	if (render->surfaces[1]) cairo_surface_destroy(render->surfaces[1]);
+	g_mutex_clear(&render->mutex);
+	g_cond_clear(&render->cond);
+	g_free(render);
+}
+
+/**
+ * @brief Asks for a frame of a state. Nothing is painted if the state is
+ * the one of the last request; otherwise the worker paints it and the
+ * area is redrawn when it is done.
+ *
+ * @param render Render instance
+ * @param state state of the board
+ */
+void render_request(Render *render, const RenderState *state) {
+	g_mutex_lock(&render->mutex);
+	if (memcmp(&render->request, state, sizeof(RenderState))) {
+		render->request = *state;
+		render->pending = TRUE;
+		g_cond_signal(&render->cond);
+	}
+	g_mutex_unlock(&render->mutex);
+}
+
+/**
+ * @brief Copies the last finished frame to a Cairo context. A frame of
+ * another size is scaled to fit until the new one is ready.
+ *
+ * @param render Render instance
+ * @param cr Cairo context of the draw signal
+ * @param width width of the area
+ * @param height height of the area
+ */
+void render_blit(Render *render, cairo_t *cr, gint width, gint height) {
+	gint64 start = g_get_monotonic_time();
+	gdouble scale;
+
+	g_mutex_lock(&render->mutex);
+
+	// Background, under the frame and around a scaled one
+	COLOR_BACKGROUND(cr);
+	cairo_paint(cr);
+
+	if (render->surfaces[render->front] && render->shown_width > 0 && render->shown_height > 0) {
+		if (render->shown_width != width || render->shown_height != height) {
+			scale = MIN((gdouble) width / render->shown_width,
+					(gdouble) height / render->shown_height);
+			cairo_scale(cr, scale, scale);
+		}
+
+		cairo_set_source_surface(cr, render->surfaces[render->front], 0, 0);
+		cairo_paint(cr);
+	}
+
+	render_count(&render->stats.draws, &render->stats.draw_time,
+			&render->stats.draw_max, g_get_monotonic_time() - start);
+	g_mutex_unlock(&render->mutex);
+}
+
+/**
+ * @brief Counts the time spent handling an input event.
+ *
+ * @param render Render instance
+ * @param elapsed microseconds spent
+ */
+void render_count_input(Render *render, gint64 elapsed) {
+	g_mutex_lock(&render->mutex);
+	render_count(&render->stats.inputs, &render->stats.input_time,
+			&render->stats.input_max, elapsed);
+	g_mutex_unlock(&render->mutex);
+}
+
+/**
+ * @brief Reads the timing counters.
+ *
+ * @param render Render instance
+ * @param stats output counters
+ */
+void render_get_stats(Render *render, RenderStats *stats) {
+	g_mutex_lock(&render->mutex);
+	*stats = render->stats;
+	g_mutex_unlock(&render->mutex);
+}
@@ -103,9 +103,13 @@ ResultsDialog *results_dialog_new(Backgammon *bg, Player *winner, guint winner_s
 	dialog->total_pl1_label = GTK_LABEL(gtk_builder_get_object(builder, "total-pl1-label"));
 	dialog->total_pl2_label = GTK_LABEL(gtk_builder_get_object(builder, "total-pl2-label"));
 
+	// The dice of the game, to replay it
 	str = g_string_new("");
 	g_string_append_printf(str, _("%s wins the round with %u points"),
 			dialog->winner->name->str, dialog->winner_score);
+	g_string_append_c(str, '\n');
+	g_string_append_printf(str, _("Dice: --seed %llu --game %u"),
+			(unsigned long long) bg->seed, bg->game);
 	gtk_label_set_text(dialog->winner_label, str->str);
 
 	str = g_string_assign(str, "");
@@ -0,0 +1,229 @@
+/**
+ * @file rollout_dialog.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Implementation of rollout_dialog.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <rollout_dialog.h>
+#include <utils.h>
+
+#include <core/search.h>
+
+#include <libintl.h>
+
+#define _(str)		gettext(str)
+
+/**
+ * @brief Appends a play in the usual notation, with the places numbered
+ * from the point of view of the player: 24/18 13/10, bar/22, 3/off.
+ *
+ * @param str output string
+ * @param play the play
+ * @param direction direction of the player
+ */
+static void append_play(GString *str, const Play *play, gint direction) {
+	guint i;
+	Movement m;
+
+	if (!play->count) {
+		g_string_append(str, _("No move"));
+		return;
+	}
+
+	for (i = 0; i < play->count; i ++) {
+		m = play->moves[i];
+		if (i) g_string_append_c(str, ' ');
+
+		if (MOVEMENT_PRISON_SRC(m)) g_string_append(str, "bar");
+		else g_string_append_printf(str, "%d", PLACE_STEPS(direction, MOVEMENT_SRC(m)));
+
+		if (MOVEMENT_GOAL_DEST(m)) g_string_append(str, "/off");
+		else g_string_append_printf(str, "/%d", PLACE_STEPS(direction, MOVEMENT_DEST(m)));
+	}
+}
+
+/**
+ * @brief Shows the results so far. Called periodically while the rollout runs.
+ *
+ * @param data Instance of RolloutDialog
+ * @return gboolean G_SOURCE_REMOVE when the rollout is done
+ */
+static gboolean rollout_dialog_update(gpointer data) {
+	RolloutDialog *dialog = (RolloutDialog *) data;
+	RolloutResult results[ROLLOUT_CANDIDATES];
+	GString *str;
+	gboolean done;
+	guint i;
+
+	done = rollout_done(dialog->rollout);
+	rollout_results(dialog->rollout, results);
+
+	str = g_string_new("");
+	for (i = 0; i < dialog->count; i ++) {
+		// Candidates after a play are seen from the opponent
+		if (dialog->with_plays) {
+			eval_invert(&results[i].eval);
+			results[i].equity = -results[i].equity;
+
+			g_string_append_printf(str, "%u. ", i + 1);
+			append_play(str, &dialog->plays[i], dialog->direction);
+			g_string_append_c(str, '\n');
+		}
+
+		g_string_append_printf(str, _("   Equity %+.3f ± %.3f (%lu games)\n"),
+				results[i].equity, results[i].equity_error,
+				(unsigned long) results[i].trials);
+		g_string_append_printf(str, _("   Win %.1f%%  Gammon %.1f%%  Backgammon %.1f%%\n"),
+				100.0 * results[i].eval.out[EVAL_WIN],
+				100.0 * results[i].eval.out[EVAL_WIN_GAMMON],
+				100.0 * results[i].eval.out[EVAL_WIN_BACKGAMMON]);
+		g_string_append_printf(str, _("   Lose gammon %.1f%%  Lose backgammon %.1f%%\n"),
+				100.0 * results[i].eval.out[EVAL_LOSE_GAMMON],
+				100.0 * results[i].eval.out[EVAL_LOSE_BACKGAMMON]);
+	}
+
+	gtk_label_set_text(dialog->results_label, str->str);
+	g_string_free(str, TRUE);
+
+	if (!done) return G_SOURCE_CONTINUE;
+
+	gtk_button_set_label(dialog->stop_button, _("Close"));
+	dialog->timer = 0;
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * @brief Frees the RolloutDialog, stopping the rollout.
+ *
+ * @param dialog Instance of RolloutDialog
+ */
+static void rollout_dialog_free(RolloutDialog *dialog) {
+	if (dialog->timer) g_source_remove(dialog->timer);
+	rollout_free(dialog->rollout);
+	g_free(dialog);
+}
+
+/**
+ * @brief Occurs when the window is closed.
+ *
+ * @param window Window instance
+ * @param data Instance of RolloutDialog
+ */
+static void rollout_dialog_destroy(GtkWindow *window, gpointer data) {
+	rollout_dialog_free((RolloutDialog *) data);
+}
+
+/**
+ * @brief Occurs when the Stop button is clicked: stops the rollout, or
+ * closes the dialog if it is already done.
+ *
+ * @param button Button instance
+ * @param data Instance of RolloutDialog
+ */
+static void rollout_dialog_stop_clicked(GtkButton *button, gpointer data) {
+	RolloutDialog *dialog = (RolloutDialog *) data;
+
+	if (dialog->timer) {
+		rollout_stop(dialog->rollout);
+		return;
+	}
+
+	gtk_widget_destroy(GTK_WIDGET(dialog->window));
+}
+
+/**
+ * @brief Creates a RolloutDialog and starts the rollout of the current
+ * decision: the best plays of the dice just rolled, or the position
+ * before the roll.
+ *
+ * @param bg Instance of Backgammon
+ * @return RolloutDialog* RolloutDialog instance, NULL if there is nothing to analyze
+ */
+RolloutDialog *rollout_dialog_new(Backgammon *bg) {
+	RolloutDialog *dialog;
+	GtkBuilder *builder;
+	SearchOptions search;
+	RolloutOptions opts;
+	Position pos, candidates[ROLLOUT_CANDIDATES];
+	Eval evals[ROLLOUT_CANDIDATES];
+	Game *game = &bg->board->game;
+	gboolean fresh_dice;
+	guint i;
+
+	fresh_dice = TRUE;
+	for (i = 0; i < 4; i ++)
+		if (game->consumed_dice[i]) fresh_dice = FALSE;
+
+	if (bg->status != S_ROLL_DICE && !(bg->status == S_MOVE_PIECES && fresh_dice)) {
+		information(GTK_WIDGET(bg->window), _("Nothing to analyze now."));
+		return NULL;
+	}
+
+	dialog = (RolloutDialog *) g_malloc(sizeof(RolloutDialog));
+	dialog->bg = bg;
+	dialog->timer = 0;
+	dialog->direction = game->direction;
+	dialog->with_plays = bg->status == S_MOVE_PIECES;
+
+	position_from_game(&pos, game);
+
+	if (dialog->with_plays) {
+		// Best plays at 1-ply, each one rolled out from the opponent's turn
+		search_options_init(&search);
+		search.evaluate = bg->evaluate;
+		search.cache = bg->cache;
+		dialog->count = search_rank_plays(&pos, game->dice[0], game->dice[1],
+				&search, dialog->plays, evals, ROLLOUT_CANDIDATES);
+
+		for (i = 0; i < dialog->count; i ++) {
+			candidates[i] = pos;
+			movegen_apply_position(&candidates[i], &dialog->plays[i]);
+			position_switch_turn(&candidates[i]);
+		}
+	} else {
+		dialog->count = 1;
+		candidates[0] = pos;
+	}
+
+	rollout_options_init(&opts);
+	opts.trials = 0;
+	opts.evaluate = bg->evaluate;
+	opts.seed = g_random_int();
+
+	dialog->rollout = rollout_start(candidates, dialog->count, &opts);
+	if (!dialog->rollout) {
+		g_free(dialog);
+		return NULL;
+	}
+
+	builder = gtk_builder_new();
+	gtk_builder_add_from_file(builder, "ui/rollout.glade", NULL);
+
+	dialog->window = GTK_WINDOW(gtk_builder_get_object(builder, "rollout-window"));
+	gtk_window_set_transient_for(dialog->window, GTK_WINDOW(bg->window));
+
+	dialog->results_label = GTK_LABEL(gtk_builder_get_object(builder, "rollout-label"));
+
+	dialog->stop_button = GTK_BUTTON(gtk_builder_get_object(builder, "stop-button"));
+	g_signal_connect(dialog->stop_button, "clicked", G_CALLBACK(rollout_dialog_stop_clicked), dialog);
+
+	g_signal_connect(dialog->window, "destroy", G_CALLBACK(rollout_dialog_destroy), dialog);
+
+	g_object_unref(builder);
+
+	dialog->timer = g_timeout_add(ROLLOUT_REFRESH_TIMEOUT, rollout_dialog_update, dialog);
+
+	return dialog;
+}
+
+/**
+ * @brief Shows the RolloutDialog.
+ *
+ * @param dialog Instance of RolloutDialog
+ */
+void rollout_dialog_show(RolloutDialog *dialog) {
+	gtk_widget_show_all(GTK_WIDGET(dialog->window));
+}
@@ -21,9 +21,14 @@ void undo_backup(void *bgp) {
 	guint i;
 	bg = (Backgammon *) bgp;
 
-	for (i = 0; i < 24; i ++) bg->undo.places[i] = bg->board->places[i].data;
-	for (i = 0; i < 2; i ++) bg->undo.prison[i] = bg->board->prison[i];
-	for (i = 0; i < 2; i ++) bg->undo.goal[i] = bg->board->goal[i].data;
+	for (i = 0; i < 24; i ++) bg->undo.places[i] = bg->board->game.places[i];
+	for (i = 0; i < 2; i ++) bg->undo.prison[i] = bg->board->game.prison[i];
+	for (i = 0; i < 2; i ++) bg->undo.goal[i] = bg->board->game.goal[i];
+
+	// Counters and key, so the restore does not need to recount them
+	for (i = 0; i < 2; i ++) bg->undo.steps[i] = bg->board->game.steps[i];
+	for (i = 0; i < 2; i ++) bg->undo.outside[i] = bg->board->game.outside[i];
+	bg->undo.hash = bg->board->game.hash;
 }
 
 /**
@@ -36,10 +41,13 @@ void undo_restore(void *bgp) {
 	guint i;
 	bg = (Backgammon *) bgp;
 	// Restore dice
-	for (i = 0; i < 4; i ++) bg->board->consumed_dice[i] = FALSE;
+	for (i = 0; i < 4; i ++) bg->board->game.consumed_dice[i] = FALSE;
 
 	// Restore board
-	for (i = 0; i < 24; i ++) bg->board->places[i].data = bg->undo.places[i];
-	for (i = 0; i < 2; i ++) bg->board->prison[i] = bg->undo.prison[i];
-	for (i = 0; i < 2; i ++) bg->board->goal[i].data = bg->undo.goal[i];
+	for (i = 0; i < 24; i ++) bg->board->game.places[i] = bg->undo.places[i];
+	for (i = 0; i < 2; i ++) bg->board->game.prison[i] = bg->undo.prison[i];
+	for (i = 0; i < 2; i ++) bg->board->game.goal[i] = bg->undo.goal[i];
+	for (i = 0; i < 2; i ++) bg->board->game.steps[i] = bg->undo.steps[i];
+	for (i = 0; i < 2; i ++) bg->board->game.outside[i] = bg->undo.outside[i];
+	bg->board->game.hash = bg->undo.hash;
 }
@@ -0,0 +1,67 @@
+/**
+ * @file bgbearoff.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Builds the one-sided and the two-sided bearoff databases
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/bearoff.h>
+#include <core/bearoff2.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_DIR		"data"
+
+/**
+ * @brief Monotonic clock in seconds.
+ *
+ * @return double seconds
+ */
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+	const char *dir = DEFAULT_DIR;
+	char path[1024];
+	unsigned threads = 0;
+	double start;
+	int c;
+
+	while ((c = getopt(argc, argv, "d:t:")) != -1) {
+		switch (c) {
+			case 'd': dir = optarg; break;
+			case 't': threads = atoi(optarg); break;
+			default:
+				fprintf(stderr, "usage: bgbearoff [-d DIR] [-t THREADS]\n");
+				return 1;
+		}
+	}
+
+	start = now();
+	snprintf(path, sizeof(path), "%s/bearoff.db", dir);
+	if (!bearoff_build(path, threads)) {
+		fprintf(stderr, "bgbearoff: cannot write %s\n", path);
+		return 1;
+	}
+	printf("bgbearoff: %u positions written to %s in %.1f s\n",
+			BEAROFF_POSITIONS, path, now() - start);
+
+	start = now();
+	snprintf(path, sizeof(path), "%s/bearoff2.db", dir);
+	if (!bearoff2_build(path, threads)) {
+		fprintf(stderr, "bgbearoff: cannot write %s\n", path);
+		return 1;
+	}
+	printf("bgbearoff: %u positions written to %s in %.1f s\n",
+			BEAROFF2_POSITIONS, path, now() - start);
+
+	return 0;
+}
@@ -0,0 +1,513 @@
+/**
+ * @file bgbench.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Headless benchmarks of the rules core
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/bearoff.h>
+#include <core/bearoff2.h>
+#include <core/cache.h>
+#include <core/game.h>
+#include <core/mcts.h>
+#include <core/movegen.h>
+#include <core/nnet.h>
+#include <core/position.h>
+#include <core/rng.h>
+#include <core/rollout.h>
+#include <core/search.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define SAMPLE_POSITIONS	20000
+#define REPEAT				5
+#define SEARCH_POSITIONS	2000
+
+/**
+ * @brief Monotonic clock in seconds.
+ *
+ * @return double seconds
+ */
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Collects positions with rolled dice from random games.
+ *
+ * @param positions output buffer
+ * @param count number of positions to collect
+ * @param plays scratch buffer of MOVEGEN_MAX_PLAYS plays
+ */
+static void sample_positions(Game positions[], unsigned count, Play plays[]) {
+	Game game;
+	unsigned i, n;
+
+	game_reset(&game);
+	game_init(&game);
+
+	for (i = 0; i < count; i ++) {
+		if (game_winner(&game)) {
+			game_init(&game);
+			game.direction = 1;
+		}
+
+		game_set_dice(&game, rand() % 6 + 1, rand() % 6 + 1);
+		positions[i] = game;
+
+		n = movegen_generate(&game, plays);
+		movegen_apply(&game, &plays[rand() % n]);
+		game.direction = -game.direction;
+	}
+}
+
+/**
+ * @brief Measures full-turn move generation in plays/sec.
+ *
+ * @param positions sampled positions
+ * @param count number of positions
+ * @param plays scratch buffer of MOVEGEN_MAX_PLAYS plays
+ */
+static void bench_movegen(const Game positions[], unsigned count, Play plays[]) {
+	unsigned i, r;
+	unsigned long total = 0;
+	double start, elapsed;
+
+	start = now();
+	for (r = 0; r < REPEAT; r ++)
+		for (i = 0; i < count; i ++)
+			total += movegen_generate(&positions[i], plays);
+	elapsed = now() - start;
+
+	printf("movegen: %u positions, %.2f plays/position\n",
+			count, (double) total / (count * REPEAT));
+	printf("movegen: %.0f positions/sec, %.0f plays/sec\n",
+			count * REPEAT / elapsed, total / elapsed);
+}
+
+/**
+ * @brief Measures single movements applied and reverted on a Position.
+ *
+ * @param positions sampled positions
+ * @param count number of positions
+ */
+static void bench_make_unmake(const Game positions[], unsigned count) {
+	MoveList list;
+	Position pos;
+	unsigned i, j, r;
+	unsigned long total = 0;
+	double start, elapsed;
+	int hit;
+
+	start = now();
+	for (r = 0; r < REPEAT; r ++) {
+		for (i = 0; i < count; i ++) {
+			game_scan_movements(&positions[i], &list);
+			position_from_game(&pos, &positions[i]);
+
+			for (j = 0; j < list.count; j ++) {
+				hit = position_make_move(&pos, list.moves[j]);
+				position_unmake_move(&pos, list.moves[j], hit);
+			}
+			total += list.count;
+		}
+	}
+	elapsed = now() - start;
+
+	printf("position: %.0f make/unmake pairs/sec (scan included)\n", total / elapsed);
+}
+
+/**
+ * @brief Measures cache lookups keyed by the sampled positions, storing on
+ * every miss, and reports the hit rate.
+ *
+ * @param positions sampled positions
+ * @param count number of positions
+ */
+static void bench_cache(const Game positions[], unsigned count) {
+	CacheStats stats, counts = {0, 0, 0, 0};
+	Cache *cache;
+	Eval ev = {{0.5f, 0.1f, 0.0f, 0.1f, 0.0f}};
+	unsigned i, r;
+	uint64_t key;
+	double start, elapsed;
+
+	cache = cache_new(1 << 22);
+	if (!cache) return;
+
+	start = now();
+	for (r = 0; r < REPEAT; r ++) {
+		for (i = 0; i < count; i ++) {
+			key = game_hash(&positions[i]);
+			counts.lookups ++;
+			if (cache_lookup(cache, key, 0, &ev)) counts.hits ++;
+			else counts.stores += cache_store(cache, key, 0, &ev);
+		}
+	}
+	elapsed = now() - start;
+	cache_add_stats(cache, &counts);
+
+	cache_stats(cache, &stats);
+	printf("cache: %zu entries, %.0f lookups/sec, %.1f%% hits\n", stats.entries,
+			stats.lookups / elapsed, 100.0 * stats.hits / stats.lookups);
+
+	cache_free(cache);
+}
+
+/**
+ * @brief Measures the search in nodes/sec for a depth.
+ *
+ * @param positions sampled positions
+ * @param count number of positions
+ * @param depth search depth
+ * @param threads threads of the search (0: one per core)
+ */
+static void bench_search(const Game positions[], unsigned count, unsigned depth,
+		unsigned threads) {
+	SearchOptions opts;
+	SearchResult res;
+	Position pos;
+	unsigned i;
+	uint64_t nodes = 0;
+	double elapsed = 0.0;
+
+	search_options_init(&opts);
+	opts.depth = depth;
+	opts.threads = threads;
+
+	for (i = 0; i < count; i ++) {
+		position_from_game(&pos, &positions[i]);
+		search_best_play(&pos, positions[i].dice[0], positions[i].dice[1], &opts, &res);
+		nodes += res.nodes;
+		elapsed += res.seconds;
+	}
+
+	printf("search %u-ply%s: %u positions, %.0f nodes/position, %.0f nodes/sec, %.2f ms/position\n",
+			depth, threads == 1 ? "" : " (all cores)", count, (double) nodes / count,
+			nodes / elapsed, 1000.0 * elapsed / count);
+}
+
+/**
+ * @brief Measures the Monte Carlo tree search: simulations per second
+ * with a fresh tree for each position.
+ *
+ * @param positions sampled positions
+ * @param count number of positions
+ * @param simulations simulations per position
+ * @param threads threads of the search, 0 for one per core
+ */
+static void bench_mcts(const Game positions[], unsigned count, uint64_t simulations,
+		unsigned threads) {
+	MctsOptions opts;
+	MctsResult res;
+	Position pos;
+	Mcts *mcts;
+	unsigned i;
+	uint64_t total = 0;
+	double elapsed = 0.0;
+
+	mcts = mcts_new(MCTS_DEFAULT_MEMORY);
+	if (!mcts) return;
+
+	mcts_options_init(&opts);
+	opts.budget = 0.0;
+	opts.simulations = simulations;
+	opts.threads = threads;
+
+	for (i = 0; i < count; i ++) {
+		position_from_game(&pos, &positions[i]);
+		mcts_clear(mcts);
+		mcts_search(mcts, &pos, positions[i].dice[0], positions[i].dice[1], &opts, &res);
+		total += res.simulations;
+		elapsed += res.seconds;
+	}
+
+	printf("mcts%s: %u positions, %.0f simulations/sec, %.2f ms/position\n",
+			threads == 1 ? "" : " (all cores)", count, total / elapsed,
+			1000.0 * elapsed / count);
+
+	mcts_free(mcts);
+}
+
+/**
+ * @brief Measures the dice generator of the games and rollouts, and how
+ * far the frequencies of the 6 values are from 1/6.
+ *
+ * @param count number of dice
+ */
+static void bench_dice(unsigned long count) {
+	unsigned long hits[7] = {0}, i;
+	double start, elapsed, dev = 0.0, f;
+	Rng rng;
+
+	rng_seed(&rng, 1, 0);
+
+	start = now();
+	for (i = 0; i < count; i ++) hits[rng_die(&rng)] ++;
+	elapsed = now() - start;
+
+	for (i = 1; i <= 6; i ++) {
+		f = (double) hits[i] / count - 1.0 / 6.0;
+		if (f < 0) f = -f;
+		if (f > dev) dev = f;
+	}
+
+	printf("dice: %.0f dice/sec, largest frequency deviation %.5f%%\n",
+			count / elapsed, 100.0 * dev);
+}
+
+/**
+ * @brief Measures rollouts of the opening position on every core.
+ *
+ * @param trials number of games
+ */
+static void bench_rollout(unsigned trials) {
+	RolloutOptions opts;
+	RolloutResult res;
+	Position pos;
+	Game game;
+	double start, elapsed;
+
+	game_reset(&game);
+	game_init(&game);
+	position_from_game(&pos, &game);
+
+	rollout_options_init(&opts);
+	opts.trials = trials;
+
+	start = now();
+	if (!rollout_run(&pos, 1, &opts, &res)) return;
+	elapsed = now() - start;
+
+	printf("rollout: %u games, %.0f games/sec, equity %+.3f +- %.3f, win %.1f%%\n",
+			trials, trials / elapsed, res.equity, res.equity_error,
+			100.0 * res.eval.out[EVAL_WIN]);
+}
+
+/**
+ * @brief Measures the network evaluator on the sampled positions, with
+ * random weights of the usual size.
+ *
+ * @param positions sampled positions
+ * @param count number of positions
+ * @param hidden size of the hidden layer
+ */
+static void bench_nnet(const Game positions[], unsigned count, unsigned hidden) {
+	Position pos;
+	NNet *net;
+	Eval ev;
+	unsigned i, r;
+	double start, elapsed, sum = 0.0;
+
+	net = nnet_new(hidden, 1);
+	if (!net) return;
+
+	start = now();
+	for (r = 0; r < REPEAT; r ++) {
+		for (i = 0; i < count; i ++) {
+			position_from_game(&pos, &positions[i]);
+			nnet_evaluate(net, &pos, &ev);
+			sum += ev.out[EVAL_WIN];
+		}
+	}
+	elapsed = now() - start;
+
+	printf("nnet: %u hidden, %.0f positions/ms (checksum %.3f)\n",
+			hidden, count * REPEAT / elapsed / 1000.0, sum / (count * REPEAT));
+
+	nnet_free(net);
+}
+
+/**
+ * @brief Measures batched network evaluations by batch size. The positions
+ * after the plays of each sampled roll, the candidates a search compares,
+ * are evaluated in batches of each size with eval_batch.
+ *
+ * @param positions sampled positions
+ * @param count number of positions
+ * @param hidden size of the hidden layer
+ */
+static void bench_batch(const Game positions[], unsigned count, unsigned hidden) {
+	static const unsigned sizes[] = {1, 2, 4, 8, 16, 32, 64};
+	Play *plays;
+	Position pos, *children;
+	Eval *evals;
+	NNet *net;
+	unsigned i, j, k, n, *first, total = 0;
+	double start, elapsed, sum;
+
+	net = nnet_new(hidden, 1);
+	first = malloc(sizeof(unsigned) * (count + 1));
+	plays = malloc(sizeof(Play) * MOVEGEN_MAX_PLAYS);
+	if (!net || !first || !plays) goto done;
+
+	// The candidates of every roll, one after the other
+	for (i = 0; i < count; i ++) total += movegen_generate(&positions[i], plays);
+	children = malloc(sizeof(Position) * total);
+	evals = malloc(sizeof(Eval) * total);
+	if (!children || !evals) {
+		free(children);
+		free(evals);
+		goto done;
+	}
+
+	for (i = 0, total = 0; i < count; i ++) {
+		position_from_game(&pos, &positions[i]);
+		n = movegen_plays(&pos, positions[i].dice[0], positions[i].dice[1], plays);
+		movegen_children(&pos, plays, n, children + total);
+		first[i] = total;
+		total += n;
+	}
+	first[count] = total;
+
+	nnet_set_current(net);
+	for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k ++) {
+		sum = 0.0;
+		start = now();
+		for (i = 0; i < count; i ++) {
+			for (j = first[i]; j < first[i + 1]; j += n) {
+				n = first[i + 1] - j < sizes[k] ? first[i + 1] - j : sizes[k];
+				eval_batch(eval_nnet, children + j, n, evals + j);
+			}
+		}
+		elapsed = now() - start;
+
+		for (j = 0; j < total; j ++) sum += evals[j].out[EVAL_WIN];
+		printf("nnet batch %2u: %.0f positions/ms (checksum %.3f)\n",
+				sizes[k], total / elapsed / 1000.0, sum / total);
+	}
+	nnet_set_current(NULL);
+
+	free(children);
+	free(evals);
+
+done:
+	free(plays);
+	free(first);
+	nnet_free(net);
+}
+
+/**
+ * @brief Measures exact evaluations of random bearoff positions, if the
+ * database has been built.
+ *
+ * @param count number of positions
+ */
+static void bench_bearoff(unsigned count) {
+	Bearoff *db;
+	Position *positions;
+	Eval ev;
+	unsigned i, j, r, left[2];
+	double start, elapsed, sum = 0.0;
+
+	db = bearoff_open("data/bearoff.db");
+	if (!db) {
+		printf("bearoff: data/bearoff.db not built, skipped\n");
+		return;
+	}
+
+	positions = calloc(count, sizeof(Position));
+	if (!positions) {
+		bearoff_close(db);
+		return;
+	}
+
+	for (i = 0; i < count; i ++) {
+		positions[i].turn = rand() % 2 ? 1 : -1;
+		left[0] = left[1] = 15;
+		for (j = 0; j < 6; j ++) {
+			r = rand() % 4;
+			if (r > left[0]) r = left[0];
+			positions[i].points[j] = -(int) r;
+			left[0] -= r;
+
+			r = rand() % 4;
+			if (r > left[1]) r = left[1];
+			positions[i].points[23 - j] = r;
+			left[1] -= r;
+		}
+		positions[i].off[0] = left[0];
+		positions[i].off[1] = left[1];
+	}
+
+	start = now();
+	for (r = 0; r < REPEAT; r ++) {
+		for (i = 0; i < count; i ++) {
+			bearoff_evaluate(db, &positions[i], &ev);
+			sum += ev.out[EVAL_WIN];
+		}
+	}
+	elapsed = now() - start;
+
+	printf("bearoff: %.0f evaluations/sec (checksum %.3f)\n",
+			count * REPEAT / elapsed, sum / (count * REPEAT));
+
+	free(positions);
+	bearoff_close(db);
+}
+
+/**
+ * @brief Measures random lookups in the two-sided bearoff database, if it
+ * has been built.
+ *
+ * @param count number of lookups
+ */
+static void bench_bearoff2(unsigned count) {
+	Bearoff2 *db;
+	unsigned i, r;
+	double start, elapsed, sum = 0.0;
+
+	db = bearoff2_open("data/bearoff2.db");
+	if (!db) {
+		printf("bearoff2: data/bearoff2.db not built, skipped\n");
+		return;
+	}
+
+	start = now();
+	for (r = 0; r < REPEAT; r ++)
+		for (i = 0; i < count; i ++)
+			sum += bearoff2_lookup(db, rand() % BEAROFF2_SIDE, rand() % BEAROFF2_SIDE);
+	elapsed = now() - start;
+
+	printf("bearoff2: %.0f lookups/sec (checksum %.3f)\n",
+			count * REPEAT / elapsed, sum / (count * REPEAT));
+
+	bearoff2_close(db);
+}
+
+int main(int argc, char *argv[]) {
+	Game *positions;
+	Play *plays;
+
+	srand(argc > 1 ? atoi(argv[1]) : 1);
+
+	positions = malloc(sizeof(Game) * SAMPLE_POSITIONS);
+	plays = malloc(sizeof(Play) * MOVEGEN_MAX_PLAYS);
+
+	sample_positions(positions, SAMPLE_POSITIONS, plays);
+	bench_movegen(positions, SAMPLE_POSITIONS, plays);
+	bench_make_unmake(positions, SAMPLE_POSITIONS);
+	bench_cache(positions, SAMPLE_POSITIONS);
+	bench_nnet(positions, SAMPLE_POSITIONS, 128);
+	bench_batch(positions, SEARCH_POSITIONS, 128);
+	bench_bearoff(SAMPLE_POSITIONS);
+	bench_bearoff2(SAMPLE_POSITIONS);
+	bench_search(positions, SEARCH_POSITIONS, 1, 1);
+	bench_search(positions, SEARCH_POSITIONS / 20, 2, 1);
+	bench_search(positions, SEARCH_POSITIONS / 20, 2, 0);
+	bench_mcts(positions, SEARCH_POSITIONS / 20, 2000, 1);
+	bench_mcts(positions, SEARCH_POSITIONS / 20, 2000, 0);
+	bench_dice(100000000UL);
+	bench_rollout(2000);
+
+	free(plays);
+	free(positions);
+
+	return 0;
+}
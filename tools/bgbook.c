@@ -0,0 +1,118 @@
+/**
+ * @file bgbook.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Builds the opening book by rollouts on all the cores
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/bearoff.h>
+#include <core/bearoff2.h>
+#include <core/book.h>
+#include <core/nnet.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_DIR		"data"
+
+/**
+ * @brief Monotonic clock in seconds.
+ *
+ * @return double seconds
+ */
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Prints the rolls done so far.
+ *
+ * @param done rolls done
+ * @param total rolls of the book
+ */
+static void progress(unsigned done, unsigned total) {
+	printf("\rbgbook: %u/%u rolls", done, total);
+	fflush(stdout);
+}
+
+/**
+ * @brief Prints the command-line options.
+ */
+static void usage(void) {
+	fprintf(stderr,
+		"usage: bgbook [options]\n"
+		"  -d DIR   data directory (default " DEFAULT_DIR ")\n"
+		"  -n N     games per candidate (default 1296)\n"
+		"  -c N     candidates per roll (default 4, at most %d)\n"
+		"  -p N     plies of the search that ranks the candidates (default 2)\n"
+		"  -t N     threads (default 0: one per core)\n"
+		"  -s SEED  random seed (default 1)\n",
+		BOOK_MAX_CANDIDATES);
+}
+
+int main(int argc, char *argv[]) {
+	BookOptions opts;
+	const char *dir = DEFAULT_DIR;
+	char path[1024];
+	NNet *net;
+	Bearoff *bearoff;
+	Bearoff2 *bearoff2;
+	double start;
+	int c;
+
+	book_options_init(&opts);
+	opts.progress = progress;
+
+	while ((c = getopt(argc, argv, "d:n:c:p:t:s:")) != -1) {
+		switch (c) {
+			case 'd': dir = optarg; break;
+			case 'n': opts.rollout.trials = atoi(optarg); break;
+			case 'c': opts.candidates = atoi(optarg); break;
+			case 'p': opts.depth = atoi(optarg); break;
+			case 't': opts.rollout.threads = atoi(optarg); break;
+			case 's': opts.rollout.seed = strtoull(optarg, NULL, 10); break;
+			default: usage(); return 1;
+		}
+	}
+	if (!opts.rollout.trials) {
+		usage();
+		return 1;
+	}
+
+	// The strongest evaluator available plays the rollouts
+	snprintf(path, sizeof(path), "%s/bgnn.weights", dir);
+	net = nnet_load(path);
+	nnet_set_current(net);
+	if (net) opts.rollout.evaluate = eval_nnet;
+
+	snprintf(path, sizeof(path), "%s/bearoff.db", dir);
+	bearoff = bearoff_open(path);
+	bearoff_set_current(bearoff);
+	snprintf(path, sizeof(path), "%s/bearoff2.db", dir);
+	bearoff2 = bearoff2_open(path);
+	bearoff2_set_current(bearoff2);
+
+	printf("bgbook: %s evaluator, %u games per candidate\n",
+			net ? "network" : "heuristic", opts.rollout.trials);
+
+	start = now();
+	snprintf(path, sizeof(path), "%s/book.db", dir);
+	c = book_build(path, &opts) ? 0 : 1;
+	if (c) fprintf(stderr, "\nbgbook: cannot write %s\n", path);
+	else printf("\nbgbook: written to %s in %.1f s\n", path, now() - start);
+
+	nnet_set_current(NULL);
+	nnet_free(net);
+	bearoff_set_current(NULL);
+	bearoff_close(bearoff);
+	bearoff2_set_current(NULL);
+	bearoff2_close(bearoff2);
+
+	return c;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file bgsim.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Estimates the equity of a position by simulation on all the
+ * cores, with variance reduction, until a precision is reached
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/bearoff.h>
+#include <core/bearoff2.h>
+#include <core/game.h>
+#include <core/nnet.h>
+#include <core/rollout.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_DIR		"data"
+
+/**
+ * @brief Monotonic clock in seconds.
+ *
+ * @return double seconds
+ */
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Prints the command-line options.
+ */
+static void usage(void) {
+	fprintf(stderr,
+		"usage: bgsim [options]\n"
+		"  -p POS   24 comma-separated counts of the places, positive for the\n"
+		"           pieces of direction 1 and negative for direction -1, then\n"
+		"           optionally those on the bar of -1 and of 1 (default: opening)\n"
+		"  -m DIR   direction to move: 1 or -1 (default -1)\n"
+		"  -e SE    standard error of the equity to reach (default 0.01)\n"
+		"  -n N     most games (default 0: until the precision)\n"
+		"  -v N     variance reduction: 0 none, 1 stratified first rolls,\n"
+		"           2 stratified and luck adjusted (default 2)\n"
+		"  -d DIR   data directory (default " DEFAULT_DIR ")\n"
+		"  -t N     threads (default 0: one per core)\n"
+		"  -s SEED  random seed (default 1)\n");
+}
+
+/**
+ * @brief Reads a position: the places and, optionally, the bars. The
+ * pieces not on the board are borne off.
+ *
+ * @param text comma-separated counts
+ * @param game output rules state
+ * @return int 0, or 1 on error
+ */
+static int parse_position(const char *text, Game *game) {
+	int values[26] = {0}, side, count[2] = {0, 0};
+	unsigned n = 0;
+	const char *p = text;
+	char *end;
+
+	while (*p && n < 26) {
+		values[n ++] = (int) strtol(p, &end, 10);
+		if (end == p) return 1;
+		p = *end == ',' ? end + 1 : end;
+	}
+	if (*p || (n != 24 && n != 26)) return 1;
+
+	game_reset(game);
+	for (n = 0; n < 24; n ++) {
+		game->places[n] = values[n];
+		count[values[n] > 0] += abs(values[n]);
+	}
+
+	// Bar and goal counts carry the sign of their direction
+	game->prison[PRISON_OF(-1)] = -abs(values[24]);
+	game->prison[PRISON_OF(1)] = abs(values[25]);
+	count[0] += abs(values[24]);
+	count[1] += abs(values[25]);
+
+	for (side = 0; side < 2; side ++) {
+		if (count[side] > 15) return 1;
+		game->goal[GOAL_OF(side ? 1 : -1)] = (side ? 1 : -1) * (15 - count[side]);
+	}
+
+	game_update_counters(game);
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	RolloutOptions opts;
+	RolloutResult res;
+	Rollout *rollout;
+	Game game;
+	Position pos;
+	const char *dir = DEFAULT_DIR, *text = NULL;
+	char path[1024];
+	NNet *net;
+	Bearoff *bearoff;
+	Bearoff2 *bearoff2;
+	double start, elapsed, plain;
+	int c, turn = -1, level = 2;
+
+	rollout_options_init(&opts);
+	opts.trials = 0;
+	opts.precision = 0.01f;
+
+	while ((c = getopt(argc, argv, "p:m:e:n:v:d:t:s:")) != -1) {
+		switch (c) {
+			case 'p': text = optarg; break;
+			case 'm': turn = atoi(optarg); break;
+			case 'e': opts.precision = atof(optarg); break;
+			case 'n': opts.trials = atoi(optarg); break;
+			case 'v': level = atoi(optarg); break;
+			case 'd': dir = optarg; break;
+			case 't': opts.threads = atoi(optarg); break;
+			case 's': opts.seed = strtoull(optarg, NULL, 10); break;
+			default: usage(); return 1;
+		}
+	}
+	if ((turn != 1 && turn != -1) || level < 0 || level > 2
+			|| (!opts.trials && opts.precision <= 0.0f)) {
+		usage();
+		return 1;
+	}
+
+	if (text) {
+		if (parse_position(text, &game)) {
+			fprintf(stderr, "bgsim: invalid position %s\n", text);
+			return 1;
+		}
+	} else {
+		game_reset(&game);
+		game_init(&game);
+	}
+	game.direction = turn;
+	position_from_game(&pos, &game);
+
+	opts.stratify = level >= 1;
+	opts.luck = level >= 2;
+
+	// The strongest evaluator available plays the games
+	snprintf(path, sizeof(path), "%s/bgnn.weights", dir);
+	net = nnet_load(path);
+	nnet_set_current(net);
+	if (net) opts.evaluate = eval_nnet;
+
+	snprintf(path, sizeof(path), "%s/bearoff.db", dir);
+	bearoff = bearoff_open(path);
+	bearoff_set_current(bearoff);
+	snprintf(path, sizeof(path), "%s/bearoff2.db", dir);
+	bearoff2 = bearoff2_open(path);
+	bearoff2_set_current(bearoff2);
+
+	printf("bgsim: %s evaluator, %s, standard error %.4f\n",
+			net ? "network" : "heuristic",
+			level == 2 ? "stratified and luck adjusted" : level ? "stratified" : "plain",
+			opts.precision);
+
+	start = now();
+	rollout = rollout_start(&pos, 1, &opts);
+	if (!rollout) {
+		fprintf(stderr, "bgsim: out of memory\n");
+		return 1;
+	}
+
+	// Stops by itself at the precision or the number of games
+	while (!rollout_done(rollout)) {
+		usleep(500000);
+		rollout_results(rollout, &res);
+		printf("\rbgsim: %llu games, equity %+.4f +/- %.4f   ",
+				(unsigned long long) res.trials, res.equity, res.equity_error);
+		fflush(stdout);
+	}
+	rollout_results(rollout, &res);
+	rollout_free(rollout);
+	elapsed = now() - start;
+
+	printf("\n\nEquity:  %+.4f +/- %.4f (%llu games, %.1f s, %.0f games/s)\n",
+			res.equity, res.equity_error, (unsigned long long) res.trials,
+			elapsed, res.trials / elapsed);
+	printf("Win:     %.2f%% (gammon %.2f%%, backgammon %.2f%%)\n",
+			100.0 * res.eval.out[EVAL_WIN], 100.0 * res.eval.out[EVAL_WIN_GAMMON],
+			100.0 * res.eval.out[EVAL_WIN_BACKGAMMON]);
+	printf("Lose:    %.2f%% (gammon %.2f%%, backgammon %.2f%%)\n",
+			100.0 * (1.0 - res.eval.out[EVAL_WIN]), 100.0 * res.eval.out[EVAL_LOSE_GAMMON],
+			100.0 * res.eval.out[EVAL_LOSE_BACKGAMMON]);
+
+	// Games a plain simulation needs for the same standard error
+	if (res.equity_error > 0.0f) {
+		plain = res.trials * (double) res.plain_error * res.plain_error
+				/ ((double) res.equity_error * res.equity_error);
+		printf("Plain:   %.0f games for the same error, %.0f games saved (%.1fx)\n",
+				plain, plain - res.trials, plain / res.trials);
+	}
+
+	nnet_set_current(NULL);
+	nnet_free(net);
+	bearoff_set_current(NULL);
+	bearoff_close(bearoff);
+	bearoff2_set_current(NULL);
+	bearoff2_close(bearoff2);
+
+	return 0;
+}
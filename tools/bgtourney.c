@@ -0,0 +1,257 @@
+/**
+ * @file bgtourney.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Plays matches between two AI engines on all the cores and
+ * reports which one is stronger
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/bearoff.h>
+#include <core/bearoff2.h>
+#include <core/book.h>
+#include <core/nnet.h>
+#include <core/tourney.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_DIR		"data"
+
+/**
+ * @brief Normal quantile of the 95% confidence intervals.
+ */
+#define Z95				1.96
+
+/**
+ * @brief Monotonic clock in seconds.
+ *
+ * @return double seconds
+ */
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Prints the matches done so far.
+ *
+ * @param done matches done
+ * @param total matches of the tournament
+ */
+static void progress(unsigned done, unsigned total) {
+	printf("\rbgtourney: %u/%u matches", done, total);
+	fflush(stdout);
+}
+
+/**
+ * @brief Prints the command-line options.
+ */
+static void usage(void) {
+	fprintf(stderr,
+		"usage: bgtourney [options]\n"
+		"  -a SPEC  engine A (default depth=2)\n"
+		"  -b SPEC  engine B (default depth=2)\n"
+		"  -n N     matches (default 100)\n"
+		"  -l N     points of each match (default 7, at most %d)\n"
+		"  -m       money play: cube decisions without the match score\n"
+		"  -B       both engines open from the book of the data directory\n"
+		"  -d DIR   data directory (default " DEFAULT_DIR ")\n"
+		"  -t N     threads (default 0: one per core)\n"
+		"  -s SEED  random seed (default 1)\n"
+		"SPEC is a comma-separated list of:\n"
+		"  depth=N            plies of the search of the plays\n"
+		"  mcts=N             simulations of Monte Carlo tree search per play\n"
+		"  eval=net|heuristic evaluator (default net when present)\n"
+		"  cube=on|off        doubles and takes (off: never doubles, always takes)\n",
+		MET_MAX_SCORE);
+}
+
+/**
+ * @brief Reads the settings of an engine.
+ *
+ * @param spec comma-separated settings
+ * @param net evaluator for eval=net
+ * @param engine engine to update
+ * @return int 0, or 1 on error
+ */
+static int parse_engine(const char *spec, Evaluator net, TourneyEngine *engine) {
+	char buf[256], *tok, *save = NULL;
+
+	snprintf(buf, sizeof(buf), "%s", spec);
+	for (tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+		if (!strncmp(tok, "depth=", 6)) engine->depth = atoi(tok + 6);
+		else if (!strncmp(tok, "mcts=", 5)) engine->simulations = strtoull(tok + 5, NULL, 10);
+		else if (!strcmp(tok, "eval=net")) engine->evaluate = net;
+		else if (!strcmp(tok, "eval=heuristic")) engine->evaluate = eval_heuristic;
+		else if (!strcmp(tok, "cube=on")) engine->cube = true;
+		else if (!strcmp(tok, "cube=off")) engine->cube = false;
+		else {
+			fprintf(stderr, "bgtourney: unknown engine setting %s\n", tok);
+			return 1;
+		}
+	}
+
+	if (!engine->depth) engine->depth = 1;
+	return 0;
+}
+
+/**
+ * @brief Prints an engine.
+ *
+ * @param name name of the engine
+ * @param engine the engine
+ */
+static void print_engine(const char *name, const TourneyEngine *engine) {
+	if (engine->simulations)
+		printf("bgtourney: %s: MCTS %llu simulations", name,
+				(unsigned long long) engine->simulations);
+	else printf("bgtourney: %s: %u-ply", name, engine->depth);
+
+	printf(", %s evaluator, %s\n", engine->evaluate == eval_nnet ? "network" : "heuristic",
+			engine->cube ? "cube" : "no cube");
+}
+
+/**
+ * @brief Elo difference of a winning rate, clamped away from 0 and 1.
+ *
+ * @param p winning rate
+ * @return double Elo difference
+ */
+static double elo(double p) {
+	if (p < 0.001) p = 0.001;
+	if (p > 0.999) p = 0.999;
+	return -400.0 * log10(1.0 / p - 1.0);
+}
+
+int main(int argc, char *argv[]) {
+	TourneyOptions opts;
+	TourneyResult res;
+	const char *dir = DEFAULT_DIR, *specs[2] = {NULL, NULL};
+	char path[1024];
+	NNet *net;
+	Bearoff *bearoff;
+	Bearoff2 *bearoff2;
+	Book *book = NULL;
+	Met *met = NULL;
+	Evaluator evaluate;
+	bool money = false, use_book = false;
+	double start, p, ci, ppg, var;
+	unsigned i;
+	int c;
+
+	tourney_options_init(&opts);
+	opts.progress = progress;
+
+	while ((c = getopt(argc, argv, "a:b:n:l:mBd:t:s:")) != -1) {
+		switch (c) {
+			case 'a': specs[0] = optarg; break;
+			case 'b': specs[1] = optarg; break;
+			case 'n': opts.matches = atoi(optarg); break;
+			case 'l': opts.length = atoi(optarg); break;
+			case 'm': money = true; break;
+			case 'B': use_book = true; break;
+			case 'd': dir = optarg; break;
+			case 't': opts.threads = atoi(optarg); break;
+			case 's': opts.seed = strtoull(optarg, NULL, 10); break;
+			default: usage(); return 1;
+		}
+	}
+	if (!opts.matches || !opts.length || opts.length > MET_MAX_SCORE) {
+		usage();
+		return 1;
+	}
+
+	// The same data as the GUI: network and bearoff databases. The book
+	// would make both engines open alike, so it is only used when asked
+	snprintf(path, sizeof(path), "%s/bgnn.weights", dir);
+	net = nnet_load(path);
+	nnet_set_current(net);
+	evaluate = net ? eval_nnet : eval_heuristic;
+
+	snprintf(path, sizeof(path), "%s/bearoff.db", dir);
+	bearoff = bearoff_open(path);
+	bearoff_set_current(bearoff);
+	snprintf(path, sizeof(path), "%s/bearoff2.db", dir);
+	bearoff2 = bearoff2_open(path);
+	bearoff2_set_current(bearoff2);
+	if (use_book) {
+		snprintf(path, sizeof(path), "%s/book.db", dir);
+		book = book_open(path);
+		if (!book) {
+			fprintf(stderr, "bgtourney: no book in %s\n", dir);
+			return 1;
+		}
+		book_set_current(book);
+	}
+
+	for (i = 0; i < 2; i ++) {
+		opts.engines[i].evaluate = evaluate;
+		if (specs[i] && parse_engine(specs[i], evaluate, &opts.engines[i])) {
+			usage();
+			return 1;
+		}
+		if (opts.engines[i].evaluate == eval_nnet && !net) {
+			fprintf(stderr, "bgtourney: no network in %s\n", dir);
+			return 1;
+		}
+	}
+
+	if (!money) {
+		snprintf(path, sizeof(path), "%s/met.bin", dir);
+		met = met_open(path);
+		if (!met) {
+			fprintf(stderr, "bgtourney: out of memory\n");
+			return 1;
+		}
+		opts.met = met;
+	}
+
+	print_engine("A", &opts.engines[0]);
+	print_engine("B", &opts.engines[1]);
+	printf("bgtourney: %u matches to %u points, %s%s\n", opts.matches, opts.length,
+			money ? "money play" : "match play", book ? ", opening book" : "");
+
+	start = now();
+	if (!tourney_run(&opts, &res)) {
+		fprintf(stderr, "\nbgtourney: out of memory\n");
+		return 1;
+	}
+	printf("\nbgtourney: done in %.1f s\n\n", now() - start);
+
+	// Matches: binomial interval of the winning rate of A
+	p = (double) res.wins[0] / res.matches;
+	ci = Z95 * sqrt(p * (1.0 - p) / res.matches);
+	printf("Matches: A %u - B %u, A wins %.1f%% +/- %.1f%%\n",
+			res.wins[0], res.wins[1], 100.0 * p, 100.0 * ci);
+	printf("Elo:     A %+.0f [%+.0f, %+.0f]\n", elo(p), elo(p - ci), elo(p + ci));
+
+	// Games: points per game of A, with the variance of the games
+	printf("Games:   %llu, A wins %llu (%llu gammons), B wins %llu (%llu gammons)\n",
+			(unsigned long long) res.games,
+			(unsigned long long) res.game_wins[0], (unsigned long long) res.gammons[0],
+			(unsigned long long) res.game_wins[1], (unsigned long long) res.gammons[1]);
+	ppg = res.net / res.games;
+	var = res.net2 / res.games - ppg * ppg;
+	printf("Points:  A %llu - B %llu, A %+.3f +/- %.3f per game\n",
+			(unsigned long long) res.points[0], (unsigned long long) res.points[1],
+			ppg, Z95 * sqrt(var > 0.0 ? var / res.games : 0.0));
+
+	met_free(met);
+	nnet_set_current(NULL);
+	nnet_free(net);
+	bearoff_set_current(NULL);
+	bearoff_close(bearoff);
+	bearoff2_set_current(NULL);
+	bearoff2_close(bearoff2);
+	book_set_current(NULL);
+	book_close(book);
+
+	return 0;
+}
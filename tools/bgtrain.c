@@ -0,0 +1,174 @@
+/**
+ * @file bgtrain.c
+ * @author Javier Candales (javier_candales@yahoo.com.ar)
+ * @brief Trains the network evaluator by self-play on all the cores
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <core/nnet.h>
+#include <core/train.h>
+
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_HIDDEN		128
+#define DEFAULT_OUTPUT		"data/bgnn.weights"
+#define DEFAULT_CHECKPOINT	10000
+#define REPORT_SECONDS		5.0
+
+static volatile sig_atomic_t interrupted = 0;
+
+/**
+ * @brief Monotonic clock in seconds.
+ *
+ * @return double seconds
+ */
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief SIGINT handler: the training stops and the weights are saved.
+ *
+ * @param sig signal number
+ */
+static void on_interrupt(int sig) {
+	interrupted = 1;
+}
+
+/**
+ * @brief Saves the weights through a temporary file, so an interrupted
+ * save never leaves a broken weight file.
+ *
+ * @param net the network
+ * @param path file name
+ * @return bool false on error
+ */
+static bool checkpoint(const NNet *net, const char *path) {
+	char tmp[1024];
+
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+	if (!nnet_save(net, tmp) || rename(tmp, path)) {
+		fprintf(stderr, "bgtrain: cannot write %s\n", path);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Prints the command-line options.
+ */
+static void usage(void) {
+	fprintf(stderr,
+		"usage: bgtrain [options]\n"
+		"  -i FILE  start from the weights in FILE\n"
+		"  -o FILE  output weights (default " DEFAULT_OUTPUT ")\n"
+		"  -H N     hidden units of a new network (default %d)\n"
+		"  -g N     games to play (default 0: until Ctrl+C)\n"
+		"  -t N     threads (default 0: one per core)\n"
+		"  -r RATE  learning rate (default 0.1)\n"
+		"  -l L     lambda (default 0.7)\n"
+		"  -c N     save every N games (default %d)\n"
+		"  -s SEED  random seed (default 1)\n",
+		DEFAULT_HIDDEN, DEFAULT_CHECKPOINT);
+}
+
+int main(int argc, char *argv[]) {
+	TrainOptions opts;
+	TrainStats stats, last;
+	Train *train;
+	NNet *net;
+	const char *input = NULL, *output = DEFAULT_OUTPUT;
+	unsigned hidden = DEFAULT_HIDDEN, every = DEFAULT_CHECKPOINT;
+	uint64_t next_checkpoint;
+	double start, last_time, t;
+	int c;
+
+	train_options_init(&opts);
+
+	while ((c = getopt(argc, argv, "i:o:H:g:t:r:l:c:s:")) != -1) {
+		switch (c) {
+			case 'i': input = optarg; break;
+			case 'o': output = optarg; break;
+			case 'H': hidden = atoi(optarg); break;
+			case 'g': opts.games = atoi(optarg); break;
+			case 't': opts.threads = atoi(optarg); break;
+			case 'r': opts.rate = atof(optarg); break;
+			case 'l': opts.lambda = atof(optarg); break;
+			case 'c': every = atoi(optarg); break;
+			case 's': opts.seed = strtoull(optarg, NULL, 10); break;
+			default: usage(); return 1;
+		}
+	}
+
+	if (input) {
+		net = nnet_load(input);
+		if (!net) {
+			fprintf(stderr, "bgtrain: cannot load %s\n", input);
+			return 1;
+		}
+	} else net = nnet_new(hidden, opts.seed);
+
+	if (!net) return 1;
+
+	signal(SIGINT, on_interrupt);
+
+	train = train_start(net, &opts);
+	if (!train) {
+		nnet_free(net);
+		return 1;
+	}
+
+	printf("bgtrain: %u hidden, %u threads, rate %g, lambda %g\n",
+			net->hidden, train->thread_count, opts.rate, opts.lambda);
+
+	memset(&last, 0, sizeof(TrainStats));
+	next_checkpoint = every;
+	start = last_time = now();
+
+	while (!train_done(train) && !interrupted) {
+		usleep(100000);
+
+		t = now();
+		if (t - last_time < REPORT_SECONDS) continue;
+
+		// Games/sec and mean squared error per output since the last report
+		train_stats(train, &stats);
+		printf("games %8" PRIu64 "  %6.0f games/sec  loss %.5f\n", stats.games,
+				(stats.games - last.games) / (t - last_time),
+				stats.positions > last.positions ?
+					(stats.error - last.error) / ((stats.positions - last.positions) * EVAL_OUTPUTS) : 0.0);
+		fflush(stdout);
+		last = stats;
+		last_time = t;
+
+		if (every && stats.games >= next_checkpoint) {
+			checkpoint(net, output);
+			next_checkpoint = stats.games - stats.games % every + every;
+		}
+	}
+
+	// Let the workers finish their games, so the totals are complete
+	train_stop(train);
+	while (!train_done(train)) usleep(10000);
+	train_stats(train, &stats);
+	train_free(train);
+
+	// Loss over the whole run, also when it was shorter than one report
+	printf("bgtrain: %" PRIu64 " games in %.0f s, loss %.5f\n", stats.games, now() - start,
+			stats.positions ? stats.error / (stats.positions * EVAL_OUTPUTS) : 0.0);
+	c = checkpoint(net, output) ? 0 : 1;
+
+	nnet_free(net);
+	return c;
+}